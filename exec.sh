@@ -39,6 +39,30 @@ then
     cd ..
     echo "------------END------------"
 
+elif [[ $1 == "--build-benchmarks" || $1 == "-bm" ]]
+then
+    clear
+    echo "------------BENCHMARKS------------"
+    rm -rf ./build/ ./*.a
+    mkdir ./build/ && cd ./build/
+    cmake .. -DCMAKE_BUILD_TYPE=Release -DENABLE_NET_BENCHMARKS=ON
+    cmake --build .
+    ./tests/benchmarks/NET_benchmarks
+    cd ..
+    echo "------------END------------"
+
+elif [[ $1 == "--build-fuzz" || $1 == "-fz" ]]
+then
+    clear
+    echo "------------FUZZING------------"
+    rm -rf ./build/ ./*.a
+    mkdir ./build/ && cd ./build/
+    CXX=clang++ cmake .. -DCMAKE_BUILD_TYPE=RelWithDebInfo -DENABLE_NET_FUZZING=ON
+    cmake --build .
+    ctest --output-on-failure
+    cd ..
+    echo "------------END------------"
+
 elif [[ $1 == "--debug-build" || $1 == "-d" ]]
 then
     echo ""------------DEBUG"------------"
@@ -72,6 +96,8 @@ then
     << This section delete the old files created by the compilation >>
     --re-build, -rb         Build the program with CMake
     --build-test, -t        Launch unit tests with coverage using GTest
+    --build-benchmarks, -bm Launch benchmarks in release using Google Benchmark
+    --build-fuzz, -fz       Build the fuzz targets with Clang and run them briefly
     --debug-build, -d       Build the program with debug and verbose
 "
 else
@@ -85,6 +111,8 @@ To use this executer you must use a flag:
     << This section delete the old files created by the compilation >>
     --re-build, -rb         Build the program with CMake
     --build-test, -t        Launch unit tests with coverage using GTest
+    --build-benchmarks, -bm Launch benchmarks in release using Google Benchmark
+    --build-fuzz, -fz       Build the fuzz targets with Clang and run them briefly
     --debug-build, -d       Build the program with debug and verbose
 "
 fi
\ No newline at end of file
@@ -74,6 +74,25 @@ class Address {
      */
     uint32_t getIPAsInt() const;
 
+    /**
+     * @brief Pack the IP and the port in a single integer
+     *
+     * Only the 48 low bits are used: ip << 16 | port
+     *
+     * @return uint64_t Key identifying the Address
+     */
+    uint64_t toKey() const {
+        return (static_cast<uint64_t>(_ip) << 16) | _port;
+    }
+
+    /**
+     * @brief Create an Address from a key made by toKey()
+     *
+     * @param key Packed IP and port
+     * @return Address unpacked from the key
+     */
+    static Address fromKey(uint64_t key);
+
     bool operator==(const Address& other) const;
     bool operator<(const Address& other) const;
 
@@ -82,6 +101,24 @@ class Address {
     uint16_t _port;
 };
 
+/**
+ * @brief Mix every bit of a key into every bit of the hash (murmur3 fmix64)
+ *
+ * Keys of clients behind the same NAT only differ by a few port bits,
+ * tables indexing with the low bits need them spread.
+ *
+ * @param key Value to hash
+ * @return uint64_t Hash of the value
+ */
+inline uint64_t mixHash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
 }  // namespace net
 
 // needed to store Address in unordered_map
@@ -89,9 +126,7 @@ namespace std {
 template<>
 struct hash<net::Address> {
         size_t operator()(const net::Address& addr) const {
-            size_t h1 = hash<uint32_t>()(addr.getIPAsInt());
-            size_t h2 = hash<uint16_t>()(addr.getPort());
-            return h1 ^ (h2 << 1);
+            return static_cast<size_t>(net::mixHash(addr.toKey()));
         }
 };
 }  // namespace std
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Network/Address.hpp"
+
+namespace net {
+
+/**
+ * @brief Flat hash table keyed on an Address
+ *
+ * Open addressing with linear probing over the packed 48-bit IP:port key
+ * (@see Address#toKey) hashed with mixHash. Keys live in their own array so
+ * a probe only walks contiguous integers, values are stored inline next to
+ * their Address. Erase shifts the following entries back, no tombstones.
+ *
+ * Pointers, references and iterators are invalidated by insertions that
+ * grow the table and by erase.
+ *
+ * @tparam T Type of the value stored for each Address
+ */
+template<typename T>
+class AddressTable {
+ public:
+    struct Entry {
+        Address address;
+        T value;
+    };
+
+    template<typename E>
+    class Iterator {
+     public:
+        Iterator(const uint64_t* keys, E* entries, size_t index, size_t end)
+            : _keys(keys), _entries(entries), _index(index), _end(end) {
+            skipEmpty();
+        }
+
+        E& operator*() const { return _entries[_index]; }
+        E* operator->() const { return &_entries[_index]; }
+
+        Iterator& operator++() {
+            ++_index;
+            skipEmpty();
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return _index == other._index;
+        }
+
+     private:
+        void skipEmpty() {
+            while (_index < _end && _keys[_index] == EMPTY_KEY)
+                ++_index;
+        }
+
+        const uint64_t* _keys;
+        E* _entries;
+        size_t _index;
+        size_t _end;
+    };
+
+    using iterator = Iterator<Entry>;
+    using const_iterator = Iterator<const Entry>;
+
+    AddressTable() = default;
+
+    /**
+     * @brief Find the value stored for an Address
+     *
+     * @param address Address to look for
+     * @return T* The value, nullptr if the Address is unknown
+     */
+    T* find(const Address& address) {
+        size_t index = lookup(address.toKey());
+        return index == NOT_FOUND ? nullptr : &_entries[index].value;
+    }
+
+    const T* find(const Address& address) const {
+        size_t index = lookup(address.toKey());
+        return index == NOT_FOUND ? nullptr : &_entries[index].value;
+    }
+
+    bool contains(const Address& address) const {
+        return lookup(address.toKey()) != NOT_FOUND;
+    }
+
+    /**
+     * @brief Insert a default constructed value if the Address is unknown
+     *
+     * @param address Address to insert
+     * @return std::pair<T*, bool> The value stored for the Address and true if
+     *  it has just been inserted
+     */
+    std::pair<T*, bool> tryEmplace(const Address& address) {
+        uint64_t key = address.toKey();
+
+        if ((_size + 1) * MAX_LOAD_DEN > _keys.size() * MAX_LOAD_NUM)
+            rehash(_keys.empty() ? MIN_CAPACITY : _keys.size() * 2);
+
+        size_t index = mixHash(key) & _mask;
+        while (_keys[index] != EMPTY_KEY) {
+            if (_keys[index] == key)
+                return {&_entries[index].value, false};
+            index = (index + 1) & _mask;
+        }
+        _keys[index] = key;
+        _entries[index].address = address;
+        _entries[index].value = T();
+        ++_size;
+        return {&_entries[index].value, true};
+    }
+
+    T& operator[](const Address& address) {
+        return *tryEmplace(address).first;
+    }
+
+    /**
+     * @brief Remove an Address and its value
+     *
+     * @param address Address to remove
+     * @return true If the Address was in the table
+     */
+    bool erase(const Address& address) {
+        size_t hole = lookup(address.toKey());
+        if (hole == NOT_FOUND)
+            return false;
+
+        // backward shift: pull back every entry that probed past the hole
+        size_t index = (hole + 1) & _mask;
+        while (_keys[index] != EMPTY_KEY) {
+            size_t home = mixHash(_keys[index]) & _mask;
+            if (((index - home) & _mask) >= ((index - hole) & _mask)) {
+                _keys[hole] = _keys[index];
+                _entries[hole] = std::move(_entries[index]);
+                hole = index;
+            }
+            index = (index + 1) & _mask;
+        }
+        _keys[hole] = EMPTY_KEY;
+        _entries[hole].value = T();
+        --_size;
+        return true;
+    }
+
+    /**
+     * @brief Remove every entry, the capacity is kept
+     */
+    void clear() {
+        for (size_t i = 0; i < _keys.size(); ++i) {
+            if (_keys[i] != EMPTY_KEY) {
+                _keys[i] = EMPTY_KEY;
+                _entries[i].value = T();
+            }
+        }
+        _size = 0;
+    }
+
+    /**
+     * @brief Make room for at least count entries without growing
+     *
+     * @param count Number of entries expected
+     */
+    void reserve(size_t count) {
+        size_t capacity = MIN_CAPACITY;
+        while (count * MAX_LOAD_DEN > capacity * MAX_LOAD_NUM)
+            capacity *= 2;
+        if (capacity > _keys.size())
+            rehash(capacity);
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    size_t capacity() const { return _keys.size(); }
+
+    iterator begin() {
+        return iterator(_keys.data(), _entries.data(), 0, _keys.size());
+    }
+    iterator end() {
+        return iterator(_keys.data(), _entries.data(), _keys.size(),
+            _keys.size());
+    }
+    const_iterator begin() const {
+        return const_iterator(_keys.data(), _entries.data(), 0, _keys.size());
+    }
+    const_iterator end() const {
+        return const_iterator(_keys.data(), _entries.data(), _keys.size(),
+            _keys.size());
+    }
+
+ private:
+    // a packed key only uses 48 bits, all ones can never be a real key
+    static constexpr uint64_t EMPTY_KEY = ~0ULL;
+    static constexpr size_t NOT_FOUND = ~static_cast<size_t>(0);
+    static constexpr size_t MIN_CAPACITY = 16;
+    // grow when more than 3/4 full
+    static constexpr size_t MAX_LOAD_NUM = 3;
+    static constexpr size_t MAX_LOAD_DEN = 4;
+
+    size_t lookup(uint64_t key) const {
+        if (_size == 0)
+            return NOT_FOUND;
+        size_t index = mixHash(key) & _mask;
+        while (_keys[index] != EMPTY_KEY) {
+            if (_keys[index] == key)
+                return index;
+            index = (index + 1) & _mask;
+        }
+        return NOT_FOUND;
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<uint64_t> oldKeys(capacity, EMPTY_KEY);
+        std::vector<Entry> oldEntries(capacity);
+        // members get the new empty arrays, the old ones are moved from
+        oldKeys.swap(_keys);
+        oldEntries.swap(_entries);
+        _mask = capacity - 1;
+
+        for (size_t i = 0; i < oldKeys.size(); ++i) {
+            if (oldKeys[i] == EMPTY_KEY)
+                continue;
+            size_t index = mixHash(oldKeys[i]) & _mask;
+            while (_keys[index] != EMPTY_KEY)
+                index = (index + 1) & _mask;
+            _keys[index] = oldKeys[i];
+            _entries[index] = std::move(oldEntries[i]);
+        }
+    }
+
+    std::vector<uint64_t> _keys;
+    std::vector<Entry> _entries;
+    size_t _size = 0;
+    size_t _mask = 0;
+};
+
+}  // namespace net
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace net {
+
+/**
+ * @brief Packs values of any width from 1 to 64 bits, lowest bits first
+ *
+ * Bits fill each byte from its lowest bit, whatever the host or the protocol
+ * endianness. They gather in a 64 bit word written out 8 bytes at a time.
+ * Used by the generated messages for "bits" and "quantized_float" fields.
+ */
+class BitWriter {
+ public:
+    /**
+     * @param out Large enough for every bit written, rounded up to a byte
+     */
+    explicit BitWriter(uint8_t* out) : _start(out), _out(out) {}
+
+    /**
+     * @brief Append the low bits of a value, the others are dropped
+     */
+    void write(uint64_t value, unsigned bits) {
+        value &= mask(bits);
+        _word |= value << _used;
+        _used += bits;
+        if (_used >= 64) {
+            storeWord(_out, _word);
+            _out += 8;
+            _used -= 64;
+            // bits of value that did not fit in the word
+            _word = _used ? value >> (bits - _used) : 0;
+        }
+    }
+
+    /**
+     * @brief Write the last bits, the unused ones of the last byte are 0
+     *
+     * @return size_t Bytes written in all
+     */
+    size_t flush() {
+        size_t bytes = (_used + 7) / 8;
+
+        for (size_t i = 0; i < bytes; ++i)
+            _out[i] = static_cast<uint8_t>(_word >> (8 * i));
+        _out += bytes;
+        _used = 0;
+        _word = 0;
+        return static_cast<size_t>(_out - _start);
+    }
+
+    static constexpr uint64_t mask(unsigned bits) {
+        return bits >= 64 ? ~uint64_t{0} : (uint64_t{1} << bits) - 1;
+    }
+
+ private:
+    static void storeWord(uint8_t* out, uint64_t word) {
+        if constexpr (std::endian::native == std::endian::big)
+            word = std::byteswap(word);
+        std::memcpy(out, &word, 8);
+    }
+
+    uint8_t* _start;
+    uint8_t* _out;
+    uint64_t _word = 0;
+    unsigned _used = 0;
+};
+
+/**
+ * @brief Reads values written by BitWriter
+ *
+ * Each read loads the 8 bytes holding the value at once (fewer at the end
+ * of the data) and shifts it out, so it costs the same for any position.
+ */
+class BitReader {
+ public:
+    /**
+     * @param in Bytes to read from, never read past size
+     * @param size Number of bytes
+     * @param position Bit to start reading at
+     */
+    BitReader(const uint8_t* in, size_t size, size_t position = 0)
+        : _in(in), _size(size), _position(position) {}
+
+    /**
+     * @brief Read the next value of bits bits, 0 for bits past the end
+     */
+    uint64_t read(unsigned bits) {
+        // a word shifted by up to 7 bits holds 57 of them
+        if (bits > 56) {
+            uint64_t low = read(32);
+            return low | read(bits - 32) << 32;
+        }
+        uint64_t word = loadWord(_position / 8) >> (_position % 8);
+        _position += bits;
+        return word & BitWriter::mask(bits);
+    }
+
+    size_t position() const { return _position; }
+
+ private:
+    uint64_t loadWord(size_t byte) const {
+        uint64_t word = 0;
+
+        if (byte + 8 <= _size) {
+            std::memcpy(&word, _in + byte, 8);
+            if constexpr (std::endian::native == std::endian::big)
+                word = std::byteswap(word);
+            return word;
+        }
+        for (size_t i = 0; byte + i < _size; ++i)
+            word |= static_cast<uint64_t>(_in[byte + i]) << (8 * i);
+        return word;
+    }
+
+    const uint8_t* _in;
+    size_t _size;
+    size_t _position;
+};
+
+/**
+ * @brief Map a value of [min, max] to an integer of bits bits, rounded to
+ * the nearest step
+ *
+ * Values out of the range, NaN included, are clamped to it.
+ */
+inline uint64_t quantize(double value, double min, double max,
+    unsigned bits) {
+    double steps = static_cast<double>(BitWriter::mask(bits));
+
+    if (!(value > min))
+        return 0;
+    if (value >= max)
+        return BitWriter::mask(bits);
+    return static_cast<uint64_t>((value - min) * (steps / (max - min)) + 0.5);
+}
+
+/**
+ * @brief Value of a quantized integer, within half a step of the original
+ */
+inline float dequantize(uint64_t quantized, double min, double max,
+    unsigned bits) {
+    double steps = static_cast<double>(BitWriter::mask(bits));
+
+    return static_cast<float>(
+        min + static_cast<double>(quantized) * ((max - min) / steps));
+}
+
+}  // namespace net
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+namespace net {
+
+/**
+ * @brief Copy an array of integers or floats, reversing the bytes of each
+ * element
+ *
+ * Used by the generated messages for numeric arrays when the wire
+ * endianness differs from the host. On x86 the bytes are shuffled 32 (AVX2)
+ * or 16 (SSSE3) at a time, picked once at run time from the CPU, and the
+ * last elements one by one.
+ *
+ * @param dst Destination, may be equal to src but not otherwise overlap it
+ * @param src Source elements, no alignment required
+ * @param count Number of elements
+ * @param width Size of one element: 1, 2, 4 or 8 bytes
+ */
+void byteswapCopy(void* dst, const void* src, size_t count, size_t width);
+
+/**
+ * @brief Same as byteswapCopy, one element at a time
+ *
+ * Reference for the tests and the benchmarks.
+ */
+void byteswapCopyScalar(void* dst, const void* src, size_t count,
+    size_t width);
+
+}  // namespace net
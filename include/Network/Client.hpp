@@ -1,5 +1,9 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
 #include <string>
 #include <vector>
 #include <chrono>
@@ -7,10 +11,14 @@
 #include <functional>
 
 #include "Network/Address.hpp"
+#include "Network/Delta.hpp"
 #include "Network/NetworkSocket.hpp"
 #include "Network/ProtocolManager.hpp"
 #include "Network/PacketSerializer.hpp"
 #include "Network/Logger.hpp"
+#include "Network/Lz4.hpp"
+#include "Network/TimerWheel.hpp"
+#include "Network/Pcap.hpp"
 
 #define CAST_UINT32 static_cast<uint32_t>
 
@@ -19,11 +27,25 @@ namespace net {
 /**
  * @brief Packet tracker structure
  *
- * Used by Client to ask server for missing packets
+ * Used by Client to ask server for missing packets.
+ * Times are steady clock milliseconds.
  */
 struct PacketTracking {
-    std::size_t expectedTime;
-    std::chrono::steady_clock::time_point lastRecvTime;
+    bool active = false;
+    std::size_t expectedTime = 0;
+    uint64_t lastRecvTime = 0;
+    uint64_t received = 0;
+    uint64_t misses = 0;
+};
+
+/**
+ * @brief Statistics of a packet code
+ *
+ * @see Client#getPacketTrackerStats
+ */
+struct PacketTrackerStats {
+    uint64_t received;
+    uint64_t misses;
 };
 
 /**
@@ -39,9 +61,12 @@ class Client {
      *
      * @param protocol Choose the communication type of your client.
      * Mode -> "UDP" or "TCP".
+     * @param path Path to the protocol.json containing the config
+     * @param logging Write the logs in ./logs, every packet sent and
+     *  received is logged
      */
     explicit Client(const std::string& protocol = "UDP",
-        const std::string& path = "config/protocol.json");
+        const std::string& path = "config/protocol.json", bool logging = true);
 
     /**
      * @brief Destroy the Client object
@@ -69,13 +94,17 @@ class Client {
     /**
      * @brief Send datas to the Server which you are connected.
      *
+     * Datas are copied once, straight into the framed packet. A failed TCP
+     * send that leaves the stream out of step (part of a packet sent, or
+     * stream compression active) disconnects the client.
+     *
      * @param data Datas to send. They will be formatted accordingly to the
      *  ProtocolManager.
      * @return true If the send succeed
      * @return false If the send failed (not connected to a Server,
      *  data empty...)
      */
-    bool send(const std::vector<uint8_t>& data);
+    bool send(std::span<const uint8_t> data);
 
     /**
      * @brief
@@ -88,14 +117,16 @@ class Client {
      */
     template<typename T>
     bool sendPacket(const T& packet) {
-        std::vector<uint8_t> data = PacketSerializer::serialize(packet);
-        return send(data);
+        return send(PacketSerializer::view(packet));
     }
 
     /**
      * @brief Receive datas and put them in buffer
      * Automatically unformat them accordingly to the ProtocolManager
      *
+     * With "stream_compression", the packets of a block after the first
+     * stay in _input_buffer and are returned by the next calls.
+     *
      * @param buffer Filled by the datas received
      * @param max_size Maximum size of the buffer
      * @return int Negative value if error. 0 if Succeed
@@ -112,7 +143,8 @@ class Client {
 
     /**
      * @brief Receive datas in "TCP" mode and put them in _input_buffer
-     * Datas in _input_buffer are not unformatted
+     * Datas in _input_buffer are not unformatted, but decompressed when
+     *  "stream_compression" is active
      *  @see Client#extractPacketsFromBuffer
      *
      * @param timeout Duration while the Client will wait datas
@@ -123,10 +155,12 @@ class Client {
      * @brief Unformat packets accordingly to PorotocolManager and put only
      *  their content in a std::vector<uint8_t>
      *
+     * @param maxPackets Packets to take at most, the others stay buffered
      * @return std::vector<std::vector<uint8_t>> Vector of containing the
      *  content of each packet received
      */
-    std::vector<std::vector<uint8_t>> extractPacketsFromBuffer();
+    std::vector<std::vector<uint8_t>> extractPacketsFromBuffer(
+        size_t maxPackets = SIZE_MAX);
 
     /**
      * @brief Set the Client non-blocking
@@ -169,9 +203,32 @@ class Client {
      */
     const Address& getServerAddress() const { return _server_address; }
 
+    /**
+     * @brief Capture every datagram or stream chunk read and sent
+     *
+     * Written to a pcapng file with synthetic IPv4 headers. Replaces the
+     * capture in progress if any.
+     *
+     * @param path File to create
+     * @throw PcapWriter::OpenFailed If the file can't be created
+     */
+    void startCapture(const std::string& path);
+
+    /**
+     * @brief Stop the capture in progress and close its file
+     */
+    void stopCapture();
+
     /**
      * @brief Initialize packet trackers
      *
+     * A packet code is missed when it isn't received for twice its expected
+     * time, the callback is then called once per period until it comes back.
+     * Codes already tracked keep their expected time.
+     *
+     * @param packetToTrace Expected time in milliseconds between two packets,
+     *  for each packet code
+     * @param callback Called with the code of each missed packet
      * @return bool true if succeed, false if failed
      */
     bool initPacketTrackers(std::unordered_map<uint8_t, uint32_t>packetToTrace,
@@ -188,22 +245,66 @@ class Client {
     /**
      * @brief Check packet trackers automatically
      *
+     * Only the trackers due are looked at.
+     *
      * @return bool true if succeed, false if failed
      */
-
     bool checkPacketTrackers();
 
+    /**
+     * @brief Get the number of packets received and missed for a code
+     *
+     * Packets are counted for every code, misses only for tracked ones.
+     *
+     * @param code the packet code
+     * @return PacketTrackerStats
+     */
+    PacketTrackerStats getPacketTrackerStats(uint8_t code) const;
+
+    /**
+     * @brief Reset a delta receiver whenever the connection starts over
+     *
+     * The server encodes against empty messages for a new client, so the
+     * baselines of the previous connection are forgotten on connect() and
+     * disconnect(). E.g. with a generated MessageDispatcher:
+     *     client.addDeltaReceiver(dispatcher.receiver<PLAYER_UPDATE>());
+     *
+     * @param receiver Kept by reference, must outlive the client
+     */
+    template<typename T, size_t HISTORY>
+    void addDeltaReceiver(DeltaReceiver<T, HISTORY>& receiver) {
+        _deltaReceivers.push_back([&receiver] { receiver.reset(); });
+    }
+
+    // Testing purpose
+    std::vector<uint8_t>& getInputBufferRef();
+
  private:
+    void capture(bool sent, std::span<const uint8_t> data);
+    static int copyPacket(std::span<const uint8_t> data, void* buffer,
+        size_t max_size);
+
     NetworkSocket _socket;
     Address _server_address;
     bool _connected;
     ProtocolManager _protocol;
     Logger _logger;
 
-    std::unordered_map<uint8_t, PacketTracking> _packetTrackers;
+    std::array<PacketTracking, 256> _packetTrackers;
+    TimerWheel _packetTimers;
     std::function<void(uint8_t)> _trackPacketCallback;
+    std::vector<std::function<void()>> _deltaReceivers;
 
     std::vector<uint8_t> _input_buffer;
+    std::vector<uint8_t> _output_buffer;
+
+    // TCP connection with "stream_compression" active
+    std::unique_ptr<lz4::StreamEncoder> _encoder;
+    std::unique_ptr<lz4::StreamDecoder> _decoder;
+    std::vector<uint8_t> _streamBuffer;
+
+    std::unique_ptr<PcapWriter> _capture;
+    Address _captureAddress;
 };
 
 }  // namespace net
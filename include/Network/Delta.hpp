@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "Network/AddressTable.hpp"
+
+namespace net {
+
+/**
+ * @brief Sequence numbers carried by a "delta" message, after its ID
+ *
+ * baseline is the sequence of the message it is encoded against, or the
+ * message's own sequence when it is encoded against an empty message.
+ */
+struct DeltaHeader {
+    uint16_t sequence = 0;
+    uint16_t baseline = 0;
+
+    bool hasBaseline() const { return baseline != sequence; }
+};
+
+/**
+ * @brief A "delta" message as received, not decoded yet
+ *
+ * Handed to the on<DeltaPayload<T>> handlers of a MessageDispatcher, e.g.
+ * to decode it with the DeltaReceiver of the peer that sent it.
+ */
+template<typename T>
+struct DeltaPayload {
+    DeltaHeader header;
+    std::span<const uint8_t> data;
+};
+
+/**
+ * @brief Encodes the "delta" messages of one type sent to one peer
+ *
+ * Each message is encoded against the newest one the peer acknowledged, so
+ * only the fields changed since are sent. Until a message is acknowledged,
+ * or once the acknowledged one is older than the last HISTORY messages
+ * sent, messages are encoded against an empty one and decode on their own.
+ *
+ * @tparam T Generated message with "delta": true
+ * @tparam HISTORY Messages kept, a power of two
+ */
+template<typename T, size_t HISTORY = 32>
+class DeltaSender {
+    static_assert(HISTORY > 0 && HISTORY <= 32768 &&
+        (HISTORY & (HISTORY - 1)) == 0, "HISTORY must be a power of two");
+
+ public:
+    /**
+     * @brief Encode a message under the next sequence number
+     */
+    std::vector<uint8_t> encode(const T& message) {
+        std::vector<uint8_t> bytes(encodedSize(message));
+
+        bytes.resize(encodeInto(message, bytes));
+        return bytes;
+    }
+
+    /**
+     * @param out At least encodedSize(message) bytes
+     * @return size_t Bytes written
+     */
+    size_t encodeInto(const T& message, std::span<uint8_t> out) {
+        DeltaHeader header{_next, _next};
+        const T* baseline = &empty();
+
+        if (_hasAcked && inHistory(_acked)) {
+            header.baseline = _acked;
+            baseline = &_sent[_acked % HISTORY];
+        }
+        size_t size = message.serializeDeltaInto(*baseline, header, out);
+        // allocated on first use, idle entries of a ClientBaselines stay small
+        if (_sent.empty())
+            _sent.resize(HISTORY);
+        _sent[_next % HISTORY] = message;
+        _next++;
+        if (_count < HISTORY)
+            _count++;
+        return size;
+    }
+
+    /**
+     * @brief Size of the next message once encoded
+     */
+    size_t encodedSize(const T& message) const {
+        if (_hasAcked && inHistory(_acked))
+            return message.serializedDeltaSize(_sent[_acked % HISTORY]);
+        return message.serializedDeltaSize(empty());
+    }
+
+    /**
+     * @brief The peer received the message of this sequence
+     *
+     * Older acknowledgements and sequences not in the history are ignored,
+     * they come late or from a previous session.
+     */
+    void acknowledge(uint16_t sequence) {
+        if (!inHistory(sequence))
+            return;
+        if (!_hasAcked || !inHistory(_acked) || age(sequence) < age(_acked)) {
+            _acked = sequence;
+            _hasAcked = true;
+        }
+    }
+
+    /**
+     * @brief Send the next message whole, e.g. once the peer reconnected
+     */
+    void reset() {
+        _hasAcked = false;
+        _count = 0;
+    }
+
+    uint16_t nextSequence() const { return _next; }
+
+ private:
+    static const T& empty() {
+        static const T message{};
+
+        return message;
+    }
+
+    size_t age(uint16_t sequence) const {
+        return static_cast<uint16_t>(_next - sequence);
+    }
+
+    bool inHistory(uint16_t sequence) const {
+        return age(sequence) >= 1 && age(sequence) <= _count;
+    }
+
+    std::vector<T> _sent;
+    uint16_t _next = 0;
+    uint16_t _acked = 0;
+    bool _hasAcked = false;
+    size_t _count = 0;
+};
+
+/**
+ * @brief Decodes the "delta" messages of one type coming from one peer
+ *
+ * Keeps the last HISTORY messages decoded, the baselines the peer may encode
+ * the next ones against. latest() is the sequence to acknowledge.
+ *
+ * @tparam T Generated message with "delta": true
+ * @tparam HISTORY Same as the sender's
+ */
+template<typename T, size_t HISTORY = 32>
+class DeltaReceiver {
+    static_assert(HISTORY > 0 && HISTORY <= 32768 &&
+        (HISTORY & (HISTORY - 1)) == 0, "HISTORY must be a power of two");
+
+ public:
+    /**
+     * @brief Decode a message, kept until HISTORY newer ones are decoded
+     *
+     * @throw std::runtime_error If the message is invalid, if its baseline
+     * is no longer known or if it is older than the history
+     */
+    const T& decode(std::span<const uint8_t> data) {
+        DeltaHeader header = T::readDeltaHeader(data);
+        const T* baseline = &empty();
+
+        if (_hasLatest && static_cast<int16_t>(header.sequence - _latest) < 0
+            && static_cast<uint16_t>(_latest - header.sequence) >= HISTORY)
+            throw std::runtime_error("Delta message older than the history");
+        if (header.hasBaseline()) {
+            size_t slot = header.baseline % HISTORY;
+            if (_valid.empty() || !_valid[slot] ||
+                _sequences[slot] != header.baseline)
+                throw std::runtime_error("Unknown delta baseline");
+            baseline = &_received[slot];
+        }
+
+        T message = T::deserializeDelta(data, *baseline);
+        // allocated on first use, like the senders
+        if (_received.empty()) {
+            _received.resize(HISTORY);
+            _sequences.resize(HISTORY);
+            _valid.resize(HISTORY, false);
+        }
+        size_t slot = header.sequence % HISTORY;
+        _received[slot] = std::move(message);
+        _sequences[slot] = header.sequence;
+        _valid[slot] = true;
+        if (!_hasLatest || static_cast<int16_t>(header.sequence - _latest) > 0)
+            _latest = header.sequence;
+        _hasLatest = true;
+        return _received[slot];
+    }
+
+    /**
+     * @brief Sequence of the newest message decoded, to acknowledge
+     */
+    uint16_t latest() const { return _latest; }
+    bool hasReceived() const { return _hasLatest; }
+
+    /**
+     * @brief Forget every message, e.g. once reconnected
+     * (Client::addDeltaReceiver)
+     */
+    void reset() {
+        std::fill(_valid.begin(), _valid.end(), false);
+        _hasLatest = false;
+    }
+
+ private:
+    static const T& empty() {
+        static const T message{};
+
+        return message;
+    }
+
+    std::vector<T> _received;
+    std::vector<uint16_t> _sequences;
+    std::vector<bool> _valid;
+    uint16_t _latest = 0;
+    bool _hasLatest = false;
+};
+
+/**
+ * @brief One DeltaSender per client of a server
+ *
+ * Entries are created on first use. Server::addClientTable erases them
+ * when the client leaves.
+ */
+template<typename T, size_t HISTORY = 32>
+using ClientBaselines = AddressTable<DeltaSender<T, HISTORY>>;
+
+}  // namespace net
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace net {
+
+/**
+ * @brief Log-linear histogram of latencies, in the spirit of HdrHistogram
+ *
+ * Values below 256 are counted exactly, above they fall in 128 linear
+ * buckets per power of two, so any reported value is within 1% of the
+ * recorded one over the whole uint64_t range. Recording is a couple of bit
+ * operations and an increment, no allocation.
+ *
+ * The unit is up to the caller (nanoseconds for the loopback benchmark).
+ */
+class LatencyHistogram {
+ public:
+    LatencyHistogram();
+
+    /**
+     * @brief Record a value
+     *
+     * @param value Latency to record
+     */
+    void record(uint64_t value) {
+        _counts[bucketOf(value)]++;
+        _count++;
+        _sum += value;
+        if (value < _min)
+            _min = value;
+        if (value > _max)
+            _max = value;
+    }
+
+    /**
+     * @brief Add every value recorded by another histogram
+     *
+     * @param other Histogram to merge in this one
+     */
+    void merge(const LatencyHistogram& other);
+
+    /**
+     * @brief Forget every value recorded
+     */
+    void reset();
+
+    /**
+     * @brief Get the value at a given percentile
+     *
+     * @param percentile Between 0 and 100, e.g. 99.9 for the p999
+     * @return uint64_t Highest value of the bucket holding the percentile,
+     *  capped to the max recorded. 0 if nothing was recorded
+     */
+    uint64_t percentile(double percentile) const;
+
+    uint64_t count() const { return _count; }
+    uint64_t min() const { return _count ? _min : 0; }
+    uint64_t max() const { return _max; }
+    double mean() const;
+
+ private:
+    static constexpr unsigned SUB_BUCKET_BITS = 7;
+    static constexpr uint64_t SUB_BUCKETS = 1ULL << SUB_BUCKET_BITS;
+    // exact buckets, then SUB_BUCKETS per power of two up to 2^64
+    static constexpr size_t BUCKETS =
+        (64 - SUB_BUCKET_BITS) * SUB_BUCKETS + SUB_BUCKETS;
+
+    static size_t bucketOf(uint64_t value) {
+        if (value < 2 * SUB_BUCKETS)
+            return static_cast<size_t>(value);
+        unsigned shift = std::bit_width(value) - 1 - SUB_BUCKET_BITS;
+        return static_cast<size_t>((shift + 1) * SUB_BUCKETS +
+            (value >> shift) - SUB_BUCKETS);
+    }
+
+    static uint64_t highestValueOf(size_t bucket);
+
+    std::vector<uint64_t> _counts;
+    uint64_t _count = 0;
+    uint64_t _sum = 0;
+    uint64_t _min = ~0ULL;
+    uint64_t _max = 0;
+};
+
+}  // namespace net
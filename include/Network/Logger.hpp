@@ -14,6 +14,13 @@ class Logger {
 
     void setActive(bool active);
 
+    /**
+     * @brief Check if writes reach the log file
+     *
+     * Lets callers skip building messages that would be dropped.
+     */
+    bool isActive() const { return _active && _logFile.is_open(); }
+
     bool write(const std::string&);
 
  private:
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace net {
+
+/**
+ * @brief LZ4 blocks for the generated "compressed" messages
+ *
+ * The compression contexts are created once per thread and reset between
+ * blocks, instead of being allocated and cleared by every call. A block
+ * always compresses to the same bytes, whatever was compressed before.
+ */
+namespace lz4 {
+
+/** @brief Largest block LZ4 takes, LZ4_MAX_INPUT_SIZE */
+constexpr size_t MAX_BLOCK_SIZE = 0x7E000000;
+
+/** @brief Largest useful dictionary, LZ4 only looks 64 KB back */
+constexpr size_t MAX_DICTIONARY_SIZE = 64 * 1024;
+
+/**
+ * @brief Compress a block
+ *
+ * @param in Bytes to compress
+ * @param out Where to write the block
+ * @param dictionary Bytes both ends know, seen as coming right before the
+ * block. It must stay at the same address while threads compress with it
+ * (static data), its prepared context is kept per thread.
+ * @param level 0 for LZ4, 1 to 12 for LZ4HC, slower but smaller
+ * @return size_t Size of the block, 0 if it does not fit in out
+ */
+size_t compress(std::span<const uint8_t> in, std::span<uint8_t> out,
+    std::span<const uint8_t> dictionary = {}, int level = 0);
+
+/**
+ * @brief Decompress a block coming from the wire
+ *
+ * @param in The block, nothing after it
+ * @param out Exactly the size of the decompressed block
+ * @param dictionary The one given to compress
+ * @return true If the block is valid and fills out exactly
+ */
+bool decompress(std::span<const uint8_t> in, std::span<uint8_t> out,
+    std::span<const uint8_t> dictionary = {});
+
+/** @brief Most bytes a block of a stream decompresses to */
+constexpr size_t STREAM_BLOCK_SIZE = 16 * 1024;
+
+/**
+ * @brief Compresses everything sent one way on a connection as one stream
+ *
+ * Data is cut in blocks of STREAM_BLOCK_SIZE bytes at most, each written as
+ * [varint size][LZ4 block]. A block can copy from the last 64 KB sent, so a
+ * small packet looking like the previous ones takes a few bytes. The peer
+ * reads every block, in order, with a StreamDecoder.
+ *
+ * Keeps about 100 KB (350 KB with LZ4HC), created with the connection.
+ */
+class StreamEncoder {
+ public:
+    /**
+     * @param level 0 for LZ4, 1 to 12 for LZ4HC
+     */
+    explicit StreamEncoder(int level = 0);
+    ~StreamEncoder();
+
+    StreamEncoder(const StreamEncoder&) = delete;
+    StreamEncoder& operator=(const StreamEncoder&) = delete;
+
+    /**
+     * @brief Append the blocks holding data to out
+     */
+    void compress(std::span<const uint8_t> data, std::vector<uint8_t>& out);
+
+ private:
+    struct State;
+    std::unique_ptr<State> _state;
+};
+
+/**
+ * @brief Reads the stream of a StreamEncoder, as it comes from the wire
+ *
+ * Keeps about 100 KB, plus the bytes of a block not received whole yet.
+ */
+class StreamDecoder {
+ public:
+    StreamDecoder();
+    ~StreamDecoder();
+
+    StreamDecoder(const StreamDecoder&) = delete;
+    StreamDecoder& operator=(const StreamDecoder&) = delete;
+
+    /**
+     * @brief Append what the bytes received decompress to to out
+     *
+     * A block cut by the transport is kept until its end is received.
+     *
+     * @param data Next bytes of the stream
+     * @param out Where to append the decompressed bytes
+     * @return false If the stream is invalid, nothing more can be read from
+     * it and the connection should be closed
+     */
+    bool decompress(std::span<const uint8_t> data, std::vector<uint8_t>& out);
+
+    /**
+     * @brief Bytes received of a block not received whole yet
+     */
+    size_t pending() const;
+
+ private:
+    struct State;
+    std::unique_ptr<State> _state;
+};
+
+}  // namespace lz4
+
+}  // namespace net
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <concepts>
+#include <ranges>
+#include <span>
 #include <stdexcept>
 #include <vector>
 
@@ -26,55 +29,115 @@ class MessageProtocol {
      */
     template<typename T>
     std::vector<uint8_t> pack(const T& message) {
-        auto msgData = message.serialize();
-        return _protocolManager.formatPacket(msgData);
+        std::vector<uint8_t> packet;
+
+        packInto(message, packet);
+        return packet;
+    }
+
+    /**
+     * @brief Serializes a message and formats it into an existing buffer.
+     *
+     * Generated messages are serialized straight into the packet, between
+     * its header and its end, the only copy of their fields.
+     *
+     * @tparam T The type of the message to be packed. The type must implement a `serialize` method.
+     * @param message The message object to be serialized and packed.
+     * @param out Filled with the formatted packet, its capacity is reused.
+     */
+    template<typename T>
+    void packInto(const T& message, std::vector<uint8_t>& out) {
+        if constexpr (requires(std::span<uint8_t> slot) {
+            { message.serializedSize() } -> std::convertible_to<size_t>;
+            { message.serializeInto(slot) } -> std::convertible_to<size_t>;
+        }) {
+            std::span<uint8_t> slot =
+                _protocolManager.beginPacket(message.serializedSize(), out);
+            _protocolManager.finishPacket(message.serializeInto(slot), out);
+        } else {
+            _protocolManager.formatPacketInto(message.serialize(), out);
+        }
     }
 
     /**
      * @brief Extracts the message ID from a formatted packet.
      *
-     * @param packet The vector of bytes representing the formatted packet.
-     * @return The message ID as a 32-bit unsigned integer.
-     * @throws std::runtime_error If the packet is too small to contain a valid message ID.
+     * Generated messages start with their ID, on a single byte.
+     *
+     * @param packet The bytes of the formatted packet.
+     * @return The message ID.
+     * @throws std::runtime_error If the packet is malformed or carries no message.
      */
-    uint32_t getMessageId(const std::vector<uint8_t>& packet) {
-        auto unformatted = _protocolManager.unformatPacket(packet);
-        if (unformatted.data.size() < 4) {
+    uint32_t getMessageId(std::span<const uint8_t> packet) const {
+        auto unformatted = _protocolManager.unformatPacketView(packet);
+        if (unformatted.data.empty()) {
             throw std::runtime_error("Invalid packet: too small");
         }
-        return readMessageId(unformatted.data);
+        return unformatted.data[0];
     }
 
     /**
      * @brief Unpacks a formatted packet and deserializes it into a message object.
      *
      * @tparam T The type of the message to be unpacked. The type must implement a `deserialize` method.
-     * @param packet The vector of bytes representing the formatted packet.
+     * @param packet The bytes of the formatted packet.
      * @return The deserialized message object of type T.
      */
     template<typename T>
-    T unpack(const std::vector<uint8_t>& packet) {
-        auto unformatted = _protocolManager.unformatPacket(packet);
-        return T::deserialize(unformatted.data);
+    T unpack(std::span<const uint8_t> packet) const {
+        return T::deserialize(_protocolManager.unformatPacketView(packet).data);
     }
 
- private:
-    ProtocolManager& _protocolManager;
+    /**
+     * @brief Unformats a packet and hands its message to a dispatcher.
+     *
+     * The message is read from the packet itself, only the dispatcher decodes it.
+     *
+     * @tparam Dispatcher A generated MessageDispatcher.
+     * @param packet The bytes of the formatted packet.
+     * @param dispatcher Holds the handlers, indexed by message ID.
+     * @return false if no handler takes the message ID.
+     * @throws std::runtime_error If the packet or the message is malformed.
+     */
+    template<typename Dispatcher>
+    bool dispatch(std::span<const uint8_t> packet,
+        Dispatcher& dispatcher) const {
+        return dispatcher.dispatch(
+            _protocolManager.unformatPacketView(packet).data);
+    }
 
-    uint32_t readMessageId(const std::vector<uint8_t>& data) {
-        if (_protocolManager.getEndianness()
-            == ProtocolManager::Endianness::BIG) {
-            return (static_cast<uint32_t>(data[0]) << 24) |
-                   (static_cast<uint32_t>(data[1]) << 16) |
-                   (static_cast<uint32_t>(data[2]) << 8) |
-                   static_cast<uint32_t>(data[3]);
-        } else {
-            return (static_cast<uint32_t>(data[3]) << 24) |
-                   (static_cast<uint32_t>(data[2]) << 16) |
-                   (static_cast<uint32_t>(data[1]) << 8) |
-                   static_cast<uint32_t>(data[0]);
-        }
+    /**
+     * @brief Unformats every packet of a batch and dispatches their messages.
+     *
+     * Meant for the packets of one Server::unpack call: compressed messages
+     * are decompressed one after the other in the same per-thread buffer.
+     * A malformed packet or message is skipped and counted in the
+     * dispatcher's errors(), the next ones are still dispatched. Errors
+     * thrown by the handlers are not caught.
+     *
+     * @tparam Packets A list of byte buffers, as returned by Server::unpack.
+     * @tparam Dispatcher A generated MessageDispatcher.
+     * @param packets The formatted packets, dispatched in order.
+     * @param dispatcher Holds the handlers, indexed by message ID.
+     * @return The number of messages a handler took.
+     */
+    template<typename Packets, typename Dispatcher>
+    size_t dispatchAll(const Packets& packets, Dispatcher& dispatcher) const {
+        // unformatted as the dispatcher reads them, framing errors counted
+        // with the decoding ones
+        return dispatcher.dispatchAll(packets | std::views::transform(
+            [this](const auto& packet) {
+                try {
+                    return _protocolManager.unformatPacketView(
+                        std::span<const uint8_t>(packet)).data;
+                } catch (const std::runtime_error& e) {
+                    throw typename Dispatcher::MalformedMessage(e.what());
+                }
+            }));
     }
+
+ private:
+    ProtocolManager& _protocolManager;
 };
 
 }  // namespace net
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace net {
+
+/**
+ * @brief Monotonic counter, one writer and any number of readers
+ *
+ * Only the thread driving the owner (Server, Client) increments it, so an
+ * increment is a relaxed load and store instead of a locked read-modify-write:
+ * the hot path pays the same as for a plain integer. Any thread can read it,
+ * e.g. a monitoring thread, and sees a value that is at worst slightly late.
+ */
+class Counter {
+ public:
+    void add(uint64_t n = 1) {
+        _value.store(_value.load(std::memory_order_relaxed) + n,
+            std::memory_order_relaxed);
+    }
+
+    uint64_t value() const { return _value.load(std::memory_order_relaxed); }
+
+ private:
+    std::atomic<uint64_t> _value{0};
+};
+
+/**
+ * @brief Value that can go up and down, same threading rules as Counter
+ */
+class Gauge {
+ public:
+    void set(int64_t value) {
+        _value.store(value, std::memory_order_relaxed);
+    }
+
+    void add(int64_t n) {
+        _value.store(_value.load(std::memory_order_relaxed) + n,
+            std::memory_order_relaxed);
+    }
+
+    int64_t value() const { return _value.load(std::memory_order_relaxed); }
+
+ private:
+    std::atomic<int64_t> _value{0};
+};
+
+/**
+ * @brief Named list of the metrics of an object
+ *
+ * The registry doesn't own the metrics, they stay plain members of their
+ * owner and the registry only points at them. It is filled once in the
+ * owner constructor, after that it can be walked from any thread.
+ */
+class MetricsRegistry {
+ public:
+    enum class Type {
+        COUNTER,
+        GAUGE
+    };
+
+    struct Metric {
+        std::string name;
+        std::string help;
+        std::variant<const Counter*, const Gauge*> metric;
+
+        Type type() const;
+        double value() const;
+    };
+
+    void add(const std::string& name, const std::string& help,
+        const Counter& counter);
+    void add(const std::string& name, const std::string& help,
+        const Gauge& gauge);
+
+    /**
+     * @brief Find a metric by name
+     *
+     * @param name Name of the metric, e.g. "net_server_packets_in_total"
+     * @return const Metric* nullptr if there is none
+     */
+    const Metric* find(const std::string& name) const;
+
+    const std::vector<Metric>& metrics() const { return _metrics; }
+
+ private:
+    std::vector<Metric> _metrics;
+};
+
+}  // namespace net
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Network/NetworkPlatform.hpp"
+#include "Network/LatencyHistogram.hpp"
+#include "Network/Metrics.hpp"
+
+namespace net {
+
+/**
+ * @brief Render metrics in the OpenMetrics text format
+ *
+ * Every function appends to the given string, so a caller can keep one
+ * buffer and reuse its capacity from one export to the next. A full export
+ * is any number of render* calls followed by renderEnd().
+ */
+class MetricsExporter {
+ public:
+    #define OPENMETRICS_CONTENT_TYPE \
+        "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+    /**
+     * @brief Append every counter and gauge of a registry
+     *
+     * Counter names must end in _total, the family name is the same without
+     * it.
+     *
+     * @param registry Metrics to render
+     * @param out Text to append to
+     */
+    static void renderRegistry(const MetricsRegistry& registry,
+        std::string& out);
+
+    /**
+     * @brief Append a gauge with one labelled sample per value
+     *
+     * @param name Family name
+     * @param help Description
+     * @param label Name of the label, e.g. "address"
+     * @param samples Label value and sample value pairs
+     * @param out Text to append to
+     */
+    static void renderLabelledGauge(const std::string& name,
+        const std::string& help, const std::string& label,
+        const std::vector<std::pair<std::string, double>>& samples,
+        std::string& out);
+
+    /**
+     * @brief Append a latency histogram as a summary
+     *
+     * Quantiles 0.5, 0.9, 0.99 and 0.999, plus _sum and _count.
+     *
+     * @param name Family name, should end in _seconds
+     * @param help Description
+     * @param histogram Values to render
+     * @param scale Factor from the histogram unit to the exported one,
+     *  1e-9 for nanoseconds to seconds
+     * @param out Text to append to
+     */
+    static void renderSummary(const std::string& name,
+        const std::string& help, const LatencyHistogram& histogram,
+        double scale, std::string& out);
+
+    /**
+     * @brief Append the end of the exposition, "# EOF"
+     *
+     * @param out Text to append to
+     */
+    static void renderEnd(std::string& out);
+
+    /**
+     * @brief Replace a file atomically
+     *
+     * Writes path.tmp then renames it over path, so a scraper reading the
+     * file never sees a half written exposition.
+     *
+     * @param path File to write
+     * @param text Content
+     * @return true If succeed
+     * @return false If the file couldn't be written or renamed
+     */
+    static bool writeFile(const std::string& path, const std::string& text);
+};
+
+/**
+ * @brief Tiny HTTP responder serving an OpenMetrics exposition
+ *
+ * Listens on 127.0.0.1 only. Nothing runs in the background: serve() is
+ * called from the owner loop, checks the sockets without waiting and
+ * answers every complete request with the text produced by the render
+ * callback. The callback is only called when a scrape is pending. A
+ * response the socket can't take at once is kept and sent by the next
+ * calls, as the scraper reads it.
+ */
+class MetricsEndpoint {
+ public:
+    /**
+     * @brief Construct a new MetricsEndpoint object
+     *
+     * @param port Local port to listen on
+     * @throw NetworkSocket::BindFailed If the port can't be listened on
+     */
+    explicit MetricsEndpoint(uint16_t port);
+
+    /**
+     * @brief Destroy the MetricsEndpoint object, closing every socket
+     */
+    ~MetricsEndpoint();
+
+    MetricsEndpoint(const MetricsEndpoint&) = delete;
+    MetricsEndpoint& operator=(const MetricsEndpoint&) = delete;
+
+    /**
+     * @brief Accept scrapers and answer complete requests, never waits
+     *
+     * @param render Fills the exposition text, given an empty string
+     * @return size_t Number of responses sent in full by this call
+     */
+    size_t serve(const std::function<void(std::string&)>& render);
+
+    uint16_t getPort() const { return _port; }
+
+    #define METRICS_MAX_SCRAPERS 8
+    #define METRICS_MAX_REQUEST 4096
+    #define METRICS_SCRAPE_TIMEOUT std::chrono::seconds(2)
+
+ private:
+    struct Scraper {
+        SocketHandle socket;
+        std::chrono::steady_clock::time_point accepted;
+        std::string request;
+        std::string response;  // set once the request is complete
+        size_t sent = 0;
+    };
+
+    void accept();
+    bool respond(Scraper& scraper,
+        const std::function<void(std::string&)>& render);
+    static bool sendResponse(Scraper& scraper);
+
+    uint16_t _port;
+    SocketHandle _listener;
+    std::vector<Scraper> _scrapers;
+    std::vector<POLLFD> _fds;
+    std::string _body;
+};
+
+}  // namespace net
@@ -30,6 +30,7 @@ typedef int socklen_t;
 #define INVALID_SOCKET_VALUE INVALID_SOCKET
 #define SOCKET_ERROR_VALUE SOCKET_ERROR
 #define CLOSE_SOCKET(s) closesocket(s)
+#define SHUTDOWN_SOCKET(s) ::shutdown(s, SD_BOTH)
 
 // Error codes mapping
 #define WOULD_BLOCK WSAEWOULDBLOCK
@@ -79,6 +80,7 @@ typedef int SocketHandle;
 #define INVALID_SOCKET_VALUE -1
 #define SOCKET_ERROR_VALUE -1
 #define CLOSE_SOCKET(s) ::close(s)
+#define SHUTDOWN_SOCKET(s) ::shutdown(s, SHUT_RDWR)
 
 // Error codes mapping
 #define WOULD_BLOCK EWOULDBLOCK
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <span>
 #include <vector>
 #include <cstdint>
 #include <cstring>
@@ -22,6 +23,19 @@ class PacketSerializer {
         return buffer;
     }
 
+    /**
+     * @brief Views a structure as its raw bytes, without copying it
+     *
+     * @tparam T Type of the structure to view
+     * @param packet Constant reference to the structure, must outlive the span
+     * @return std::span<const uint8_t> Bytes of the structure
+     */
+    template<typename T>
+    static std::span<const uint8_t> view(const T& packet) {
+        return std::span<const uint8_t>(
+            reinterpret_cast<const uint8_t*>(&packet), sizeof(T));
+    }
+
     /**
      * @brief Deserializes a byte vector into a structure
      *
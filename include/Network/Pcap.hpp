@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Network/Address.hpp"
+#include "Network/NetworkSocket.hpp"
+
+namespace net {
+
+/**
+ * @brief Write packets to a pcapng file, readable by Wireshark and tcpdump
+ *
+ * Sockets only give the payload, so every record gets synthetic IPv4 and
+ * UDP or TCP headers (LINKTYPE_RAW) built from the two addresses. TCP
+ * chunks get consecutive sequence numbers per direction so the stream can
+ * be reassembled. Timestamps are wall clock nanoseconds.
+ */
+class PcapWriter {
+ public:
+    /**
+     * @brief Create the file and write the pcapng headers
+     *
+     * @param path File to create, replaced if it exists
+     * @throw OpenFailed If the file can't be created
+     */
+    explicit PcapWriter(const std::string& path);
+
+    /**
+     * @brief Write one datagram or stream chunk
+     *
+     * Chunks bigger than an IPv4 packet are split in several records.
+     *
+     * @param type UDP or TCP
+     * @param source Sender of the data
+     * @param destination Receiver of the data
+     * @param data Payload, as given to or by the socket
+     * @param timestamp Nanoseconds since the epoch, 0 for now
+     */
+    void write(SocketType type, const Address& source,
+        const Address& destination, std::span<const uint8_t> data,
+        uint64_t timestamp = 0);
+
+    /**
+     * @brief Push the buffered records to the file
+     */
+    void flush() { _file.flush(); }
+
+    uint64_t getPacketCount() const { return _packets; }
+
+    class OpenFailed : public std::exception {
+     public:
+        const char* what() const noexcept override {
+            return "Failed to create the capture file";
+        }
+    };
+
+ private:
+    void writeRecord(SocketType type, const Address& source,
+        const Address& destination, std::span<const uint8_t> data,
+        uint64_t timestamp);
+
+    std::ofstream _file;
+    std::vector<uint8_t> _block;
+    std::map<std::pair<uint64_t, uint64_t>, uint32_t> _sequences;
+    uint16_t _ipId = 0;
+    uint64_t _packets = 0;
+};
+
+/**
+ * @brief Read IPv4 UDP and TCP packets back from a pcap or pcapng file
+ *
+ * Reads the files of PcapWriter as well as tcpdump captures: pcap and
+ * pcapng in both byte orders, with raw IP, Ethernet or Linux cooked link
+ * types. Other packets (IPv6, ARP, fragments, ...) are skipped.
+ */
+class PcapReader {
+ public:
+    struct Packet {
+        uint64_t timestamp;  // nanoseconds since the epoch
+        SocketType type;
+        Address source;
+        Address destination;
+        std::vector<uint8_t> data;
+    };
+
+    /**
+     * @brief Open a capture
+     *
+     * @param path File to read
+     * @throw BadCapture If the file can't be opened or isn't a capture
+     */
+    explicit PcapReader(const std::string& path);
+
+    /**
+     * @brief Read the next UDP or TCP packet carrying data
+     *
+     * @param packet Filled with the packet
+     * @return true If a packet was read
+     * @return false At the end of the file
+     * @throw BadCapture If the file is truncated or malformed
+     */
+    bool next(Packet& packet);
+
+    class BadCapture : public std::exception {
+     public:
+        explicit BadCapture(std::string msg = "Invalid capture file")
+            : _msg(msg) {}
+
+        const char* what() const noexcept override {
+            return _msg.c_str();
+        }
+     private:
+        std::string _msg;
+    };
+
+ private:
+    struct Interface {
+        uint16_t linkType;
+        uint64_t unitsPerSecond;
+    };
+
+    bool read(void* buffer, size_t size, bool eofAllowed = false);
+    uint16_t get16(const uint8_t* data) const;
+    uint32_t get32(const uint8_t* data) const;
+    bool nextPcap(Packet& packet, bool& decoded);
+    bool nextPcapng(Packet& packet, bool& decoded);
+    void readInterface(const std::vector<uint8_t>& body);
+    bool decode(uint16_t linkType, std::span<const uint8_t> frame,
+        Packet& packet) const;
+
+    std::ifstream _file;
+    bool _pcapng = false;
+    bool _bigEndian = false;
+    uint16_t _linkType = 0;
+    uint64_t _unitsPerSecond = 1000000;
+    std::vector<Interface> _interfaces;
+    std::vector<uint8_t> _block;
+};
+
+}  // namespace net
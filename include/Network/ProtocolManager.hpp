@@ -1,5 +1,6 @@
 #pragma once
 
+#include <span>
 #include <string>
 #include <vector>
 #include <cstdint>
@@ -37,6 +38,12 @@ class ProtocolManager {
         std::string characters;
     };
 
+    // TCP only: each direction of a connection is one LZ4 stream
+    struct stream_compression {
+        bool active;
+        int level;  // 0 for LZ4, 1 to 12 for LZ4HC
+    };
+
     struct UnformattedPacket {
         std::vector<uint8_t> data;
         uint32_t packetLength;
@@ -45,6 +52,14 @@ class ProtocolManager {
         bool hasTimestamp;
     };
 
+    struct UnformattedPacketView {
+        std::span<const uint8_t> data;
+        uint32_t packetLength;
+        uint64_t timestamp;
+        bool hasLength;
+        bool hasTimestamp;
+    };
+
     /**
      * @brief Construct a new Protocol Manager object
      * 
@@ -67,6 +82,10 @@ class ProtocolManager {
      *   "end_of_packet": {
      *       "active": true,
      *       "characters": "\r\n"
+     *   },
+     *   "stream_compression": {
+     *       "active": false,
+     *       "level": 0
      *   }
      * }
      */
@@ -84,7 +103,41 @@ class ProtocolManager {
      * @param data Data that you want to format
      * @return std::vector<uint8_t> Formatted packet
      */
-    std::vector<uint8_t> formatPacket(std::vector<uint8_t> data);
+    std::vector<uint8_t> formatPacket(std::span<const uint8_t> data);
+
+    /**
+     * @brief Format a packet into an existing buffer
+     * 
+     * The buffer is cleared first, its capacity is kept so a buffer reused
+     * across calls stops allocating once it is big enough.
+     * 
+     * @param data Data that you want to format
+     * @param out Filled with the formatted packet
+     */
+    void formatPacketInto(std::span<const uint8_t> data,
+        std::vector<uint8_t>& out);
+
+    /**
+     * @brief Start a packet whose data is written in place
+     * 
+     * Writes the header to out and leaves room for maxSize bytes of data
+     * after it, the caller writes them then calls finishPacket. Saves the
+     * copy of formatPacketInto when the data is produced for the packet,
+     * e.g. a serialized message.
+     * 
+     * @param maxSize Data bytes that may be written
+     * @param out Cleared first, its capacity is kept
+     * @return std::span<uint8_t> Room for the data, valid until out changes
+     */
+    std::span<uint8_t> beginPacket(size_t maxSize, std::vector<uint8_t>& out);
+
+    /**
+     * @brief End a packet started by beginPacket
+     * 
+     * @param size Data bytes actually written, at most maxSize
+     * @param out The buffer given to beginPacket
+     */
+    void finishPacket(size_t size, std::vector<uint8_t>& out) const;
 
     /**
      * @brief Extract the raw data and informations from a formatted packet
@@ -94,6 +147,16 @@ class ProtocolManager {
      */
     UnformattedPacket unformatPacket(const std::vector<uint8_t> &formattedData);
 
+    /**
+     * @brief Same checks as unformatPacket, without copying the data
+     * 
+     * @param formattedData Packet formatted, must outlive the result
+     * @return UnformattedPacketView Informations from the packet, data
+     * pointing into formattedData
+     */
+    UnformattedPacketView unformatPacketView(
+        std::span<const uint8_t> formattedData) const;
+
     /**
      * @brief Calculate overhead size added by the protocol
      * 
@@ -129,6 +192,16 @@ class ProtocolManager {
      */
     const end_of_packet& getEndOfPacket() const;
 
+    /**
+     * @brief Get the _stream_compression object
+     * 
+     * Both ends of a TCP connection must agree on it, they read the same
+     * protocol.json.
+     * 
+     * @return const stream_compression& 
+     */
+    const stream_compression& getStreamCompression() const;
+
     /**
      * @brief Get the _endianness object
      * 
@@ -142,6 +215,7 @@ class ProtocolManager {
     packet_length _packet_length;
     datetime _datetime;
     end_of_packet _end_of_packet;
+    stream_compression _stream_compression;
     Endianness _endianness;
 
     uint64_t getCurrentTimestamp() const;
@@ -150,9 +224,9 @@ class ProtocolManager {
     void writeUint32(std::vector<uint8_t>& buffer, uint32_t value) const;
     void writeUint64(std::vector<uint8_t>& buffer,
         uint64_t value, int numBytes) const;
-    uint32_t readUint32(const std::vector<uint8_t>& buffer,
+    uint32_t readUint32(std::span<const uint8_t> buffer,
         size_t offset, int numBytes) const;
-    uint64_t readUint64(const std::vector<uint8_t>& buffer,
+    uint64_t readUint64(std::span<const uint8_t> buffer,
         size_t offset, int numBytes) const;
 };
 
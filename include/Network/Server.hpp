@@ -1,16 +1,30 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include <chrono>
+#include <functional>
+#include <ostream>
 
 #include "Network/NetworkPlatform.hpp"
 #include "Network/Address.hpp"
+#include "Network/AddressTable.hpp"
 #include "Network/NetworkSocket.hpp"
 #include "Network/ProtocolManager.hpp"
+#include "Network/TimerWheel.hpp"
 #include "Network/Logger.hpp"
+#include "Network/Lz4.hpp"
+#include "Network/Metrics.hpp"
+#include "Network/MetricsExporter.hpp"
+#include "Network/Pcap.hpp"
+#include "Network/LatencyHistogram.hpp"
+#include "Network/TopTalkers.hpp"
 
 #define CAST_UINT32 static_cast<uint32_t>
 
@@ -20,6 +34,8 @@ namespace net {
  * @brief Communicate in UDP or TCP with multiple Client
  *
  * Use ProtocolManager class to format and unformat packets sent and received.
+ * In TCP, with "stream_compression" active, the formatted packets sent and
+ * received on each connection go through an LZ4 stream.
  * @see ProtocolManager
  */
 class Server {
@@ -31,9 +47,11 @@ class Server {
      * @param protocol Choose the communication type of your Server.
      *  Mode -> "UDP" or "TCP".
      * @param path Path to the protocol.json containing the config
+     * @param logging Write the logs in ./logs, every packet sent and
+     *  received is logged
      */
     explicit Server(uint16_t port, const std::string& protocol = "UDP",
-        const std::string& path = "config/protocol.json");
+        const std::string& path = "config/protocol.json", bool logging = true);
 
     /**
      * @brief Destroy the Server object
@@ -61,12 +79,176 @@ class Server {
     /**
      * @brief Evaluate bandwidth usage
      *
+     * Computed from the bytes counters of getMetrics(), which keep counting.
+     *
      * @return std::size_t : An average of bytes per second sent and received
      * since the last call
      * The more often you call it, the more precise it is
      */
     std::size_t evalBandwidthUsage();
 
+    /**
+     * @brief Counters and gauges of the Server
+     *
+     * Updated by the thread calling the Server methods, readable from any
+     * other thread. Counters never reset.
+     */
+    struct Metrics {
+        Counter packetsIn;           // packets handed out by unpack
+        Counter packetsOut;          // packets sent whole
+        Counter bytesIn;             // bytes read from the sockets
+        Counter bytesOut;            // bytes written to the sockets
+        Counter receives;            // datagrams or TCP reads
+        Counter drops;               // packets that failed to be sent whole
+        Counter framingErrors;       // malformed input found by unpack
+        Counter syscalls;            // poll, accept, recv and send calls
+        Gauge clients;               // UDP and TCP clients known
+        Gauge inputQueueBytes;       // received bytes not unpacked yet
+        Gauge syscallsLastReceive;   // syscalls of the last *Receive call
+    };
+
+    /**
+     * @brief Get the metrics of the Server
+     *
+     * @return const Metrics&
+     */
+    const Metrics& getMetrics() const { return _metrics; }
+
+    /**
+     * @brief Get the metrics of the Server by name, for exporters
+     *
+     * Names follow the Prometheus conventions: net_server_*, counters end in
+     * _total.
+     *
+     * @return const MetricsRegistry&
+     */
+    const MetricsRegistry& getMetricsRegistry() const {
+        return _metricsRegistry;
+    }
+
+    /**
+     * @brief Latency histograms of the Server, in nanoseconds
+     *
+     * Receive side, per packet handed out by unpack:
+     * - receiveToFramed: first byte read to last byte read (TCP fragments)
+     * - framedToUnpack: last byte read to handed out, time spent in input
+     * - receiveToUnpack: first byte read to handed out
+     *
+     * Send side, per tcpSend / udpSend call:
+     * - sendEnqueueToWrite: call to first write (framing and logging)
+     * - sendWrite: time spent in the write syscalls, i.e. blocked
+     */
+    struct Latencies {
+        LatencyHistogram receiveToFramed;
+        LatencyHistogram framedToUnpack;
+        LatencyHistogram receiveToUnpack;
+        LatencyHistogram sendEnqueueToWrite;
+        LatencyHistogram sendWrite;
+    };
+
+    /**
+     * @brief Enable or disable the latency histograms
+     *
+     * Disabled by default. When enabled, the Server reads the steady clock
+     * once per read, once per unpack call and twice per send, and keeps the
+     * read time of the bytes waiting in each ClientInfo::input. Disabling
+     * drops the histograms.
+     *
+     * @param enabled true to record latencies
+     */
+    void setLatencyTracking(bool enabled);
+
+    /**
+     * @brief Get the latency histograms
+     *
+     * Only valid from the thread driving the Server.
+     *
+     * @return const Latencies* nullptr if latency tracking is disabled
+     */
+    const Latencies* getLatencies() const { return _latencies.get(); }
+
+    /**
+     * @brief Forget every latency recorded so far
+     */
+    void resetLatencies();
+
+    /**
+     * @brief Write a table of the latency histograms, in microseconds
+     *
+     * One line per histogram: count, min, p50, p90, p99, p999, max and mean.
+     *
+     * @param out Stream to write to
+     */
+    void dumpLatencies(std::ostream& out) const;
+
+    /**
+     * @brief Render every metric of the Server in the OpenMetrics text format
+     *
+     * Counters and gauges of getMetrics(), top talkers and, when enabled,
+     * latencies as summaries in seconds.
+     *
+     * @param out Text to append to
+     */
+    void renderMetrics(std::string& out) const;
+
+    /**
+     * @brief Write renderMetrics() to a file, atomically
+     *
+     * Meant to be called periodically for scrapers reading files, e.g. the
+     * node exporter textfile collector.
+     *
+     * @param path File to replace
+     * @return true If succeed
+     * @return false If the file couldn't be written
+     */
+    bool writeMetricsFile(const std::string& path);
+
+    /**
+     * @brief Serve renderMetrics() over HTTP on 127.0.0.1
+     *
+     * Scrapes are answered from udpReceive / tcpReceive, at most every
+     * METRICS_POLL_INTERVAL ms, or from serveMetrics(). Nothing is rendered
+     * nor allocated when no scrape is pending.
+     *
+     * @param port Local port, 0 for any free one (see getMetricsPort())
+     * @return true If succeed
+     * @return false If the port couldn't be listened on
+     */
+    bool exposeMetrics(uint16_t port);
+
+    /**
+     * @brief Answer the pending scrapes now, never waits
+     *
+     * @return size_t Number of scrapes answered
+     */
+    size_t serveMetrics();
+
+    /**
+     * @brief Get the port metrics are served on
+     *
+     * @return uint16_t The port, 0 if exposeMetrics() wasn't called
+     */
+    uint16_t getMetricsPort() const {
+        return _metricsEndpoint ? _metricsEndpoint->getPort() : 0;
+    }
+
+    /**
+     * @brief Capture every datagram or stream chunk read and sent
+     *
+     * Written to a pcapng file with synthetic IPv4 headers, the Server side
+     * being 127.0.0.1:port. Replay it with net_replay. Replaces the capture
+     * in progress if any.
+     *
+     * @param path File to create
+     * @throw PcapWriter::OpenFailed If the file can't be created
+     */
+    void startCapture(const std::string& path);
+
+    /**
+     * @brief Stop the capture in progress and close its file
+     */
+    void stopCapture();
+
     /**
      * @brief Set the Server non-blocking
      * It will not wait packets before doing something
@@ -89,20 +271,31 @@ class Server {
     /**
      * @brief Send data to specific client
      *
+     * Datas are copied once, straight into the framed packet. Any contiguous
+     * buffer works (std::vector, std::array, pmr vector, ...).
+     *
+     * A failed send that leaves the client's stream out of step (part of a
+     * packet sent, or stream compression active) shuts the connection down,
+     * the next tcpReceive() disconnects the client.
+     *
      * @param dest FD of the client
      * @param data Datas that will be sent
-     * @return int Size of datas sent
+     * @return int Size of datas sent, once compressed with stream compression
+     * @throw NetworkSocket::DataSendFailed If the data couldn't be sent
      */
-    int tcpSend(const int dest, std::vector<uint8_t> data);
+    int tcpSend(const int dest, std::span<const uint8_t> data);
 
     /**
      * @brief Send data to specific client
      *
+     * Datas are copied once, straight into the framed packet. Any contiguous
+     * buffer works (std::vector, std::array, pmr vector, ...).
+     *
      * @param dest Address of the client. @see Address
      * @param data Datas that will be sent
      * @return int Size of datas sent
      */
-    int udpSend(const Address& dest, std::vector<uint8_t> data);
+    int udpSend(const Address& dest, std::span<const uint8_t> data);
 
     /**
      * @brief Receive datas sent by connected clients (TCP mode)
@@ -142,6 +335,52 @@ class Server {
      */
     std::vector<std::vector<uint8_t>> unpack(const Address& src, int nbPackets);
 
+    /**
+     * @brief Same as unpack(int, int) but every returned buffer is allocated
+     *  from the given memory resource (TCP mode)
+     *
+     * Pass getTickArena() to allocate the whole tick working set from the
+     * Server arena, then release it at once with resetTickArena().
+     *
+     * @param src Client's FD that you want to unpack datas
+     * @param nbPackets Number of packets you want to extract
+     * @param arena Memory resource used for the result and every packet
+     * @return std::pmr::vector<std::pmr::vector<uint8_t>> Unpacked datas
+     */
+    std::pmr::vector<std::pmr::vector<uint8_t>> unpack(int src, int nbPackets,
+        std::pmr::memory_resource* arena);
+
+    /**
+     * @brief Same as unpack(const Address&, int) but every returned buffer is
+     *  allocated from the given memory resource (UDP mode)
+     *
+     * @param src Client's Address that you want to unpack datas
+     * @param nbPackets Number of packets you want to extract
+     * @param arena Memory resource used for the result and every packet
+     * @return std::pmr::vector<std::pmr::vector<uint8_t>> Unpacked datas
+     */
+    std::pmr::vector<std::pmr::vector<uint8_t>> unpack(const Address& src,
+        int nbPackets, std::pmr::memory_resource* arena);
+
+    /**
+     * @brief Get the per-tick arena
+     *
+     * Monotonic resource backed by a buffer owned by the Server. Allocations
+     * are never freed one by one, everything goes away on resetTickArena().
+     *
+     * @return std::pmr::memory_resource* The arena, valid as long as the Server
+     */
+    std::pmr::memory_resource* getTickArena() { return &_tickArena; }
+
+    /**
+     * @brief Release everything allocated from the tick arena
+     *
+     * Every container allocated from getTickArena() must be destroyed or
+     * unused before calling it. Memory is rewound to the initial buffer,
+     * extra chunks obtained while the buffer was full are given back.
+     */
+    void resetTickArena() { _tickArena.release(); }
+
     /**
      * @brief Return the state of the server
      *
@@ -173,16 +412,104 @@ class Server {
      */
     int acceptClient(Address& client_addr, uint64_t currentTime);
 
+    // read time of the input bytes before streamOffset + end
+    struct Arrival {
+        uint64_t end;
+        uint64_t time;  // steady clock, in nanoseconds
+    };
+
     struct ClientInfo {
-        uint64_t lastPacketTime;
+        uint64_t lastPacketTime;  // steady clock, in milliseconds
         std::vector<uint8_t> input;
         std::vector<uint8_t> output;
+        Address address;
+        // traffic of this client only, see getMetrics() for the totals
+        uint64_t bytesIn = 0;
+        uint64_t bytesOut = 0;
+        uint64_t packetsIn = 0;
+        uint64_t packetsOut = 0;
+        uint64_t framingErrors = 0;
+        // only filled while latency tracking is enabled: an empty vector
+        // allocates nothing, and holds a couple of reads at a time once on
+        uint64_t streamOffset = 0;  // bytes removed from input so far
+        std::vector<Arrival> arrivals;
     };
 
+    struct Talker {
+        Address address;
+        uint64_t bytes;  // estimated, never below the real count
+        uint64_t error;  // max overestimation of bytes
+    };
+
+    /**
+     * @brief Get the clients that used the most bandwidth
+     *
+     * Bytes sent and received by each address are summed in a Space-Saving
+     * summary of TOP_TALKERS entries, updated in constant time per read and
+     * send. Every address weighing more than 1 / TOP_TALKERS of the traffic
+     * is listed, even once disconnected.
+     *
+     * @param n Max number of talkers
+     * @return std::vector<Talker> Up to n talkers, heaviest first
+     */
+    std::vector<Talker> getTopTalkers(size_t n = 10) const;
+
+    /**
+     * @brief Forget the top talkers, e.g. to start a new time window
+     */
+    void resetTopTalkers() { _topTalkers.clear(); }
+
+    /**
+     * @brief Evict UDP clients that sent nothing for a while
+     *
+     * Expiry is driven by a timing wheel: checking costs nothing for clients
+     * that are still active and O(1) per evicted client. Expired clients are
+     * removed by expireIdleClients(), which udpReceive() calls each time.
+     *
+     * @param timeout Idle time before eviction, 0 disables eviction
+     * @param onEvict Called with the client right before it is removed
+     */
+    void setClientTimeout(std::chrono::milliseconds timeout,
+        std::function<void(const Address&, const ClientInfo&)> onEvict
+            = nullptr);
+
+    /**
+     * @brief Be told when a TCP client disconnects, e.g. to drop the state
+     * kept for it (UDP clients have no connection, see setClientTimeout)
+     *
+     * @param onDisconnect Called with the client right before it is removed
+     */
+    void setDisconnectHandler(
+        std::function<void(const Address&, const ClientInfo&)> onDisconnect);
+
+    /**
+     * @brief Erase the entry of a client from a table when it leaves
+     *
+     * On eviction, TCP disconnection and stop(), after the handlers. Meant
+     * for the state kept per client, e.g. the ClientBaselines of a delta
+     * message: the next client on the same address starts from empty
+     * messages instead of baselines it never received.
+     *
+     * @param table Kept by reference, must outlive the server
+     */
+    template<typename V>
+    void addClientTable(AddressTable<V>& table) {
+        _clientTables.push_back([&table](const Address& address) {
+            table.erase(address);
+        });
+    }
+
+    /**
+     * @brief Remove the UDP clients idle for longer than the client timeout
+     *
+     * @return size_t Number of clients evicted
+     */
+    size_t expireIdleClients();
+
     // Testing purpose
-    const std::unordered_map<Address, ClientInfo>& getUdpClients() const;
+    const AddressTable<ClientInfo>& getUdpClients() const;
     const std::unordered_map<int, ClientInfo>& getTcpClients() const;
-    std::unordered_map<Address, ClientInfo>& getUdpClientsRef();
+    AddressTable<ClientInfo>& getUdpClientsRef();
     std::unordered_map<int, ClientInfo>& getTcpClientsRef();
 
     #define NB_SERVERFD 1
@@ -239,14 +566,41 @@ class Server {
     };
 
  private:
-    std::vector<std::vector<uint8_t>> getDataFromBuffer(
-            int nbPackets, ClientInfo &client);
+    template<typename PacketList>
+    PacketList getDataFromBuffer(int nbPackets, ClientInfo &client,
+            const typename PacketList::allocator_type& alloc);
+
+    void registerMetrics();
+    void removeClientInput(const ClientInfo& client);
+    void forgetClient(const Address& address);
+    void disconnectTcpClient(size_t index);
+    void appendInput(ClientInfo& client, const uint8_t* data, size_t size);
+    void consumeInput(ClientInfo& client, size_t size, uint64_t now);
+    void recordSend(uint64_t enqueued, uint64_t writeStart);
+    void pollMetrics();
+    void capture(const Address& source, const Address& destination,
+        std::span<const uint8_t> data);
+
+    #define TICK_ARENA_SIZE (256 * 1024)
+    #define CLIENT_TIMEOUT_RESOLUTION 10
+    #define TOP_TALKERS 32
+    #define METRICS_POLL_INTERVAL 10
+    #define UDP_RESULTS_RESERVE 64
 
     uint16_t _port;
     NetworkSocket _socket;
     bool _running;
-    std::size_t _bytesOut = 0;
-    std::size_t _bytesIn = 0;
+    Metrics _metrics;
+    MetricsRegistry _metricsRegistry;
+    uint64_t _lastBytesOut = 0;
+    uint64_t _lastBytesIn = 0;
+    std::unique_ptr<Latencies> _latencies;
+    TopTalkers _topTalkers;
+    std::unique_ptr<MetricsEndpoint> _metricsEndpoint;
+    uint64_t _nextMetricsPoll = 0;
+    std::string _metricsText;
+    std::unique_ptr<PcapWriter> _capture;
+    Address _captureAddress;
 
     std::size_t _bytesOutPerSecond = 0;
     std::size_t _bytesInPerSecond = 0;
@@ -261,8 +615,30 @@ class Server {
 
     std::unordered_map<int, Address> _tcp_links;
 
-    std::unordered_map<Address, ClientInfo> _udp_clients;
+    AddressTable<ClientInfo> _udp_clients;
     std::unordered_map<int, ClientInfo> _tcp_clients;
+
+    std::vector<uint8_t> _sendBuffer;
+    std::vector<uint8_t> _receiveBuffer;
+
+    // compression of a TCP connection, when "stream_compression" is active
+    struct TcpStream {
+        explicit TcpStream(int level) : encoder(level) {}
+
+        lz4::StreamEncoder encoder;
+        lz4::StreamDecoder decoder;
+    };
+    std::unordered_map<int, TcpStream> _tcp_streams;
+    std::vector<uint8_t> _streamBuffer;
+
+    uint64_t _clientTimeout = 0;
+    std::function<void(const Address&, const ClientInfo&)> _onClientEvict;
+    std::function<void(const Address&, const ClientInfo&)> _onDisconnect;
+    std::vector<std::function<void(const Address&)>> _clientTables;
+    TimerWheel _idleClients;
+
+    std::unique_ptr<std::byte[]> _tickArenaBuffer;
+    std::pmr::monotonic_buffer_resource _tickArena;
 };
 
 }  // namespace net
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace net {
+
+/**
+ * @brief Hierarchical timing wheel
+ *
+ * 4 levels of 64 slots, a level covering 64 times the range of the one
+ * below. Scheduling is O(1), a timer is moved down at most 3 times before it
+ * fires, so advancing costs amortized O(1) per timer plus one step per 64
+ * empty ticks. Deadlines further than 64^4 ticks are parked in the last
+ * level and placed again when they come closer.
+ *
+ * Timers can't be cancelled: the owner checks on expiry whether the timer is
+ * still relevant, and schedules it again if the deadline moved.
+ *
+ * Time is any monotonic unsigned count (milliseconds for Server and Client).
+ */
+class TimerWheel {
+ public:
+    /**
+     * @brief Construct a new TimerWheel object
+     *
+     * @param resolution Time units per tick, deadlines are rounded up to it
+     * @param now Current time
+     */
+    explicit TimerWheel(uint64_t resolution = 1, uint64_t now = 0);
+
+    /**
+     * @brief Schedule a timer
+     *
+     * @param id Identifier given back on expiry
+     * @param deadline Time at which the timer expires
+     */
+    void schedule(uint64_t id, uint64_t deadline);
+
+    /**
+     * @brief Move the wheel forward and fire every timer due
+     *
+     * The callback may schedule new timers.
+     *
+     * @tparam F Callable as onExpire(uint64_t id)
+     * @param now Current time
+     * @param onExpire Called once for each expired timer
+     */
+    template<typename F>
+    void advance(uint64_t now, F&& onExpire) {
+        uint64_t target = now / _resolution;
+
+        while (_current < target) {
+            if (_size == 0) {
+                _current = target;
+                break;
+            }
+            if (_occupied[0] == 0) {
+                // nothing can fire before the next level 0 turn
+                uint64_t boundary = _current | (SLOTS - 1);
+                if (boundary >= target) {
+                    _current = target;
+                    break;
+                }
+                _current = boundary;
+            }
+            ++_current;
+            cascade();
+
+            size_t slot = _current & (SLOTS - 1);
+            if (!(_occupied[0] & (1ULL << slot)))
+                continue;
+            _pending.swap(_slots[0][slot]);
+            _occupied[0] &= ~(1ULL << slot);
+            _size -= _pending.size();
+            for (const Timer& timer : _pending)
+                onExpire(timer.id);
+            _pending.clear();
+        }
+    }
+
+    /**
+     * @brief Get the number of scheduled timers
+     *
+     * @return size_t
+     */
+    size_t size() const { return _size; }
+
+    /**
+     * @brief Drop every timer, slot capacity is kept
+     *
+     * @param now Current time
+     */
+    void clear(uint64_t now);
+
+ private:
+    static constexpr size_t LEVELS = 4;
+    static constexpr size_t SLOT_BITS = 6;
+    static constexpr size_t SLOTS = 1 << SLOT_BITS;
+
+    struct Timer {
+        uint64_t id;
+        uint64_t tick;
+    };
+
+    void insert(const Timer& timer);
+    void cascade();
+
+    uint64_t _resolution;
+    uint64_t _current;
+    size_t _size = 0;
+    std::array<uint64_t, LEVELS> _occupied{};
+    std::array<std::array<std::vector<Timer>, SLOTS>, LEVELS> _slots;
+    std::vector<Timer> _pending;
+};
+
+}  // namespace net
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace net {
+
+/**
+ * @brief Heaviest keys of a weighted stream, Space-Saving algorithm
+ *
+ * Keeps a fixed number of counters. A key already counted is increased, a
+ * new key takes the place of the smallest counter and inherits its value,
+ * remembered as the error of the new count. So a count is never below the
+ * real weight of its key and at most error above, and every key weighing
+ * more than total() / capacity is in the summary.
+ *
+ * Adding is a scan of the capacity keys, constant per call, and never
+ * allocates: the capacity is meant to stay small (tens of keys).
+ */
+class TopTalkers {
+ public:
+    struct Entry {
+        uint64_t key;
+        uint64_t count;  // estimated weight, never below the real one
+        uint64_t error;  // max overestimation of count
+    };
+
+    /**
+     * @brief Construct a new TopTalkers object
+     *
+     * @param capacity Number of keys followed
+     */
+    explicit TopTalkers(size_t capacity = 32);
+
+    /**
+     * @brief Add weight to a key
+     *
+     * @param key Identifier of the talker, e.g. Address::toKey()
+     * @param weight Weight to add, e.g. a number of bytes
+     */
+    void add(uint64_t key, uint64_t weight);
+
+    /**
+     * @brief Get the heaviest keys
+     *
+     * @param n Max number of keys
+     * @return std::vector<Entry> Up to n entries, heaviest first
+     */
+    std::vector<Entry> top(size_t n) const;
+
+    /**
+     * @brief Forget every key
+     */
+    void clear();
+
+    size_t capacity() const { return _keys.size(); }
+    uint64_t total() const { return _total; }
+
+ private:
+    std::vector<uint64_t> _keys;  // scanned on every add, kept apart
+    std::vector<Entry> _entries;
+    size_t _size = 0;
+    uint64_t _total = 0;
+};
+
+}  // namespace net
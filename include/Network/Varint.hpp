@@ -0,0 +1,117 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace net {
+
+/**
+ * @brief LEB128 integers, 7 bits per byte with the low bits first
+ *
+ * The high bit of a byte is set when another byte follows, so values below
+ * 128 take a single byte. Signed values are zigzag mapped first (0, -1, 1,
+ * -2... become 0, 1, 2, 3...) to keep small negative numbers short.
+ *
+ * Used by the generated messages for "varint" integer fields and for the
+ * length of "varlen" strings.
+ */
+namespace varint {
+
+/** @brief Largest encoding of a 64 bit value */
+constexpr size_t MAX_SIZE = 10;
+
+constexpr uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^
+        static_cast<uint64_t>(value >> 63);
+}
+
+constexpr int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/**
+ * @brief Bytes taken by the encoding of a value
+ */
+constexpr size_t size(uint64_t value) {
+    return 1 + (63 - std::countl_zero(value | 1)) / 7;
+}
+
+/**
+ * @brief Write a value
+ *
+ * @param out At least size(value) bytes
+ * @return size_t Bytes written
+ */
+inline size_t write(uint8_t* out, uint64_t value) {
+    size_t length = 0;
+
+    while (value >= 0x80) {
+        out[length++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = static_cast<uint8_t>(value);
+    return length;
+}
+
+/**
+ * @brief Read a value coming from the wire
+ *
+ * @param data Bytes to read from
+ * @param offset Position of the value in data
+ * @param value Set to the value read
+ * @return size_t Bytes read, 0 if data ends before the value does, if the
+ * value does not fit in 64 bits or if it is not in its shortest form (a
+ * value has a single encoding, so it writes back to the same bytes)
+ */
+inline size_t read(std::span<const uint8_t> data, size_t offset,
+    uint64_t& value) {
+    // most lengths and counters fit in a byte
+    if (offset < data.size() && data[offset] < 0x80) {
+        value = data[offset];
+        return 1;
+    }
+
+    uint64_t result = 0;
+    size_t end = offset + MAX_SIZE < data.size() ? offset + MAX_SIZE :
+        data.size();
+    for (size_t i = offset, shift = 0; i < end; ++i, shift += 7) {
+        uint8_t byte = data[i];
+        if (shift == 63 && byte > 1)
+            return 0;
+        result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (byte < 0x80) {
+            if (byte == 0)
+                return 0;
+            value = result;
+            return i - offset + 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Read a value already checked by read()
+ *
+ * @return size_t Bytes read
+ */
+inline size_t readUnchecked(const uint8_t* in, uint64_t& value) {
+    if (in[0] < 0x80) {
+        value = in[0];
+        return 1;
+    }
+
+    uint64_t result = 0;
+    size_t length = 0;
+    for (uint8_t byte = 0x80; byte & 0x80; ++length) {
+        byte = in[length];
+        result |= static_cast<uint64_t>(byte & 0x7F) << (7 * length);
+    }
+    value = result;
+    return length;
+}
+
+}  // namespace varint
+
+}  // namespace net
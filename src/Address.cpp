@@ -29,6 +29,13 @@ Address::Address(uint32_t ip, uint16_t port) {
     _port = port;
 }
 
+Address Address::fromKey(uint64_t key) {
+    Address a;
+    a._ip = static_cast<uint32_t>(key >> 16);
+    a._port = static_cast<uint16_t>(key & 0xFFFF);
+    return a;
+}
+
 Address Address::fromSockAddr(const sockaddr_in& addr) {
     Address a;
     a._ip = addr.sin_addr.s_addr;
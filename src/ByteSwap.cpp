@@ -0,0 +1,136 @@
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#include "Network/ByteSwap.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NET_BYTESWAP_X86
+#include <immintrin.h>
+#endif
+
+namespace net {
+
+namespace {
+
+template<typename T>
+void swapElements(uint8_t* dst, const uint8_t* src, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        T value;
+        std::memcpy(&value, src + i * sizeof(T), sizeof(T));
+        value = std::byteswap(value);
+        std::memcpy(dst + i * sizeof(T), &value, sizeof(T));
+    }
+}
+
+void swapScalar(uint8_t* dst, const uint8_t* src, size_t count,
+    size_t width) {
+    switch (width) {
+        case 2:
+            swapElements<uint16_t>(dst, src, count);
+            break;
+        case 4:
+            swapElements<uint32_t>(dst, src, count);
+            break;
+        case 8:
+            swapElements<uint64_t>(dst, src, count);
+            break;
+        default:
+            if (dst != src)
+                std::memmove(dst, src, count * width);
+    }
+}
+
+#ifdef NET_BYTESWAP_X86
+
+// pshufb control reversing every 2, 4 or 8 bytes of a 16 byte lane
+alignas(16) const uint8_t SHUFFLE_2[16] = {
+    1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14};
+alignas(16) const uint8_t SHUFFLE_4[16] = {
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+alignas(16) const uint8_t SHUFFLE_8[16] = {
+    7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8};
+
+const uint8_t* shuffleOf(size_t width) {
+    if (width == 2)
+        return SHUFFLE_2;
+    return width == 4 ? SHUFFLE_4 : SHUFFLE_8;
+}
+
+// a 16 byte block always holds whole elements, so the tail is too
+__attribute__((target("ssse3")))
+void swapSsse3(uint8_t* dst, const uint8_t* src, size_t count,
+    size_t width) {
+    if (width != 2 && width != 4 && width != 8)
+        return swapScalar(dst, src, count, width);
+
+    const __m128i shuffle = _mm_load_si128(
+        reinterpret_cast<const __m128i*>(shuffleOf(width)));
+    size_t bytes = count * width;
+    size_t i = 0;
+
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i block = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+            _mm_shuffle_epi8(block, shuffle));
+    }
+    swapScalar(dst + i, src + i, (bytes - i) / width, width);
+}
+
+// vpshufb shuffles each 128 bit lane on its own, same control in both
+__attribute__((target("avx2")))
+void swapAvx2(uint8_t* dst, const uint8_t* src, size_t count,
+    size_t width) {
+    if (width != 2 && width != 4 && width != 8)
+        return swapScalar(dst, src, count, width);
+
+    const __m256i shuffle = _mm256_broadcastsi128_si256(_mm_load_si128(
+        reinterpret_cast<const __m128i*>(shuffleOf(width))));
+    size_t bytes = count * width;
+    size_t i = 0;
+
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i block = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+            _mm256_shuffle_epi8(block, shuffle));
+    }
+    swapScalar(dst + i, src + i, (bytes - i) / width, width);
+}
+
+#endif
+
+using SwapFunction = void (*)(uint8_t*, const uint8_t*, size_t, size_t);
+
+SwapFunction pickSwap() {
+#ifdef NET_BYTESWAP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return swapAvx2;
+    if (__builtin_cpu_supports("ssse3"))
+        return swapSsse3;
+#endif
+    return swapScalar;
+}
+
+}  // namespace
+
+void byteswapCopy(void* dst, const void* src, size_t count, size_t width) {
+    static const SwapFunction swap = pickSwap();
+
+    if (count == 0)
+        return;
+    swap(static_cast<uint8_t*>(dst), static_cast<const uint8_t*>(src),
+        count, width);
+}
+
+void byteswapCopyScalar(void* dst, const void* src, size_t count,
+    size_t width) {
+    if (count == 0)
+        return;
+    swapScalar(static_cast<uint8_t*>(dst), static_cast<const uint8_t*>(src),
+        count, width);
+}
+
+}  // namespace net
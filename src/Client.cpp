@@ -1,23 +1,28 @@
 #include <iostream>
 #include <cstring>
+#include <memory>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <algorithm>
 #include <chrono>
 #include <functional>
 #include <unordered_map>
+#include <utility>
 
 #include "Network/Client.hpp"
 #include "Network/NetworkPlatform.hpp"
 
 namespace net {
 
-Client::Client(const std::string& protocol, const std::string& path)
+Client::Client(const std::string& protocol, const std::string& path,
+    bool logging)
     : _socket(),
     _server_address(),
     _connected(false),
     _protocol(path),
-    _logger(true, "./logs", "client") {
+    _logger(logging, "./logs", "client") {
     SocketType type;
 
     if (protocol == "TCP" || protocol == "tcp") {
@@ -64,9 +69,17 @@ bool Client::connect(const std::string& server_ip,
             _logger.write("ERROR\tFailed to connect to server using TCP");
             return false;
         }
+        // a new connection starts new streams
+        if (_protocol.getStreamCompression().active) {
+            _encoder = std::make_unique<lz4::StreamEncoder>(
+                _protocol.getStreamCompression().level);
+            _decoder = std::make_unique<lz4::StreamDecoder>();
+        }
     }
 
     _connected = true;
+    for (auto& reset : _deltaReceivers)
+        reset();
 
     std::cout << "Client connected to "
               << server_ip
@@ -86,55 +99,86 @@ void Client::disconnect() {
     }
     if (_socket.isValid())
         _socket.close();
+    _encoder.reset();
+    _decoder.reset();
     _connected = false;
+    for (auto& reset : _deltaReceivers)
+        reset();
     std::cout << "Client disconnected" << std::endl;
     _logger.write("Client disconnected");
 }
 
+static uint64_t steadyMilliseconds() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 bool Client::initPacketTrackers(
     std::unordered_map<uint8_t, uint32_t> packetToTrace,
     std::function<void(uint8_t)> callback) {
+    uint64_t now = steadyMilliseconds();
+    size_t count = 0;
+
+    if (_packetTimers.size() == 0)
+        _packetTimers.clear(now);
     for (auto& packet : packetToTrace) {
-        PacketTracking newEntry = {
-            .expectedTime = packet.second,
-            .lastRecvTime = std::chrono::steady_clock::now(),
-        };
-        _packetTrackers.insert({packet.first, newEntry});
-    }
+        PacketTracking& tracker = _packetTrackers[packet.first];
+        if (tracker.active)
+            continue;
+        tracker.active = true;
+        tracker.expectedTime = packet.second;
+        tracker.lastRecvTime = now;
+        // one timer per tracked code, pushed back lazily on expiry
+        _packetTimers.schedule(packet.first,
+            now + tracker.expectedTime * 2 + 1);
+    }
+    for (const PacketTracking& tracker : _packetTrackers)
+        count += tracker.active;
     _trackPacketCallback = callback;
     std::cout << "Packet trackers set for "
-              << _packetTrackers.size()
+              << count
               << " packets"
               << std::endl;
     return true;
 }
 
 bool Client::checkPacketTrackers() {
-    auto now = std::chrono::steady_clock::now();
-    for (auto& code : _packetTrackers) {
-        auto elapsed =
-            std::chrono::duration_cast<std::chrono::milliseconds>(
-                now - code.second.lastRecvTime)
-                .count();
-        if (elapsed > code.second.expectedTime * 2) {
-            _trackPacketCallback(code.first);
-            code.second.lastRecvTime = now;
+    uint64_t now = steadyMilliseconds();
+
+    _packetTimers.advance(now, [this, now](uint64_t id) {
+        uint8_t code = static_cast<uint8_t>(id);
+        PacketTracking& tracker = _packetTrackers[code];
+        uint64_t deadline = tracker.lastRecvTime + tracker.expectedTime * 2;
+
+        if (deadline >= now) {
+            _packetTimers.schedule(id, deadline + 1);
+            return;
         }
-    }
+        tracker.misses++;
+        tracker.lastRecvTime = now;
+        _packetTimers.schedule(id, now + tracker.expectedTime * 2 + 1);
+        if (_trackPacketCallback)
+            _trackPacketCallback(code);
+    });
     return true;
 }
 
 bool Client::markPacketCode(uint8_t code) {
-    auto it = _packetTrackers.find(code);
-    if (it == _packetTrackers.end()) {
-        return false;
-    }
+    PacketTracking& tracker = _packetTrackers[code];
 
-    it->second.lastRecvTime = std::chrono::steady_clock::now();
+    tracker.received++;
+    if (!tracker.active)
+        return false;
+    tracker.lastRecvTime = steadyMilliseconds();
     return true;
 }
 
-std::string dataToString(std::vector<uint8_t> buff) {
+PacketTrackerStats Client::getPacketTrackerStats(uint8_t code) const {
+    const PacketTracking& tracker = _packetTrackers[code];
+    return {tracker.received, tracker.misses};
+}
+
+static std::string dataToString(std::span<const uint8_t> buff) {
     std::string res;
 
     for (auto& byte : buff)
@@ -142,7 +186,41 @@ std::string dataToString(std::vector<uint8_t> buff) {
     return res;
 }
 
-bool Client::send(const std::vector<uint8_t>& data) {
+void Client::startCapture(const std::string& path) {
+    _capture = std::make_unique<PcapWriter>(path);
+    _captureAddress = Address();
+    _logger.write("Capturing packets to " + path);
+}
+
+void Client::stopCapture() {
+    if (!_capture)
+        return;
+    _logger.write("Capture stopped, " +
+        std::to_string(_capture->getPacketCount()) + " packets written");
+    _capture.reset();
+}
+
+void Client::capture(bool sent, std::span<const uint8_t> data) {
+    // the local port is only known once the socket sent or connected
+    if (_captureAddress.getPort() == 0) {
+        sockaddr_in local{};
+        socklen_t length = sizeof(local);
+        if (::getsockname(_socket.getSocket(),
+                reinterpret_cast<sockaddr*>(&local), &length) == 0) {
+            if (local.sin_addr.s_addr == htonl(INADDR_ANY))
+                local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            _captureAddress = Address::fromSockAddr(local);
+        }
+    }
+    if (sent)
+        _capture->write(_socket.getType(), _captureAddress, _server_address,
+            data);
+    else
+        _capture->write(_socket.getType(), _server_address, _captureAddress,
+            data);
+}
+
+bool Client::send(std::span<const uint8_t> data) {
     if (!_connected) {
         std::cerr << "Client is not connected" << std::endl;
         _logger.write("ERROR\tTried to send data before connecting the client");
@@ -160,19 +238,24 @@ bool Client::send(const std::vector<uint8_t>& data) {
         return false;
     }
 
-    std::vector<uint8_t> fullPacket = _protocol.formatPacket(data);
+    std::vector<uint8_t>& fullPacket = _output_buffer;
+    _protocol.formatPacketInto(data, fullPacket);
 
-    _logger.write(
-        "SEND\t" +
-        _server_address.getIP() +
-        ":" +
-        std::to_string(_server_address.getPort()) +
-        "\t" +
-        dataToString(fullPacket));
+    if (_logger.isActive()) {
+        _logger.write(
+            "SEND\t" +
+            _server_address.getIP() +
+            ":" +
+            std::to_string(_server_address.getPort()) +
+            "\t" +
+            dataToString(fullPacket));
+    }
 
     if (_socket.getType() == SocketType::UDP) {
         int sent = _socket.sendTo(fullPacket.data(), fullPacket.size(),
             _server_address);
+        if (_capture && sent > 0)
+            capture(true, std::span(fullPacket.data(), sent));
         if (sent < 0) {
             std::cerr << "Failed to send data" << std::endl;
             _logger.write("ERROR\tFailed to send data");
@@ -190,21 +273,33 @@ bool Client::send(const std::vector<uint8_t>& data) {
             return false;
         }
     } else {
+        std::span<const uint8_t> wire = fullPacket;
+        if (_encoder) {
+            _streamBuffer.clear();
+            _encoder->compress(fullPacket, _streamBuffer);
+            wire = _streamBuffer;
+        }
         size_t totalSent = 0;
-        while (totalSent < fullPacket.size()) {
-            int sent = _socket.send(fullPacket.data() + totalSent,
-                fullPacket.size() - totalSent);
+        while (totalSent < wire.size()) {
+            int sent = _socket.send(wire.data() + totalSent,
+                wire.size() - totalSent);
             if (sent < 0) {
                 std::cerr << "Failed to send data" << std::endl;
                 _logger.write("ERROR\tFailed to send data");
+                // part of a packet, or a block the server never decodes
+                if (_encoder || totalSent > 0)
+                    disconnect();
                 return false;
             }
             if (sent == 0) {
                 std::cerr << "Connection closed by peer during send"
                     << std::endl;
                 _logger.write("ERROR\tTCP connection closed during send");
+                disconnect();
                 return false;
             }
+            if (_capture)
+                capture(true, wire.subspan(totalSent, sent));
             totalSent += sent;
         }
     }
@@ -232,6 +327,14 @@ int Client::receive(void* buffer, size_t max_size) {
         return -1;
     }
 
+    // a compressed block can hold several packets, the next ones wait in
+    // _input_buffer
+    if (_decoder) {
+        auto packets = extractPacketsFromBuffer(1);
+        if (!packets.empty())
+            return copyPacket(packets[0], buffer, max_size);
+    }
+
     size_t tempBufferSize = max_size + _protocol.getProtocolOverhead();
     std::vector<uint8_t> tempBuffer(tempBufferSize);
     int received = 0;
@@ -269,31 +372,40 @@ int Client::receive(void* buffer, size_t max_size) {
 
     try {
         tempBuffer.resize(received);
+        if (_capture)
+            capture(false, tempBuffer);
+
+        if (_logger.isActive()) {
+            _logger.write(
+                "RECV\t" +
+                _server_address.getIP() +
+                ":" +
+                std::to_string(_server_address.getPort()) +
+                "\t" +
+                dataToString(tempBuffer));
+        }
+        if (_decoder) {
+            if (!_decoder->decompress(tempBuffer, _input_buffer)) {
+                std::cerr << "Invalid compressed stream from server"
+                    << std::endl;
+                _logger.write("ERROR\tInvalid compressed stream, "
+                    "disconnecting");
+                disconnect();
+                return -1;
+            }
+            auto packets = extractPacketsFromBuffer(1);
+            // the rest of a block cut by the transport comes with the next
+            if (packets.empty())
+                return 0;
+            return copyPacket(packets[0], buffer, max_size);
+        }
 
-        _logger.write(
-            "RECV\t" +
-            _server_address.getIP() +
-            ":" +
-            std::to_string(_server_address.getPort()) +
-            "\t" +
-            dataToString(tempBuffer));
-
-        ProtocolManager::UnformattedPacket unformatted =
-            _protocol.unformatPacket(tempBuffer);
-        size_t dataToCopy = std::min(unformatted.data.size(), max_size);
-
-        markPacketCode(unformatted.data[0]);
+        ProtocolManager::UnformattedPacketView unformatted =
+            _protocol.unformatPacketView(tempBuffer);
 
-        std::memcpy(buffer, unformatted.data.data(), dataToCopy);
-        if (unformatted.data.size() > max_size) {
-            std::cerr << "Warning: Received data truncated ("
-                      << unformatted.data.size()
-                      << " bytes received, "
-                      << max_size
-                      << " bytes buffer)"
-                      << std::endl;
-        }
-        return static_cast<int>(dataToCopy);
+        if (!unformatted.data.empty())
+            markPacketCode(unformatted.data[0]);
+        return copyPacket(unformatted.data, buffer, max_size);
     } catch (const std::exception& e) {
         std::cerr << "Failed to unformat packet: " << e.what() << std::endl;
         _logger.write("ERROR\tFailed to unformat packet : " +
@@ -302,6 +414,22 @@ int Client::receive(void* buffer, size_t max_size) {
     }
 }
 
+int Client::copyPacket(std::span<const uint8_t> data, void* buffer,
+    size_t max_size) {
+    size_t dataToCopy = std::min(data.size(), max_size);
+
+    std::memcpy(buffer, data.data(), dataToCopy);
+    if (data.size() > max_size) {
+        std::cerr << "Warning: Received data truncated ("
+                  << data.size()
+                  << " bytes received, "
+                  << max_size
+                  << " bytes buffer)"
+                  << std::endl;
+    }
+    return static_cast<int>(dataToCopy);
+}
+
 bool Client::setNonBlocking(bool enabled) {
     if (!_socket.isValid()) {
         _logger.write("ERROR\tCannot set socket.nonblocking of invalid socket");
@@ -370,14 +498,18 @@ void Client::udpReceive(int timeout, int maxInputs) {
 
         std::vector<uint8_t> packetData(tempBuffer.begin(),
                                         tempBuffer.begin() + received);
-
-        _logger.write(
-            "RECV\t" +
-            _server_address.getIP() +
-            ":" +
-            std::to_string(_server_address.getPort()) +
-            "\t" +
-            dataToString(packetData));
+        if (_capture)
+            capture(false, packetData);
+
+        if (_logger.isActive()) {
+            _logger.write(
+                "RECV\t" +
+                _server_address.getIP() +
+                ":" +
+                std::to_string(_server_address.getPort()) +
+                "\t" +
+                dataToString(packetData));
+        }
 
         _input_buffer.insert(_input_buffer.end(),
                             packetData.begin(), packetData.end());
@@ -420,46 +552,59 @@ void Client::tcpReceive(int timeout) {
     size_t bufferSize = BUFSIZ + _protocol.getProtocolOverhead();
     std::vector<uint8_t> tempBuffer(bufferSize);
 
-    while (true) {
-        int received = _socket.recv(tempBuffer.data(), bufferSize);
+    // a single recv: after a poll it can't block, and a second one couldn't
+    // tell a closed connection from an empty non-blocking socket
+    int received = _socket.recv(tempBuffer.data(), bufferSize);
 
-        if (received == 0) {
-            std::cerr << "Server closed connection" << std::endl;
-            _connected = false;
-            _logger.write("ERROR\tServer force closed connection");
-            break;
-        }
+    if (received == 0) {
+        std::cerr << "Server closed connection" << std::endl;
+        _connected = false;
+        _logger.write("ERROR\tServer force closed connection");
+        return;
+    }
 
-        if (received < 0) {
-            break;
-        }
+    if (received < 0) {
+        return;
+    }
 
-        tempBuffer.resize(received);
+    std::span<const uint8_t> data(tempBuffer.data(), received);
+    if (_capture)
+        capture(false, data);
 
+    if (_logger.isActive()) {
         _logger.write(
             "RECV\t" +
             _server_address.getIP() +
             ":" +
             std::to_string(_server_address.getPort()) +
             "\t" +
-            dataToString(tempBuffer));
+            dataToString(data));
+    }
 
-        _input_buffer.insert(_input_buffer.end(),
-                            tempBuffer.begin(),
-                            tempBuffer.begin() + received);
+    if (!_decoder) {
+        _input_buffer.insert(_input_buffer.end(), data.begin(), data.end());
+        return;
+    }
+    if (!_decoder->decompress(data, _input_buffer)) {
+        std::cerr << "Invalid compressed stream from server" << std::endl;
+        _logger.write("ERROR\tInvalid compressed stream, disconnecting");
+        disconnect();
     }
 }
 
-std::vector<std::vector<uint8_t>> Client::extractPacketsFromBuffer() {
+std::vector<std::vector<uint8_t>> Client::extractPacketsFromBuffer(
+    size_t maxPackets) {
     std::vector<std::vector<uint8_t>> result;
 
-    ProtocolManager::preambule preamble = _protocol.getPreambule();
-    ProtocolManager::datetime datetime = _protocol.getDatetime();
-    ProtocolManager::packet_length packetLength = _protocol.getPacketLength();
-    ProtocolManager::end_of_packet packetEnd = _protocol.getEndOfPacket();
+    const ProtocolManager::preambule& preamble = _protocol.getPreambule();
+    const ProtocolManager::datetime& datetime = _protocol.getDatetime();
+    const ProtocolManager::packet_length& packetLength =
+        _protocol.getPacketLength();
+    const ProtocolManager::end_of_packet& packetEnd =
+        _protocol.getEndOfPacket();
     ProtocolManager::Endianness endianness = _protocol.getEndianness();
 
-    while (!_input_buffer.empty()) {
+    while (!_input_buffer.empty() && result.size() < maxPackets) {
         size_t offset = 0;
         if (preamble.active) {
             if (_input_buffer.size() < preamble.characters.size())
@@ -516,24 +661,21 @@ std::vector<std::vector<uint8_t>> Client::extractPacketsFromBuffer() {
                 offset += datetime.length;
             }
 
-            if (_input_buffer.size() < offset + actualDataLength)
+            // same as Server: only a whole packet, end marker included
+            size_t packetSize = offset + actualDataLength +
+                (packetEnd.active ? packetEnd.characters.size() : 0);
+            if (_input_buffer.size() < packetSize)
                 break;
 
             std::vector<uint8_t> packetData(
                 _input_buffer.begin() + offset,
                 _input_buffer.begin() + offset + actualDataLength);
 
-            markPacketCode(packetData[0]);
-            result.push_back(packetData);
-            offset += actualDataLength;
-
-            if (packetEnd.active) {
-                if (_input_buffer.size() < offset + packetEnd.characters.size())
-                    break;
-                offset += packetEnd.characters.size();
-            }
+            if (!packetData.empty())
+                markPacketCode(packetData[0]);
+            result.push_back(std::move(packetData));
             _input_buffer.erase(_input_buffer.begin(),
-                               _input_buffer.begin() + offset);
+                               _input_buffer.begin() + packetSize);
 
         } else if (packetEnd.active) {
             if (datetime.active) {
@@ -541,7 +683,7 @@ std::vector<std::vector<uint8_t>> Client::extractPacketsFromBuffer() {
                     break;
                 offset += datetime.length;
             }
-            std::string endMarker = packetEnd.characters;
+            const std::string& endMarker = packetEnd.characters;
             auto it = std::search(
                 _input_buffer.begin() + offset,
                 _input_buffer.end(),
@@ -559,7 +701,7 @@ std::vector<std::vector<uint8_t>> Client::extractPacketsFromBuffer() {
                 _input_buffer.begin() + dataStart,
                 _input_buffer.begin() + dataEnd);
 
-            result.push_back(packetData);
+            result.push_back(std::move(packetData));
 
             _input_buffer.erase(_input_buffer.begin(),
                                _input_buffer.begin()
@@ -574,4 +716,8 @@ std::vector<std::vector<uint8_t>> Client::extractPacketsFromBuffer() {
     return result;
 }
 
+std::vector<uint8_t>& Client::getInputBufferRef() {
+    return _input_buffer;
+}
+
 }  // namespace net
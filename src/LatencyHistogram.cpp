@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "Network/LatencyHistogram.hpp"
+
+namespace net {
+
+LatencyHistogram::LatencyHistogram()
+    : _counts(BUCKETS, 0) {}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKETS; ++i)
+        _counts[i] += other._counts[i];
+    _count += other._count;
+    _sum += other._sum;
+    _min = std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+}
+
+void LatencyHistogram::reset() {
+    std::fill(_counts.begin(), _counts.end(), 0);
+    _count = 0;
+    _sum = 0;
+    _min = ~0ULL;
+    _max = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const {
+    if (_count == 0)
+        return 0;
+
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    uint64_t rank = static_cast<uint64_t>(
+        std::ceil(percentile / 100.0 * static_cast<double>(_count)));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += _counts[i];
+        if (seen >= rank)
+            return std::min(highestValueOf(i), _max);
+    }
+    return _max;
+}
+
+double LatencyHistogram::mean() const {
+    if (_count == 0)
+        return 0;
+    return static_cast<double>(_sum) / static_cast<double>(_count);
+}
+
+uint64_t LatencyHistogram::highestValueOf(size_t bucket) {
+    if (bucket < 2 * SUB_BUCKETS)
+        return bucket;
+    unsigned shift = static_cast<unsigned>(bucket / SUB_BUCKETS) - 1;
+    uint64_t lowest = (bucket % SUB_BUCKETS + SUB_BUCKETS) << shift;
+    return lowest + ((1ULL << shift) - 1);
+}
+
+}  // namespace net
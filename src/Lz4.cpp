@@ -0,0 +1,247 @@
+#include <lz4.h>
+#include <lz4hc.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Network/Lz4.hpp"
+#include "Network/Varint.hpp"
+
+namespace net::lz4 {
+
+namespace {
+
+struct FreeStream {
+    void operator()(LZ4_stream_t* stream) const { LZ4_freeStream(stream); }
+    void operator()(LZ4_streamHC_t* stream) const {
+        LZ4_freeStreamHC(stream);
+    }
+};
+
+using Stream = std::unique_ptr<LZ4_stream_t, FreeStream>;
+using StreamHC = std::unique_ptr<LZ4_streamHC_t, FreeStream>;
+
+// LZ4_loadDictHC clears the whole context (256 KB) first, a dictionary up to
+// this size is cheaper to compress right before the block
+constexpr size_t HC_PREFIX_SIZE = 2048;
+
+// A context reset with LZ4_resetStream_fast keeps stale entries, which
+// changes the matches found: with a dictionary, the working context is a
+// copy of one where only the dictionary was loaded.
+struct Contexts {
+    Stream fast{LZ4_createStream()};
+    StreamHC high;
+    // dictionary then block, and the discarded compressed dictionary
+    std::vector<char> joined;
+    std::vector<char> skipped;
+    std::vector<std::pair<std::span<const uint8_t>, Stream>> dictionaries;
+
+    const LZ4_stream_t* prepared(std::span<const uint8_t> dictionary) {
+        for (auto& [bytes, stream] : dictionaries) {
+            if (bytes.data() == dictionary.data() &&
+                bytes.size() == dictionary.size())
+                return stream.get();
+        }
+        Stream stream(LZ4_createStream());
+        LZ4_loadDict(stream.get(),
+            reinterpret_cast<const char*>(dictionary.data()),
+            static_cast<int>(dictionary.size()));
+        dictionaries.emplace_back(dictionary, std::move(stream));
+        return dictionaries.back().second.get();
+    }
+};
+
+Contexts& contexts() {
+    thread_local Contexts local;
+
+    return local;
+}
+
+// a stream block can copy from this far back
+constexpr size_t WINDOW_SIZE = 64 * 1024;
+constexpr int STREAM_BLOCK_BOUND = LZ4_COMPRESSBOUND(STREAM_BLOCK_SIZE);
+
+int capacity(std::span<uint8_t> out) {
+    return static_cast<int>(std::min<size_t>(out.size(), MAX_BLOCK_SIZE));
+}
+
+}  // namespace
+
+size_t compress(std::span<const uint8_t> in, std::span<uint8_t> out,
+    std::span<const uint8_t> dictionary, int level) {
+    Contexts& local = contexts();
+    const char* src = reinterpret_cast<const char*>(in.data());
+    char* dst = reinterpret_cast<char*>(out.data());
+    int size = static_cast<int>(in.size());
+    int written = 0;
+
+    if (in.size() > MAX_BLOCK_SIZE)
+        return 0;
+    if (dictionary.size() > MAX_DICTIONARY_SIZE)
+        dictionary = dictionary.last(MAX_DICTIONARY_SIZE);
+
+    if (level > 0) {
+        if (!local.high)
+            local.high.reset(LZ4_createStreamHC());
+        // HC starts every stream past the indexes of the previous one
+        LZ4_resetStreamHC_fast(local.high.get(), level);
+        if (!dictionary.empty() && dictionary.size() <= HC_PREFIX_SIZE) {
+            local.joined.assign(dictionary.begin(), dictionary.end());
+            local.joined.insert(local.joined.end(), src, src + size);
+            local.skipped.resize(LZ4_COMPRESSBOUND(HC_PREFIX_SIZE));
+            LZ4_compress_HC_continue(local.high.get(), local.joined.data(),
+                local.skipped.data(), static_cast<int>(dictionary.size()),
+                static_cast<int>(local.skipped.size()));
+            src = local.joined.data() + dictionary.size();
+        } else if (!dictionary.empty()) {
+            LZ4_loadDictHC(local.high.get(),
+                reinterpret_cast<const char*>(dictionary.data()),
+                static_cast<int>(dictionary.size()));
+        }
+        written = LZ4_compress_HC_continue(local.high.get(), src, dst, size,
+            capacity(out));
+    } else if (!dictionary.empty()) {
+        std::memcpy(local.fast.get(), local.prepared(dictionary),
+            sizeof(LZ4_stream_t));
+        written = LZ4_compress_fast_continue(local.fast.get(), src, dst, size,
+            capacity(out), 1);
+    } else {
+        written = LZ4_compress_fast_extState(local.fast.get(), src, dst, size,
+            capacity(out), 1);
+    }
+    return written > 0 ? static_cast<size_t>(written) : 0;
+}
+
+bool decompress(std::span<const uint8_t> in, std::span<uint8_t> out,
+    std::span<const uint8_t> dictionary) {
+    if (in.size() > MAX_BLOCK_SIZE || out.size() > MAX_BLOCK_SIZE)
+        return false;
+    if (dictionary.size() > MAX_DICTIONARY_SIZE)
+        dictionary = dictionary.last(MAX_DICTIONARY_SIZE);
+
+    int size = LZ4_decompress_safe_usingDict(
+        reinterpret_cast<const char*>(in.data()),
+        reinterpret_cast<char*>(out.data()),
+        static_cast<int>(in.size()), static_cast<int>(out.size()),
+        reinterpret_cast<const char*>(dictionary.data()),
+        static_cast<int>(dictionary.size()));
+    return size >= 0 && static_cast<size_t>(size) == out.size();
+}
+
+// Blocks are compressed from a ring buffer holding the window: LZ4 copies
+// from the previous blocks where they were compressed.
+struct StreamEncoder::State {
+    Stream fast;
+    StreamHC high;
+    std::vector<char> ring = std::vector<char>(WINDOW_SIZE + STREAM_BLOCK_SIZE);
+    size_t offset = 0;
+    std::vector<char> block = std::vector<char>(STREAM_BLOCK_BOUND);
+};
+
+StreamEncoder::StreamEncoder(int level) : _state(std::make_unique<State>()) {
+    if (level > 0) {
+        _state->high.reset(LZ4_createStreamHC());
+        LZ4_resetStreamHC_fast(_state->high.get(), level);
+    } else {
+        _state->fast.reset(LZ4_createStream());
+    }
+}
+
+StreamEncoder::~StreamEncoder() = default;
+
+void StreamEncoder::compress(std::span<const uint8_t> data,
+    std::vector<uint8_t>& out) {
+    State& state = *_state;
+
+    while (!data.empty()) {
+        size_t size = std::min(data.size(), STREAM_BLOCK_SIZE);
+        char* in = state.ring.data() + state.offset;
+        int written = 0;
+
+        std::memcpy(in, data.data(), size);
+        if (state.high) {
+            written = LZ4_compress_HC_continue(state.high.get(), in,
+                state.block.data(), static_cast<int>(size),
+                STREAM_BLOCK_BOUND);
+        } else {
+            written = LZ4_compress_fast_continue(state.fast.get(), in,
+                state.block.data(), static_cast<int>(size),
+                STREAM_BLOCK_BOUND, 1);
+        }
+
+        uint8_t header[varint::MAX_SIZE];
+        size_t headerSize = varint::write(header, written);
+        out.insert(out.end(), header, header + headerSize);
+        out.insert(out.end(), state.block.data(), state.block.data() + written);
+
+        state.offset += size;
+        if (state.offset + STREAM_BLOCK_SIZE > state.ring.size())
+            state.offset = 0;
+        data = data.subspan(size);
+    }
+}
+
+// Blocks are decompressed in a ring buffer, the next ones copy from there.
+// It starts over once a whole block may not fit at its end.
+struct StreamDecoder::State {
+    LZ4_streamDecode_t stream{};
+    std::vector<char> ring = std::vector<char>(
+        LZ4_DECODER_RING_BUFFER_SIZE(STREAM_BLOCK_SIZE));
+    size_t offset = 0;
+    std::vector<uint8_t> pending;
+    bool failed = false;
+};
+
+StreamDecoder::StreamDecoder() : _state(std::make_unique<State>()) {
+    LZ4_setStreamDecode(&_state->stream, nullptr, 0);
+}
+
+StreamDecoder::~StreamDecoder() = default;
+
+bool StreamDecoder::decompress(std::span<const uint8_t> data,
+    std::vector<uint8_t>& out) {
+    State& state = *_state;
+    size_t read = 0;
+
+    if (state.failed)
+        return false;
+    state.pending.insert(state.pending.end(), data.begin(), data.end());
+    while (read < state.pending.size()) {
+        uint64_t size = 0;
+        size_t headerSize = varint::read(state.pending, read, size);
+
+        // the size of a block takes 3 bytes at most
+        if (headerSize == 0 && state.pending.size() - read < 3)
+            break;
+        if (headerSize == 0 || size == 0 || size > STREAM_BLOCK_BOUND) {
+            state.failed = true;
+            return false;
+        }
+        if (state.pending.size() - read - headerSize < size)
+            break;
+
+        char* decoded = state.ring.data() + state.offset;
+        int decodedSize = LZ4_decompress_safe_continue(&state.stream,
+            reinterpret_cast<const char*>(state.pending.data()) + read +
+                headerSize,
+            decoded, static_cast<int>(size), STREAM_BLOCK_SIZE);
+        if (decodedSize <= 0) {
+            state.failed = true;
+            return false;
+        }
+        out.insert(out.end(), decoded, decoded + decodedSize);
+        state.offset += decodedSize;
+        if (state.offset + STREAM_BLOCK_SIZE > state.ring.size())
+            state.offset = 0;
+        read += headerSize + size;
+    }
+    state.pending.erase(state.pending.begin(), state.pending.begin() + read);
+    return true;
+}
+
+size_t StreamDecoder::pending() const {
+    return _state->pending.size();
+}
+
+}  // namespace net::lz4
@@ -0,0 +1,39 @@
+#include <string>
+#include <variant>
+
+#include "Network/Metrics.hpp"
+
+namespace net {
+
+MetricsRegistry::Type MetricsRegistry::Metric::type() const {
+    if (std::holds_alternative<const Counter*>(metric))
+        return Type::COUNTER;
+    return Type::GAUGE;
+}
+
+double MetricsRegistry::Metric::value() const {
+    return std::visit([](auto* m) {
+        return static_cast<double>(m->value());
+    }, metric);
+}
+
+void MetricsRegistry::add(const std::string& name, const std::string& help,
+    const Counter& counter) {
+    _metrics.push_back({name, help, &counter});
+}
+
+void MetricsRegistry::add(const std::string& name, const std::string& help,
+    const Gauge& gauge) {
+    _metrics.push_back({name, help, &gauge});
+}
+
+const MetricsRegistry::Metric* MetricsRegistry::find(
+    const std::string& name) const {
+    for (const Metric& metric : _metrics) {
+        if (metric.name == name)
+            return &metric;
+    }
+    return nullptr;
+}
+
+}  // namespace net
@@ -0,0 +1,259 @@
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "Network/MetricsExporter.hpp"
+#include "Network/NetworkSocket.hpp"
+
+namespace net {
+
+#ifdef MSG_NOSIGNAL
+static constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static constexpr int SEND_FLAGS = 0;
+#endif
+
+static void appendNumber(double value, std::string& out) {
+    char buffer[32];
+    auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, end);
+}
+
+static void appendHeader(const std::string& name, const std::string& type,
+    const std::string& help, std::string& out) {
+    out += "# TYPE " + name + " " + type + "\n";
+    out += "# HELP " + name + " " + help + "\n";
+}
+
+static void appendLabelValue(const std::string& value, std::string& out) {
+    for (char c : value) {
+        if (c == '\\' || c == '"')
+            out += '\\';
+        if (c == '\n') {
+            out += "\\n";
+            continue;
+        }
+        out += c;
+    }
+}
+
+void MetricsExporter::renderRegistry(const MetricsRegistry& registry,
+    std::string& out) {
+    static const std::string suffix = "_total";
+
+    for (const MetricsRegistry::Metric& metric : registry.metrics()) {
+        if (metric.type() == MetricsRegistry::Type::COUNTER) {
+            std::string family = metric.name;
+            if (family.ends_with(suffix))
+                family.resize(family.size() - suffix.size());
+            appendHeader(family, "counter", metric.help, out);
+            out += family + suffix + " ";
+        } else {
+            appendHeader(metric.name, "gauge", metric.help, out);
+            out += metric.name + " ";
+        }
+        appendNumber(metric.value(), out);
+        out += '\n';
+    }
+}
+
+void MetricsExporter::renderLabelledGauge(const std::string& name,
+    const std::string& help, const std::string& label,
+    const std::vector<std::pair<std::string, double>>& samples,
+    std::string& out) {
+    appendHeader(name, "gauge", help, out);
+    for (auto& [labelValue, value] : samples) {
+        out += name + "{" + label + "=\"";
+        appendLabelValue(labelValue, out);
+        out += "\"} ";
+        appendNumber(value, out);
+        out += '\n';
+    }
+}
+
+void MetricsExporter::renderSummary(const std::string& name,
+    const std::string& help, const LatencyHistogram& histogram,
+    double scale, std::string& out) {
+    static const std::pair<const char*, double> quantiles[] = {
+        {"0.5", 50}, {"0.9", 90}, {"0.99", 99}, {"0.999", 99.9},
+    };
+
+    appendHeader(name, "summary", help, out);
+    for (auto& [label, percentile] : quantiles) {
+        out += name + "{quantile=\"" + label + "\"} ";
+        appendNumber(histogram.percentile(percentile) * scale, out);
+        out += '\n';
+    }
+    out += name + "_sum ";
+    appendNumber(histogram.mean() * histogram.count() * scale, out);
+    out += '\n' + name + "_count ";
+    appendNumber(static_cast<double>(histogram.count()), out);
+    out += '\n';
+}
+
+void MetricsExporter::renderEnd(std::string& out) {
+    out += "# EOF\n";
+}
+
+bool MetricsExporter::writeFile(const std::string& path,
+    const std::string& text) {
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+        file.write(text.data(), static_cast<std::streamsize>(text.size()));
+        if (!file.flush())
+            return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tmp, path, error);
+    if (error) {
+        std::filesystem::remove(tmp, error);
+        return false;
+    }
+    return true;
+}
+
+MetricsEndpoint::MetricsEndpoint(uint16_t port)
+    : _port(port) {
+    EnsureWinsockInitialized();
+    _listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (_listener == INVALID_SOCKET_VALUE)
+        throw NetworkSocket::SocketCreationError();
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+
+    SetSocketReuseAddr(_listener, true);
+    if (::bind(_listener, reinterpret_cast<sockaddr*>(&address),
+            sizeof(address)) == SOCKET_ERROR_VALUE ||
+        ::listen(_listener, METRICS_MAX_SCRAPERS) == SOCKET_ERROR_VALUE ||
+        !SetSocketNonBlocking(_listener, true) ||
+        ::getsockname(_listener, reinterpret_cast<sockaddr*>(&address),
+            &length) == SOCKET_ERROR_VALUE) {
+        CLOSE_SOCKET(_listener);
+        throw NetworkSocket::BindFailed();
+    }
+    _port = ntohs(address.sin_port);
+}
+
+MetricsEndpoint::~MetricsEndpoint() {
+    for (Scraper& scraper : _scrapers)
+        CLOSE_SOCKET(scraper.socket);
+    CLOSE_SOCKET(_listener);
+}
+
+size_t MetricsEndpoint::serve(
+    const std::function<void(std::string&)>& render) {
+    _fds.clear();
+    _fds.push_back({static_cast<POLL_FD_TYPE>(_listener), POLL_IN, 0});
+    for (Scraper& scraper : _scrapers) {
+        short events = scraper.response.empty() ? POLL_IN : POLL_OUT;
+        _fds.push_back({static_cast<POLL_FD_TYPE>(scraper.socket), events, 0});
+    }
+
+#ifdef _WIN32
+    int ready = PollSockets(_fds.data(), static_cast<ULONG>(_fds.size()), 0);
+#else
+    int ready = PollSockets(_fds.data(), _fds.size(), 0);
+#endif
+    // nothing ready still expires the scrapers that never asked anything
+    if (ready < 0)
+        return 0;
+
+    size_t answered = 0;
+    size_t kept = 0;
+    auto now = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < _scrapers.size(); ++i) {
+        Scraper& scraper = _scrapers[i];
+        bool done = now - scraper.accepted > METRICS_SCRAPE_TIMEOUT;
+
+        if (!done && ready > 0 && (_fds[i + 1].revents &
+            (POLL_IN | POLL_OUT | POLL_ERR | POLL_HUP))) {
+            done = scraper.response.empty() ? respond(scraper, render)
+                : sendResponse(scraper);
+            answered += done && !scraper.response.empty() &&
+                scraper.sent == scraper.response.size();
+        }
+        if (done)
+            CLOSE_SOCKET(scraper.socket);
+        else if (kept++ != i)
+            _scrapers[kept - 1] = std::move(scraper);
+    }
+    _scrapers.erase(_scrapers.begin() + kept, _scrapers.end());
+
+    if (ready > 0 && (_fds[0].revents & POLL_IN))
+        accept();
+    return answered;
+}
+
+void MetricsEndpoint::accept() {
+    while (_scrapers.size() < METRICS_MAX_SCRAPERS) {
+        SocketHandle socket = ::accept(_listener, nullptr, nullptr);
+        if (socket == INVALID_SOCKET_VALUE)
+            return;
+        if (!SetSocketNonBlocking(socket, true)) {
+            CLOSE_SOCKET(socket);
+            continue;
+        }
+        _scrapers.push_back({socket, std::chrono::steady_clock::now(),
+            "", "", 0});
+    }
+}
+
+// true once the scraper is done with, answered if its whole response went
+bool MetricsEndpoint::respond(Scraper& scraper,
+    const std::function<void(std::string&)>& render) {
+    char buffer[1024];
+    int received = ::recv(scraper.socket, buffer, sizeof(buffer), 0);
+
+    if (received <= 0)
+        return received == 0 || !IsBlockingError(GetLastSocketError());
+    scraper.request.append(buffer, received);
+    if (scraper.request.find("\r\n\r\n") == std::string::npos)
+        return scraper.request.size() >= METRICS_MAX_REQUEST;
+
+    bool found = scraper.request.starts_with("GET /metrics ") ||
+        scraper.request.starts_with("GET / ");
+    _body.clear();
+    if (found)
+        render(_body);
+    else
+        _body = "Not found\n";
+
+    scraper.response = found ? "HTTP/1.1 200 OK\r\nContent-Type: "
+        OPENMETRICS_CONTENT_TYPE "\r\n"
+        : "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\n";
+    scraper.response += "Content-Length: " + std::to_string(_body.size()) +
+        "\r\nConnection: close\r\n\r\n" + _body;
+    return sendResponse(scraper);
+}
+
+// sends what the socket takes now, the rest waits for it to poll writable
+bool MetricsEndpoint::sendResponse(Scraper& scraper) {
+    while (scraper.sent < scraper.response.size()) {
+        int result = ::send(scraper.socket,
+            scraper.response.data() + scraper.sent,
+            static_cast<int>(scraper.response.size() - scraper.sent),
+            SEND_FLAGS);
+        if (result > 0)
+            scraper.sent += result;
+        else
+            return result == 0 || !IsBlockingError(GetLastSocketError());
+    }
+    return true;
+}
+
+}  // namespace net
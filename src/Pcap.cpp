@@ -0,0 +1,426 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Network/Pcap.hpp"
+
+namespace net {
+
+#define PCAPNG_SECTION_HEADER 0x0A0D0D0A
+#define PCAPNG_INTERFACE 1
+#define PCAPNG_SIMPLE_PACKET 3
+#define PCAPNG_ENHANCED_PACKET 6
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+#define PCAPNG_OPTION_TSRESOL 9
+
+#define LINKTYPE_NULL 0
+#define LINKTYPE_ETHERNET 1
+#define LINKTYPE_RAW 101
+#define LINKTYPE_LINUX_SLL 113
+#define LINKTYPE_IPV4 228
+#define LINKTYPE_LINUX_SLL2 276
+
+#define IPV4_HEADER 20
+#define UDP_HEADER 8
+#define TCP_HEADER 20
+#define IPV4_MAX_PACKET 65535
+
+static void put16le(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+static void put32le(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i)
+        out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+}
+
+static void put16be(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static void put32be(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 3; i >= 0; --i)
+        out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+}
+
+static void putIp(std::vector<uint8_t>& out, const Address& address) {
+    // already in network order
+    uint32_t ip = address.getIPAsInt();
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&ip);
+    out.insert(out.end(), bytes, bytes + 4);
+}
+
+static uint16_t ipChecksum(const uint8_t* header) {
+    uint32_t sum = 0;
+
+    for (int i = 0; i < IPV4_HEADER; i += 2)
+        sum += (header[i] << 8) | header[i + 1];
+    while (sum >> 16)
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    return static_cast<uint16_t>(~sum);
+}
+
+static uint16_t read16be(const uint8_t* data) {
+    return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+static uint32_t read32be(const uint8_t* data) {
+    return (static_cast<uint32_t>(data[0]) << 24) |
+        (static_cast<uint32_t>(data[1]) << 16) |
+        (static_cast<uint32_t>(data[2]) << 8) | data[3];
+}
+
+PcapWriter::PcapWriter(const std::string& path)
+    : _file(path, std::ios::binary | std::ios::trunc) {
+    if (!_file)
+        throw OpenFailed();
+
+    // section header: no option, unknown section length
+    _block.clear();
+    put32le(_block, PCAPNG_SECTION_HEADER);
+    put32le(_block, 28);
+    put32le(_block, PCAPNG_BYTE_ORDER_MAGIC);
+    put16le(_block, 1);
+    put16le(_block, 0);
+    put32le(_block, 0xFFFFFFFF);
+    put32le(_block, 0xFFFFFFFF);
+    put32le(_block, 28);
+
+    // interface: raw IP, nanosecond timestamps
+    put32le(_block, PCAPNG_INTERFACE);
+    put32le(_block, 32);
+    put16le(_block, LINKTYPE_RAW);
+    put16le(_block, 0);
+    put32le(_block, 0);
+    put16le(_block, PCAPNG_OPTION_TSRESOL);
+    put16le(_block, 1);
+    put32le(_block, 9);
+    put32le(_block, 0);
+    put32le(_block, 32);
+
+    _file.write(reinterpret_cast<const char*>(_block.data()), _block.size());
+    if (!_file)
+        throw OpenFailed();
+}
+
+void PcapWriter::write(SocketType type, const Address& source,
+    const Address& destination, std::span<const uint8_t> data,
+    uint64_t timestamp) {
+    size_t transport = type == SocketType::UDP ? UDP_HEADER : TCP_HEADER;
+    size_t maxPayload = IPV4_MAX_PACKET - IPV4_HEADER - transport;
+
+    if (timestamp == 0) {
+        timestamp = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+    do {
+        size_t size = std::min(data.size(), maxPayload);
+        writeRecord(type, source, destination, data.first(size), timestamp);
+        data = data.subspan(size);
+    } while (!data.empty());
+}
+
+void PcapWriter::writeRecord(SocketType type, const Address& source,
+    const Address& destination, std::span<const uint8_t> data,
+    uint64_t timestamp) {
+    size_t transport = type == SocketType::UDP ? UDP_HEADER : TCP_HEADER;
+    size_t length = IPV4_HEADER + transport + data.size();
+    size_t padding = (4 - length % 4) % 4;
+    uint32_t blockLength = static_cast<uint32_t>(32 + length + padding);
+
+    _block.clear();
+    put32le(_block, PCAPNG_ENHANCED_PACKET);
+    put32le(_block, blockLength);
+    put32le(_block, 0);
+    put32le(_block, static_cast<uint32_t>(timestamp >> 32));
+    put32le(_block, static_cast<uint32_t>(timestamp));
+    put32le(_block, static_cast<uint32_t>(length));
+    put32le(_block, static_cast<uint32_t>(length));
+
+    size_t ip = _block.size();
+    _block.push_back(0x45);
+    _block.push_back(0);
+    put16be(_block, static_cast<uint16_t>(length));
+    put16be(_block, _ipId++);
+    put16be(_block, 0x4000);  // don't fragment
+    _block.push_back(64);
+    _block.push_back(type == SocketType::UDP ? 17 : 6);
+    put16be(_block, 0);
+    putIp(_block, source);
+    putIp(_block, destination);
+    uint16_t checksum = ipChecksum(_block.data() + ip);
+    _block[ip + 10] = static_cast<uint8_t>(checksum >> 8);
+    _block[ip + 11] = static_cast<uint8_t>(checksum);
+
+    put16be(_block, source.getPort());
+    put16be(_block, destination.getPort());
+    if (type == SocketType::UDP) {
+        put16be(_block, static_cast<uint16_t>(UDP_HEADER + data.size()));
+        put16be(_block, 0);  // no checksum, allowed over IPv4
+    } else {
+        uint32_t& sequence =
+            _sequences[{source.toKey(), destination.toKey()}];
+        put32be(_block, sequence);
+        put32be(_block, 0);
+        _block.push_back(TCP_HEADER / 4 << 4);
+        _block.push_back(0x18);  // PSH ACK
+        put16be(_block, 0xFFFF);
+        put16be(_block, 0);
+        put16be(_block, 0);
+        sequence += static_cast<uint32_t>(data.size());
+    }
+
+    _block.insert(_block.end(), data.begin(), data.end());
+    _block.insert(_block.end(), padding, 0);
+    put32le(_block, blockLength);
+    _file.write(reinterpret_cast<const char*>(_block.data()), _block.size());
+    _packets++;
+}
+
+PcapReader::PcapReader(const std::string& path)
+    : _file(path, std::ios::binary) {
+    uint8_t magic[4];
+
+    if (!_file)
+        throw BadCapture("Cannot open capture file: " + path);
+    read(magic, sizeof(magic));
+
+    uint32_t little = magic[0] | (magic[1] << 8) | (magic[2] << 16) |
+        (static_cast<uint32_t>(magic[3]) << 24);
+    if (little == PCAPNG_SECTION_HEADER) {
+        // the first section header is read like any other block
+        _pcapng = true;
+        _file.seekg(0);
+        return;
+    }
+
+    uint8_t header[20];
+    read(header, sizeof(header));
+    if (little == 0xA1B2C3D4 || little == 0xA1B23C4D) {
+        _bigEndian = false;
+    } else if (little == 0xD4C3B2A1 || little == 0x4D3CB2A1) {
+        _bigEndian = true;
+    } else {
+        throw BadCapture("Not a pcap or pcapng file: " + path);
+    }
+    _unitsPerSecond = (little == 0xA1B23C4D || little == 0x4D3CB2A1)
+        ? 1000000000 : 1000000;
+    _linkType = static_cast<uint16_t>(get32(header + 16));
+}
+
+bool PcapReader::next(Packet& packet) {
+    bool decoded = false;
+
+    while (!decoded) {
+        bool more = _pcapng ? nextPcapng(packet, decoded)
+            : nextPcap(packet, decoded);
+        if (!more)
+            return false;
+    }
+    return true;
+}
+
+bool PcapReader::read(void* buffer, size_t size, bool eofAllowed) {
+    _file.read(static_cast<char*>(buffer), static_cast<std::streamsize>(size));
+    if (_file.gcount() == static_cast<std::streamsize>(size))
+        return true;
+    if (eofAllowed && _file.gcount() == 0)
+        return false;
+    throw BadCapture("Truncated capture file");
+}
+
+uint16_t PcapReader::get16(const uint8_t* data) const {
+    if (_bigEndian)
+        return read16be(data);
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+uint32_t PcapReader::get32(const uint8_t* data) const {
+    if (_bigEndian)
+        return read32be(data);
+    return data[0] | (data[1] << 8) | (data[2] << 16) |
+        (static_cast<uint32_t>(data[3]) << 24);
+}
+
+static uint64_t toNanoseconds(uint64_t time, uint64_t unitsPerSecond) {
+    if (unitsPerSecond == 1000000000)
+        return time;
+    return time / unitsPerSecond * 1000000000 +
+        time % unitsPerSecond * 1000000000 / unitsPerSecond;
+}
+
+bool PcapReader::nextPcap(Packet& packet, bool& decoded) {
+    uint8_t header[16];
+
+    if (!read(header, sizeof(header), true))
+        return false;
+    uint64_t seconds = get32(header);
+    uint64_t fraction = get32(header + 4);
+    uint32_t captured = get32(header + 8);
+    uint32_t original = get32(header + 12);
+
+    if (captured > 256 * 1024)
+        throw BadCapture("Capture record too big");
+    _block.resize(captured);
+    read(_block.data(), captured);
+    packet.timestamp = seconds * 1000000000 +
+        toNanoseconds(fraction, _unitsPerSecond);
+    decoded = captured == original && decode(_linkType, _block, packet);
+    return true;
+}
+
+bool PcapReader::nextPcapng(Packet& packet, bool& decoded) {
+    uint8_t header[8];
+
+    if (!read(header, sizeof(header), true))
+        return false;
+    if (read32be(header) == PCAPNG_SECTION_HEADER ||
+        get32(header) == PCAPNG_SECTION_HEADER) {
+        // the byte order may change with each section
+        uint8_t magic[4];
+        read(magic, sizeof(magic));
+        _bigEndian = read32be(magic) == PCAPNG_BYTE_ORDER_MAGIC;
+        if (!_bigEndian && get32(magic) != PCAPNG_BYTE_ORDER_MAGIC)
+            throw BadCapture("Invalid pcapng byte order magic");
+        uint32_t length = get32(header + 4);
+        if (length < 28 || length % 4 != 0)
+            throw BadCapture("Invalid pcapng section header");
+        _block.resize(length - 12);
+        read(_block.data(), _block.size());
+        _interfaces.clear();
+        return true;
+    }
+
+    uint32_t type = get32(header);
+    uint32_t length = get32(header + 4);
+    if (length < 12 || length % 4 != 0 || length > 256 * 1024)
+        throw BadCapture("Invalid pcapng block length");
+    _block.resize(length - 8);
+    read(_block.data(), _block.size());
+    _block.resize(length - 12);
+
+    if (type == PCAPNG_INTERFACE) {
+        readInterface(_block);
+    } else if (type == PCAPNG_ENHANCED_PACKET && _block.size() >= 20) {
+        uint32_t interface = get32(_block.data());
+        uint64_t time = (static_cast<uint64_t>(get32(_block.data() + 4)) << 32)
+            | get32(_block.data() + 8);
+        uint32_t captured = get32(_block.data() + 12);
+        uint32_t original = get32(_block.data() + 16);
+
+        if (interface >= _interfaces.size() || captured > _block.size() - 20)
+            throw BadCapture("Invalid pcapng packet block");
+        packet.timestamp = toNanoseconds(time,
+            _interfaces[interface].unitsPerSecond);
+        decoded = captured == original && decode(
+            _interfaces[interface].linkType,
+            std::span<const uint8_t>(_block.data() + 20, captured), packet);
+    }
+    return true;
+}
+
+void PcapReader::readInterface(const std::vector<uint8_t>& body) {
+    if (body.size() < 8)
+        throw BadCapture("Invalid pcapng interface block");
+
+    Interface interface{get16(body.data()), 1000000};
+    size_t offset = 8;
+    while (offset + 4 <= body.size()) {
+        uint16_t code = get16(body.data() + offset);
+        uint16_t length = get16(body.data() + offset + 2);
+        offset += 4;
+        if (code == 0 || offset + length > body.size())
+            break;
+        if (code == PCAPNG_OPTION_TSRESOL && length >= 1) {
+            uint8_t resolution = body[offset];
+            uint64_t units = 1;
+            for (int i = 0; i < (resolution & 0x7F) && units < (1ULL << 60);
+                ++i)
+                units *= (resolution & 0x80) ? 2 : 10;
+            interface.unitsPerSecond = units;
+        }
+        offset += (length + 3) / 4 * 4;
+    }
+    _interfaces.push_back(interface);
+}
+
+bool PcapReader::decode(uint16_t linkType, std::span<const uint8_t> frame,
+    Packet& packet) const {
+    size_t offset = 0;
+
+    if (linkType == LINKTYPE_ETHERNET) {
+        offset = 14;
+        if (frame.size() >= 18 && read16be(frame.data() + 12) == 0x8100)
+            offset = 18;
+        if (frame.size() < offset ||
+            read16be(frame.data() + offset - 2) != 0x0800)
+            return false;
+    } else if (linkType == LINKTYPE_LINUX_SLL) {
+        offset = 16;
+        if (frame.size() < offset || read16be(frame.data() + 14) != 0x0800)
+            return false;
+    } else if (linkType == LINKTYPE_LINUX_SLL2) {
+        offset = 20;
+        if (frame.size() < offset || read16be(frame.data()) != 0x0800)
+            return false;
+    } else if (linkType == LINKTYPE_NULL) {
+        // address family in the byte order of the capturing host
+        offset = 4;
+        if (frame.size() < offset || (frame[0] != 2 && frame[3] != 2))
+            return false;
+    } else if (linkType != LINKTYPE_RAW && linkType != LINKTYPE_IPV4) {
+        return false;
+    }
+
+    std::span<const uint8_t> ip = frame.subspan(std::min(offset,
+        frame.size()));
+    if (ip.size() < IPV4_HEADER || (ip[0] >> 4) != 4)
+        return false;
+    size_t headerLength = (ip[0] & 0x0F) * 4;
+    size_t totalLength = read16be(ip.data() + 2);
+    // fragments can't be replayed alone
+    if ((read16be(ip.data() + 6) & 0x3FFF) != 0 ||
+        headerLength < IPV4_HEADER || totalLength < headerLength ||
+        totalLength > ip.size())
+        return false;
+
+    std::span<const uint8_t> segment =
+        ip.subspan(headerLength, totalLength - headerLength);
+    size_t payload = 0;
+    if (ip[9] == 17 && segment.size() >= UDP_HEADER) {
+        packet.type = SocketType::UDP;
+        size_t udpLength = read16be(segment.data() + 4);
+        if (udpLength < UDP_HEADER || udpLength > segment.size())
+            return false;
+        payload = UDP_HEADER;
+        segment = segment.first(udpLength);
+    } else if (ip[9] == 6 && segment.size() >= TCP_HEADER) {
+        packet.type = SocketType::TCP;
+        payload = (segment[12] >> 4) * 4;
+        if (payload < TCP_HEADER || payload > segment.size())
+            return false;
+    } else {
+        return false;
+    }
+    if (segment.size() == payload)
+        return false;
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    std::memcpy(&address.sin_addr.s_addr, ip.data() + 12, 4);
+    address.sin_port = htons(read16be(segment.data()));
+    packet.source = Address::fromSockAddr(address);
+    std::memcpy(&address.sin_addr.s_addr, ip.data() + 16, 4);
+    address.sin_port = htons(read16be(segment.data() + 2));
+    packet.destination = Address::fromSockAddr(address);
+    packet.data.assign(segment.begin() + payload, segment.end());
+    return true;
+}
+
+}  // namespace net
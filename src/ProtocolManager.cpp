@@ -1,4 +1,5 @@
 #include <json/json.h>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <memory>
@@ -66,6 +67,22 @@ ProtocolManager::ProtocolManager(const std::string &path) {
         _end_of_packet.active = false;
     }
 
+    if (protocol.isMember("stream_compression")) {
+        _stream_compression.active =
+            protocol["stream_compression"]["active"].asBool();
+        _stream_compression.level =
+            protocol["stream_compression"].get("level", 0).asInt();
+        if (_stream_compression.level < 0 || _stream_compression.level > 12) {
+            std::cerr << "Error: stream_compression level must be 0 to 12"
+                << std::endl;
+            throw std::runtime_error(
+                "Invalid stream compression level in protocol config file");
+        }
+    } else {
+        _stream_compression.active = false;
+        _stream_compression.level = 0;
+    }
+
     if (protocol.isMember("endianness")) {
         std::string endian = protocol["endianness"].asString();
         if (endian == "little") {
@@ -93,6 +110,8 @@ ProtocolManager::ProtocolManager(const std::string &path) {
         << std::endl;
     std::cout << "  End of packet: "
         << (_end_of_packet.active ? "enabled" : "disabled") << std::endl;
+    std::cout << "  Stream compression: "
+        << (_stream_compression.active ? "enabled" : "disabled") << std::endl;
 }
 
 uint64_t ProtocolManager::getCurrentTimestamp() const {
@@ -102,9 +121,19 @@ uint64_t ProtocolManager::getCurrentTimestamp() const {
         std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
 }
 
-std::vector<uint8_t> ProtocolManager::formatPacket(std::vector<uint8_t> data) {
+std::vector<uint8_t> ProtocolManager::formatPacket(
+    std::span<const uint8_t> data) {
     std::vector<uint8_t> formattedPacket;
 
+    formatPacketInto(data, formattedPacket);
+    return formattedPacket;
+}
+
+void ProtocolManager::formatPacketInto(std::span<const uint8_t> data,
+    std::vector<uint8_t>& formattedPacket) {
+    formattedPacket.clear();
+    formattedPacket.reserve(data.size() + getProtocolOverhead());
+
     if (_preambule.active) {
         const uint8_t* preambleBytes = reinterpret_cast<const uint8_t*>(
             _preambule.characters.c_str());
@@ -123,9 +152,7 @@ std::vector<uint8_t> ProtocolManager::formatPacket(std::vector<uint8_t> data) {
         writeUint64(formattedPacket, timestamp, _datetime.length);
     }
 
-    const uint8_t* dataBytes = static_cast<const uint8_t*>(data.data());
-    formattedPacket.insert(formattedPacket.end(), dataBytes, dataBytes
-        + data.size());
+    formattedPacket.insert(formattedPacket.end(), data.begin(), data.end());
 
     if (_end_of_packet.active) {
         const uint8_t* endBytes = reinterpret_cast<const uint8_t*>(
@@ -133,14 +160,73 @@ std::vector<uint8_t> ProtocolManager::formatPacket(std::vector<uint8_t> data) {
         formattedPacket.insert(formattedPacket.end(), endBytes,
                               endBytes + _end_of_packet.characters.size());
     }
+}
 
-    return formattedPacket;
+std::span<uint8_t> ProtocolManager::beginPacket(size_t maxSize,
+    std::vector<uint8_t>& out) {
+    out.clear();
+    out.reserve(maxSize + getProtocolOverhead());
+
+    if (_preambule.active) {
+        const uint8_t* preambleBytes = reinterpret_cast<const uint8_t*>(
+            _preambule.characters.c_str());
+        out.insert(out.end(), preambleBytes,
+            preambleBytes + _preambule.characters.size());
+    }
+    // the length is only known once the data is written
+    if (_packet_length.active)
+        out.resize(out.size() + _packet_length.length);
+    if (_datetime.active)
+        writeUint64(out, getCurrentTimestamp(), _datetime.length);
+
+    size_t header = out.size();
+    out.resize(header + maxSize);
+    return std::span<uint8_t>(out.data() + header, maxSize);
+}
+
+void ProtocolManager::finishPacket(size_t size,
+    std::vector<uint8_t>& out) const {
+    size_t lengthOffset = _preambule.active ? _preambule.characters.size() : 0;
+    size_t header = lengthOffset +
+        (_packet_length.active ? _packet_length.length : 0) +
+        (_datetime.active ? _datetime.length : 0);
+
+    out.resize(header + size);
+    if (_packet_length.active) {
+        uint32_t totalLength = static_cast<uint32_t>(size);
+        if (_datetime.active)
+            totalLength += _datetime.length;
+        for (int i = 0; i < _packet_length.length; ++i) {
+            int shift = _endianness == Endianness::BIG
+                ? (_packet_length.length - 1 - i) * 8 : i * 8;
+            out[lengthOffset + i] = (totalLength >> shift) & 0xFF;
+        }
+    }
+    if (_end_of_packet.active) {
+        const uint8_t* endBytes = reinterpret_cast<const uint8_t*>(
+            _end_of_packet.characters.c_str());
+        out.insert(out.end(), endBytes,
+            endBytes + _end_of_packet.characters.size());
+    }
 }
 
 // faut le changer lui je crois :(
 ProtocolManager::UnformattedPacket ProtocolManager::unformatPacket(
     const std::vector<uint8_t> &formattedData) {
+    UnformattedPacketView view = unformatPacketView(formattedData);
     UnformattedPacket result;
+
+    result.data.assign(view.data.begin(), view.data.end());
+    result.packetLength = view.packetLength;
+    result.timestamp = view.timestamp;
+    result.hasLength = view.hasLength;
+    result.hasTimestamp = view.hasTimestamp;
+    return result;
+}
+
+ProtocolManager::UnformattedPacketView ProtocolManager::unformatPacketView(
+    std::span<const uint8_t> formattedData) const {
+    UnformattedPacketView result;
     result.packetLength = 0;
     result.timestamp = 0;
     result.hasLength = false;
@@ -152,10 +238,11 @@ ProtocolManager::UnformattedPacket ProtocolManager::unformatPacket(
             throw std::runtime_error("Packet too small to contain preambule");
         }
 
-        std::string receivedPreambule(formattedData.begin(),
-                                     formattedData.begin()
-                                     + _preambule.characters.size());
-        if (receivedPreambule != _preambule.characters) {
+        if (!std::equal(_preambule.characters.begin(),
+                        _preambule.characters.end(), formattedData.begin(),
+                        [](char c, uint8_t b) {
+                            return static_cast<uint8_t>(c) == b;
+                        })) {
             throw std::runtime_error("Invalid preambule in packet");
         }
         offset += _preambule.characters.size();
@@ -184,47 +271,47 @@ ProtocolManager::UnformattedPacket ProtocolManager::unformatPacket(
         offset += static_cast<size_t>(_datetime.length);
     }
 
+    // every size below comes from the wire, check before subtracting
+    size_t endSize = _end_of_packet.active ?
+        _end_of_packet.characters.size() : 0;
     size_t dataSize;
     if (_packet_length.active && result.hasLength) {
         dataSize = result.packetLength;
         if (_datetime.active) {
+            if (dataSize < static_cast<size_t>(_datetime.length)) {
+                throw std::runtime_error(
+                    "Packet length smaller than its datetime field");
+            }
             dataSize -= _datetime.length;
         }
+        if (formattedData.size() - offset < dataSize) {
+            throw std::runtime_error("Packet shorter than its length field");
+        }
     } else {
-        dataSize = formattedData.size() - offset;
-        if (_end_of_packet.active) {
-            dataSize -= _end_of_packet.characters.size();
+        if (formattedData.size() - offset < endSize) {
+            throw std::runtime_error("Packet too small to contain end marker");
         }
+        dataSize = formattedData.size() - offset - endSize;
     }
 
     if (_end_of_packet.active) {
-        if (formattedData.size() < offset + dataSize
-            + _end_of_packet.characters.size()) {
+        if (formattedData.size() - offset - dataSize < endSize) {
             throw std::runtime_error("Packet too small to contain end marker");
         }
 
         size_t endMarkerPos = offset + dataSize;
-        std::string receivedEnd(formattedData.begin() + endMarkerPos,
-                               formattedData.begin() + endMarkerPos
-                               + _end_of_packet.characters.size());
-        if (receivedEnd != _end_of_packet.characters) {
-            std::cerr << "Expected end marker: ";
-            for (size_t i = 0; i < _end_of_packet.characters.size(); i++) {
-                std::cerr << static_cast<int>(static_cast<uint8_t>(
-                    _end_of_packet.characters[i])) << " ";
-            }
-            std::cerr << ", but got: ";
-            for (size_t i = 0; i < receivedEnd.size(); i++) {
-                std::cerr << static_cast<int>(static_cast<uint8_t>(
-                    receivedEnd[i])) << " ";
-            }
-            std::cerr << std::endl;
+        auto receivedEnd = formattedData.subspan(endMarkerPos,
+            _end_of_packet.characters.size());
+        if (!std::equal(receivedEnd.begin(), receivedEnd.end(),
+                        _end_of_packet.characters.begin(),
+                        [](uint8_t b, char c) {
+                            return b == static_cast<uint8_t>(c);
+                        })) {
             throw std::runtime_error("Invalid end marker in packet");
         }
     }
 
-    result.data = std::vector<uint8_t>(formattedData.begin() + offset,
-                                    formattedData.begin() + offset + dataSize);
+    result.data = formattedData.subspan(offset, dataSize);
     return result;
 }
 
@@ -244,6 +331,11 @@ const ProtocolManager::end_of_packet& ProtocolManager::getEndOfPacket() const {
     return _end_of_packet;
 }
 
+const ProtocolManager::stream_compression&
+ProtocolManager::getStreamCompression() const {
+    return _stream_compression;
+}
+
 ProtocolManager::Endianness ProtocolManager::getEndianness() const {
     return _endianness;
 }
@@ -292,7 +384,7 @@ void ProtocolManager::writeUint64(std::vector<uint8_t>& buffer,
     }
 }
 
-uint32_t ProtocolManager::readUint32(const std::vector<uint8_t>& buffer,
+uint32_t ProtocolManager::readUint32(std::span<const uint8_t> buffer,
                                      size_t offset, int numBytes) const {
     if (offset + static_cast<size_t>(numBytes) > buffer.size()) {
         throw std::runtime_error("readUint32: buffer too small");
@@ -316,7 +408,7 @@ uint32_t ProtocolManager::readUint32(const std::vector<uint8_t>& buffer,
     return value;
 }
 
-uint64_t ProtocolManager::readUint64(const std::vector<uint8_t>& buffer,
+uint64_t ProtocolManager::readUint64(std::span<const uint8_t> buffer,
                                      size_t offset, int numBytes) const {
     if (offset + static_cast<size_t>(numBytes) > buffer.size()) {
         throw std::runtime_error("readUint64: buffer too small");
@@ -1,6 +1,11 @@
 #include <cstring>
 #include <cstdio>
 #include <ctime>
+#include <iomanip>
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -14,12 +19,17 @@
 namespace net {
 
 Server::Server(
-    uint16_t port, const std::string& protocol, const std::string& path)
+    uint16_t port, const std::string& protocol, const std::string& path,
+    bool logging)
     : _port(port),
+    _socket(),
     _running(false),
+    _topTalkers(TOP_TALKERS),
     _protocol(path),
-    _socket(),
-    _logger(true, "./logs", "server") {
+    _logger(logging, "./logs", "server"),
+    _idleClients(CLIENT_TIMEOUT_RESOLUTION),
+    _tickArenaBuffer(std::make_unique<std::byte[]>(TICK_ARENA_SIZE)),
+    _tickArena(_tickArenaBuffer.get(), TICK_ARENA_SIZE) {
     SocketType type;
 
     if (protocol == "TCP" || protocol == "tcp") {
@@ -40,14 +50,245 @@ Server::Server(
         server_pfd.revents = 0;
         _tcp_fds.push_back(server_pfd);
     }
+    registerMetrics();
     _logger.write("==============================");
     _logger.write("Server initialized ready to listen");
 }
 
+void Server::registerMetrics() {
+    _metricsRegistry.add("net_server_packets_in_total",
+        "Packets handed out by unpack", _metrics.packetsIn);
+    _metricsRegistry.add("net_server_packets_out_total",
+        "Packets sent whole", _metrics.packetsOut);
+    _metricsRegistry.add("net_server_bytes_in_total",
+        "Bytes read from the sockets", _metrics.bytesIn);
+    _metricsRegistry.add("net_server_bytes_out_total",
+        "Bytes written to the sockets", _metrics.bytesOut);
+    _metricsRegistry.add("net_server_receives_total",
+        "Datagrams or TCP reads", _metrics.receives);
+    _metricsRegistry.add("net_server_drops_total",
+        "Packets that failed to be sent whole", _metrics.drops);
+    _metricsRegistry.add("net_server_framing_errors_total",
+        "Malformed input found while unpacking", _metrics.framingErrors);
+    _metricsRegistry.add("net_server_syscalls_total",
+        "Poll, accept, recv and send calls", _metrics.syscalls);
+    _metricsRegistry.add("net_server_clients",
+        "UDP and TCP clients known", _metrics.clients);
+    _metricsRegistry.add("net_server_input_queue_bytes",
+        "Bytes received but not unpacked yet", _metrics.inputQueueBytes);
+    _metricsRegistry.add("net_server_syscalls_last_receive",
+        "Syscalls made by the last receive call",
+        _metrics.syscallsLastReceive);
+}
+
+void Server::removeClientInput(const ClientInfo& client) {
+    _metrics.inputQueueBytes.add(-static_cast<int64_t>(client.input.size()));
+}
+
+void Server::forgetClient(const Address& address) {
+    for (auto& erase : _clientTables)
+        erase(address);
+}
+
+void Server::disconnectTcpClient(size_t index) {
+    int client_fd = static_cast<int>(_tcp_fds[index].fd);
+    auto client = _tcp_clients.find(client_fd);
+    auto link = _tcp_links.find(client_fd);
+
+    CLOSE_SOCKET(client_fd);
+    _tcp_fds.erase(_tcp_fds.begin() + index);
+    if (client != _tcp_clients.end()) {
+        if (_onDisconnect && link != _tcp_links.end())
+            _onDisconnect(link->second, client->second);
+        removeClientInput(client->second);
+        _tcp_clients.erase(client);
+    }
+    if (link != _tcp_links.end()) {
+        forgetClient(link->second);
+        _tcp_links.erase(link);
+    }
+    _tcp_streams.erase(client_fd);
+}
+
 Server::~Server() {
     stop();
 }
 
+static uint64_t steadyMilliseconds() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static uint64_t steadyNanoseconds() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Server::setLatencyTracking(bool enabled) {
+    if (enabled == (_latencies != nullptr))
+        return;
+    if (!enabled) {
+        _latencies.reset();
+        for (auto& entry : _udp_clients)
+            std::vector<Arrival>().swap(entry.value.arrivals);
+        for (auto& [fd, client] : _tcp_clients)
+            std::vector<Arrival>().swap(client.arrivals);
+        return;
+    }
+
+    _latencies = std::make_unique<Latencies>();
+    // bytes already waiting count as read now
+    uint64_t now = steadyNanoseconds();
+    auto markWaiting = [now](ClientInfo& client) {
+        if (!client.input.empty())
+            client.arrivals.push_back(
+                {client.streamOffset + client.input.size(), now});
+    };
+    for (auto& entry : _udp_clients)
+        markWaiting(entry.value);
+    for (auto& [fd, client] : _tcp_clients)
+        markWaiting(client);
+}
+
+void Server::resetLatencies() {
+    if (!_latencies)
+        return;
+    _latencies->receiveToFramed.reset();
+    _latencies->framedToUnpack.reset();
+    _latencies->receiveToUnpack.reset();
+    _latencies->sendEnqueueToWrite.reset();
+    _latencies->sendWrite.reset();
+}
+
+void Server::dumpLatencies(std::ostream& out) const {
+    if (!_latencies) {
+        out << "Latency tracking disabled" << std::endl;
+        return;
+    }
+
+    const std::pair<const char*, const LatencyHistogram*> histograms[] = {
+        {"receive_to_framed", &_latencies->receiveToFramed},
+        {"framed_to_unpack", &_latencies->framedToUnpack},
+        {"receive_to_unpack", &_latencies->receiveToUnpack},
+        {"send_enqueue_to_write", &_latencies->sendEnqueueToWrite},
+        {"send_write", &_latencies->sendWrite},
+    };
+    auto us = [](double ns) { return ns / 1000.0; };
+
+    out << std::left << std::setw(24) << "latency (us)" << std::right;
+    for (const char* column : {"count", "min", "p50", "p90", "p99", "p999",
+        "max", "mean"})
+        out << std::setw(11) << column;
+    out << std::endl << std::fixed << std::setprecision(1);
+    for (auto& [name, histogram] : histograms) {
+        out << std::left << std::setw(24) << name << std::right
+            << std::setw(11) << histogram->count()
+            << std::setw(11) << us(histogram->min())
+            << std::setw(11) << us(histogram->percentile(50))
+            << std::setw(11) << us(histogram->percentile(90))
+            << std::setw(11) << us(histogram->percentile(99))
+            << std::setw(11) << us(histogram->percentile(99.9))
+            << std::setw(11) << us(histogram->max())
+            << std::setw(11) << us(histogram->mean()) << std::endl;
+    }
+    out << std::defaultfloat;
+}
+
+void Server::appendInput(ClientInfo& client, const uint8_t* data,
+    size_t size) {
+    client.input.insert(client.input.end(), data, data + size);
+    if (_latencies)
+        client.arrivals.push_back(
+            {client.streamOffset + client.input.size(), steadyNanoseconds()});
+}
+
+void Server::consumeInput(ClientInfo& client, size_t size, uint64_t now) {
+    client.input.erase(client.input.begin(), client.input.begin() + size);
+
+    if (_latencies && !client.arrivals.empty() && size > 0) {
+        // the front arrival holds the first byte, find the one of the last
+        uint64_t lastByte = client.streamOffset + size - 1;
+        uint64_t first = client.arrivals.front().time;
+        uint64_t last = first;
+        for (const Arrival& arrival : client.arrivals) {
+            last = arrival.time;
+            if (arrival.end > lastByte)
+                break;
+        }
+        _latencies->receiveToFramed.record(last - first);
+        _latencies->framedToUnpack.record(now - last);
+        _latencies->receiveToUnpack.record(now - first);
+    }
+
+    client.streamOffset += size;
+    auto consumed = std::find_if(client.arrivals.begin(),
+        client.arrivals.end(), [&client](const Arrival& arrival) {
+            return arrival.end > client.streamOffset;
+        });
+    client.arrivals.erase(client.arrivals.begin(), consumed);
+}
+
+void Server::recordSend(uint64_t enqueued, uint64_t writeStart) {
+    _latencies->sendEnqueueToWrite.record(writeStart - enqueued);
+    _latencies->sendWrite.record(steadyNanoseconds() - writeStart);
+}
+
+void Server::setClientTimeout(std::chrono::milliseconds timeout,
+    std::function<void(const Address&, const ClientInfo&)> onEvict) {
+    uint64_t now = steadyMilliseconds();
+
+    _clientTimeout = timeout.count() > 0
+        ? static_cast<uint64_t>(timeout.count()) : 0;
+    _onClientEvict = onEvict;
+    _idleClients.clear(now);
+    if (_clientTimeout == 0)
+        return;
+    for (auto& entry : _udp_clients)
+        _idleClients.schedule(entry.address.toKey(),
+            entry.value.lastPacketTime + _clientTimeout);
+}
+
+void Server::setDisconnectHandler(
+    std::function<void(const Address&, const ClientInfo&)> onDisconnect) {
+    _onDisconnect = onDisconnect;
+}
+
+size_t Server::expireIdleClients() {
+    if (_clientTimeout == 0)
+        return 0;
+
+    uint64_t now = steadyMilliseconds();
+    size_t evicted = 0;
+
+    _idleClients.advance(now, [&](uint64_t key) {
+        Address address = Address::fromKey(key);
+        ClientInfo* client = _udp_clients.find(address);
+        if (client == nullptr)
+            return;
+
+        uint64_t deadline = client->lastPacketTime + _clientTimeout;
+        if (deadline > now) {
+            // got packets since it was scheduled, check again later
+            _idleClients.schedule(key, deadline);
+            return;
+        }
+        if (_onClientEvict)
+            _onClientEvict(address, *client);
+        removeClientInput(*client);
+        _udp_clients.erase(address);
+        forgetClient(address);
+        evicted++;
+    });
+    _metrics.clients.set(_udp_clients.size() + _tcp_clients.size());
+    if (evicted > 0) {
+        _logger.write("EXPIRE\t" + std::to_string(evicted) +
+            " idle clients evicted");
+    }
+    return evicted;
+}
+
 std::size_t Server::evalBandwidthUsage() {
     auto now = std::chrono::system_clock::now();
     auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -57,16 +298,18 @@ std::size_t Server::evalBandwidthUsage() {
 
     std::size_t oldBytesOutPerSecond = _bytesOutPerSecond;
     std::size_t oldBytesInPerSecond = _bytesInPerSecond;
+    uint64_t bytesOut = _metrics.bytesOut.value();
+    uint64_t bytesIn = _metrics.bytesIn.value();
 
     if (elapsedSeconds > 0.0) {
-        _bytesOutPerSecond =
-            static_cast<std::size_t>(_bytesOut / elapsedSeconds);
-        _bytesInPerSecond =
-            static_cast<std::size_t>(_bytesIn / elapsedSeconds);
+        _bytesOutPerSecond = static_cast<std::size_t>(
+            (bytesOut - _lastBytesOut) / elapsedSeconds);
+        _bytesInPerSecond = static_cast<std::size_t>(
+            (bytesIn - _lastBytesIn) / elapsedSeconds);
     }
 
-    _bytesOut = 0;
-    _bytesIn = 0;
+    _lastBytesOut = bytesOut;
+    _lastBytesIn = bytesIn;
     _lastBandWidthCheck = now;
     if (oldBytesInPerSecond != _bytesInPerSecond ||
         oldBytesOutPerSecond != _bytesOutPerSecond
@@ -131,8 +374,17 @@ void Server::stop() {
         CLOSE_SOCKET(static_cast<SocketHandle>(_tcp_fds[i].fd));
     }
     _tcp_fds.clear();
+    for (auto& entry : _udp_clients)
+        forgetClient(entry.address);
+    for (auto& [fd, address] : _tcp_links)
+        forgetClient(address);
     _udp_clients.clear();
     _tcp_clients.clear();
+    _tcp_links.clear();
+    _tcp_streams.clear();
+    _idleClients.clear(steadyMilliseconds());
+    _metrics.clients.set(0);
+    _metrics.inputQueueBytes.set(0);
 
     if (_socket.isValid())
         _socket.close();
@@ -158,6 +410,7 @@ int Server::acceptClient(Address& client_addr, uint64_t currentTime) {
     }
 
     int client_fd = _socket.accept(client_addr);
+    _metrics.syscalls.add();
     if (client_fd < 0) {
         _logger.write("ERROR\tAccept error (fd < 0)");
         throw NetworkSocket::AcceptFailed();
@@ -167,8 +420,15 @@ int Server::acceptClient(Address& client_addr, uint64_t currentTime) {
     newClient.lastPacketTime = currentTime;
     newClient.input.clear();
     newClient.output.clear();
+    newClient.address = client_addr;
 
     _tcp_clients.insert(std::make_pair(client_fd, newClient));
+    _tcp_links[client_fd] = client_addr;
+    if (_protocol.getStreamCompression().active) {
+        _tcp_streams.try_emplace(client_fd,
+            _protocol.getStreamCompression().level);
+    }
+    _metrics.clients.set(_udp_clients.size() + _tcp_clients.size());
 
     POLLFD client_pfd;
     client_pfd.fd = client_fd;
@@ -179,7 +439,107 @@ int Server::acceptClient(Address& client_addr, uint64_t currentTime) {
     return client_fd;
 }
 
-std::string dataToString(std::vector<uint8_t> buff) {
+void Server::renderMetrics(std::string& out) const {
+    MetricsExporter::renderRegistry(_metricsRegistry, out);
+
+    std::vector<std::pair<std::string, double>> talkers;
+    for (const Talker& talker : getTopTalkers(TOP_TALKERS)) {
+        talkers.emplace_back(talker.address.getIP() + ":" +
+            std::to_string(talker.address.getPort()),
+            static_cast<double>(talker.bytes));
+    }
+    MetricsExporter::renderLabelledGauge("net_server_top_talker_bytes",
+        "Estimated bytes sent and received by the heaviest clients",
+        "address", talkers, out);
+
+    if (_latencies) {
+        const std::pair<const char*, const LatencyHistogram*> latencies[] = {
+            {"receive_to_framed", &_latencies->receiveToFramed},
+            {"framed_to_unpack", &_latencies->framedToUnpack},
+            {"receive_to_unpack", &_latencies->receiveToUnpack},
+            {"send_enqueue_to_write", &_latencies->sendEnqueueToWrite},
+            {"send_write", &_latencies->sendWrite},
+        };
+        for (auto& [name, histogram] : latencies) {
+            MetricsExporter::renderSummary(
+                std::string("net_server_") + name + "_seconds",
+                std::string("Latency ") + name, *histogram, 1e-9, out);
+        }
+    }
+    MetricsExporter::renderEnd(out);
+}
+
+bool Server::writeMetricsFile(const std::string& path) {
+    _metricsText.clear();
+    renderMetrics(_metricsText);
+    if (!MetricsExporter::writeFile(path, _metricsText)) {
+        _logger.write("ERROR\tFailed to write metrics to " + path);
+        return false;
+    }
+    return true;
+}
+
+bool Server::exposeMetrics(uint16_t port) {
+    try {
+        _metricsEndpoint = std::make_unique<MetricsEndpoint>(port);
+    } catch (const std::exception& e) {
+        _logger.write("ERROR\tCannot serve metrics on port " +
+            std::to_string(port) + ": " + e.what());
+        return false;
+    }
+    _logger.write("Metrics served on 127.0.0.1:" +
+        std::to_string(_metricsEndpoint->getPort()));
+    return true;
+}
+
+size_t Server::serveMetrics() {
+    if (!_metricsEndpoint)
+        return 0;
+    return _metricsEndpoint->serve([this](std::string& out) {
+        renderMetrics(out);
+    });
+}
+
+void Server::pollMetrics() {
+    if (!_metricsEndpoint)
+        return;
+
+    uint64_t now = steadyMilliseconds();
+    if (now < _nextMetricsPoll)
+        return;
+    _nextMetricsPoll = now + METRICS_POLL_INTERVAL;
+    serveMetrics();
+}
+
+void Server::startCapture(const std::string& path) {
+    _capture = std::make_unique<PcapWriter>(path);
+    _captureAddress = Address("127.0.0.1", _port);
+    _logger.write("Capturing packets to " + path);
+}
+
+void Server::stopCapture() {
+    if (!_capture)
+        return;
+    _logger.write("Capture stopped, " +
+        std::to_string(_capture->getPacketCount()) + " packets written");
+    _capture.reset();
+}
+
+void Server::capture(const Address& source, const Address& destination,
+    std::span<const uint8_t> data) {
+    _capture->write(_socket.getType(), source, destination, data);
+}
+
+std::vector<Server::Talker> Server::getTopTalkers(size_t n) const {
+    std::vector<Talker> result;
+
+    for (const TopTalkers::Entry& entry : _topTalkers.top(n))
+        result.push_back({Address::fromKey(entry.key), entry.count,
+            entry.error});
+    return result;
+}
+
+static std::string dataToString(std::span<const uint8_t> buff) {
     std::string res;
 
     for (auto& byte : buff)
@@ -187,7 +547,7 @@ std::string dataToString(std::vector<uint8_t> buff) {
     return res;
 }
 
-int Server::udpSend(const Address& dest, std::vector<uint8_t> data) {
+int Server::udpSend(const Address& dest, std::span<const uint8_t> data) {
     if (!_running) {
         _logger.write("ERROR\tCannot send before starting server");
         throw ServerNotStarted();
@@ -207,34 +567,52 @@ int Server::udpSend(const Address& dest, std::vector<uint8_t> data) {
         throw BadData();
     }
 
-    auto it = _udp_clients.find(dest);
-    if (it == _udp_clients.end()) {
+    ClientInfo* client = _udp_clients.find(dest);
+    if (client == nullptr) {
         _logger.write("ERROR\tUnknown address given to send");
         throw UnknownAddressOrFd();
     }
 
-    std::vector<uint8_t> fullPacket = _protocol.formatPacket(data);
-
-    _logger.write(
-        "SEND\t" +
-        dest.getIP() +
-        ":" +
-        std::to_string(dest.getPort()) +
-        "\t" +
-        dataToString(fullPacket));
+    uint64_t enqueued = _latencies ? steadyNanoseconds() : 0;
+    std::vector<uint8_t>& fullPacket = _sendBuffer;
+    _protocol.formatPacketInto(data, fullPacket);
 
-    _bytesOut += fullPacket.size();
+    if (_logger.isActive()) {
+        _logger.write(
+            "SEND\t" +
+            dest.getIP() +
+            ":" +
+            std::to_string(dest.getPort()) +
+            "\t" +
+            dataToString(fullPacket));
+    }
 
+    uint64_t writeStart = _latencies ? steadyNanoseconds() : 0;
     int sent = _socket.sendTo(fullPacket.data(), fullPacket.size(), dest);
+    _metrics.syscalls.add();
+    if (_capture && sent > 0)
+        capture(_captureAddress, dest, std::span(fullPacket.data(), sent));
+    if (_latencies)
+        recordSend(enqueued, writeStart);
 
     if (sent < 0) {
+        _metrics.drops.add();
         _logger.write("ERROR\tFailed to send data to given dest");
         throw NetworkSocket::DataSendFailed();
     }
+    _metrics.bytesOut.add(sent);
+    client->bytesOut += sent;
+    _topTalkers.add(dest.toKey(), sent);
+    if (static_cast<size_t>(sent) == fullPacket.size()) {
+        _metrics.packetsOut.add();
+        client->packetsOut++;
+    } else {
+        _metrics.drops.add();
+    }
     return sent;
 }
 
-int Server::tcpSend(int dest, std::vector<uint8_t> data) {
+int Server::tcpSend(int dest, std::span<const uint8_t> data) {
     if (!_running) {
         _logger.write("ERROR\tCannot send before starting server");
         throw ServerNotStarted();
@@ -260,26 +638,61 @@ int Server::tcpSend(int dest, std::vector<uint8_t> data) {
         throw UnknownAddressOrFd();
     }
 
-    std::vector<uint8_t> fullPacket = _protocol.formatPacket(data);
+    uint64_t enqueued = _latencies ? steadyNanoseconds() : 0;
+    std::vector<uint8_t>& fullPacket = _sendBuffer;
+    _protocol.formatPacketInto(data, fullPacket);
 
-    _logger.write(
-        "SEND\t" +
-        std::to_string(dest) +
-        "\t" +
-        dataToString(fullPacket));
+    if (_logger.isActive()) {
+        _logger.write(
+            "SEND\t" +
+            std::to_string(dest) +
+            "\t" +
+            dataToString(fullPacket));
+    }
 
-    _bytesOut += fullPacket.size();
+    std::span<const uint8_t> wire = fullPacket;
+    auto stream = _tcp_streams.find(dest);
+    if (stream != _tcp_streams.end()) {
+        _streamBuffer.clear();
+        stream->second.encoder.compress(fullPacket, _streamBuffer);
+        wire = _streamBuffer;
+    }
 
+    uint64_t writeStart = _latencies ? steadyNanoseconds() : 0;
     size_t totalSent = 0;
-    while (totalSent < fullPacket.size()) {
-        int sent = ::send(dest, reinterpret_cast<const char*>(fullPacket.data()
-            + totalSent), static_cast<int>(fullPacket.size() - totalSent), 0);
+    while (totalSent < wire.size()) {
+        int sent = ::send(dest, reinterpret_cast<const char*>(wire.data()
+            + totalSent), static_cast<int>(wire.size() - totalSent), 0);
+        _metrics.syscalls.add();
         if (sent == SOCKET_ERROR_VALUE || sent == 0) {
+            _metrics.bytesOut.add(totalSent);
+            it->second.bytesOut += totalSent;
+            _topTalkers.add(it->second.address.toKey(), totalSent);
+            _metrics.drops.add();
             _logger.write("ERROR\tFailed to send data to given dest");
+            // the peer can't resync, tcpReceive disconnects it on the hangup:
+            // the caller may be iterating over the clients
+            if (stream != _tcp_streams.end() || totalSent > 0) {
+                _logger.write("ERROR\tStream to " + std::to_string(dest) +
+                    " broken, shutting it down");
+                if (stream != _tcp_streams.end())
+                    _tcp_streams.erase(stream);
+                SHUTDOWN_SOCKET(dest);
+            }
             throw NetworkSocket::DataSendFailed();
         }
+        if (_capture)
+            capture(_captureAddress, it->second.address,
+                wire.subspan(totalSent, sent));
         totalSent += sent;
     }
+    if (_latencies)
+        recordSend(enqueued, writeStart);
+    _metrics.bytesOut.add(totalSent);
+    _metrics.packetsOut.add();
+    it->second.bytesOut += totalSent;
+    it->second.packetsOut++;
+    _topTalkers.add(it->second.address.toKey(), totalSent);
     return static_cast<int>(totalSent);
 }
 
@@ -299,56 +712,75 @@ std::vector<Address> Server::udpReceive(int timeout, int maxInputs) {
             "Socket type is TCP, udpReceive() is for UDP only");
     }
 
+    expireIdleClients();
+    pollMetrics();
+
     POLLFD pfd;
     pfd.fd = _socket.getSocket();
     pfd.events = POLL_IN;
     pfd.revents = 0;
 
     int poll_result = PollSockets(&pfd, 1, timeout);
+    uint64_t syscalls = _metrics.syscalls.value();
+    _metrics.syscalls.add();
+    _metrics.syscallsLastReceive.set(1);
     if (poll_result < 0)
         return results;
     if (poll_result == 0)
         return results;
 
     size_t bufsiz = BUFSIZ + _protocol.getProtocolOverhead();
+    std::vector<uint8_t>& buffer = _receiveBuffer;
+    buffer.resize(bufsiz);
+    results.reserve(std::min(maxInputs, UDP_RESULTS_RESERVE));
 
     for (size_t count = 0; count < maxInputs; count++) {
         Address sender;
-        std::vector<uint8_t> buffer(bufsiz);
 
         int received = _socket.receiveFrom(buffer.data(), bufsiz, sender);
+        _metrics.syscalls.add();
         if (received <= 0)
             break;
-
-        buffer.resize(received);
-
-        _logger.write(
-            "RECV\t" +
-            sender.getIP() +
-            ":" +
-            std::to_string(sender.getPort()) +
-            "\t" +
-            dataToString(buffer));
-        _bytesIn += received;
-
-        uint64_t currentTime = static_cast<uint64_t>(std::time(nullptr));
-
-        auto it = _udp_clients.find(sender);
-        if (it == _udp_clients.end()) {
-            ClientInfo newClient;
-            newClient.lastPacketTime = currentTime;
-            newClient.input = buffer;
-            newClient.output.clear();
-
-            _udp_clients.insert(std::make_pair(sender, newClient));
+        if (_capture)
+            capture(sender, _captureAddress,
+                std::span(buffer.data(), received));
+
+        std::span<const uint8_t> datagram(buffer.data(), received);
+
+        if (_logger.isActive()) {
+            _logger.write(
+                "RECV\t" +
+                sender.getIP() +
+                ":" +
+                std::to_string(sender.getPort()) +
+                "\t" +
+                dataToString(datagram));
+        }
+        _metrics.receives.add();
+        _metrics.bytesIn.add(received);
+        _metrics.inputQueueBytes.add(received);
+
+        uint64_t currentTime = steadyMilliseconds();
+
+        auto [client, inserted] = _udp_clients.tryEmplace(sender);
+        if (inserted) {
+            client->lastPacketTime = currentTime;
+            appendInput(*client, datagram.data(), datagram.size());
+            client->output.clear();
+            client->address = sender;
+            if (_clientTimeout > 0)
+                _idleClients.schedule(sender.toKey(),
+                    currentTime + _clientTimeout);
+            _metrics.clients.set(_udp_clients.size() + _tcp_clients.size());
         } else {
-            it->second.input.insert(it->second.input.end(),
-                                    buffer.begin(),
-                                    buffer.end());
-            it->second.lastPacketTime = currentTime;
+            appendInput(*client, datagram.data(), datagram.size());
+            client->lastPacketTime = currentTime;
         }
+        client->bytesIn += received;
+        _topTalkers.add(sender.toKey(), received);
         results.push_back(sender);
     }
+    _metrics.syscallsLastReceive.set(_metrics.syscalls.value() - syscalls);
     return results;
 }
 
@@ -373,6 +805,7 @@ std::vector<int> Server::tcpReceive(int timeout) {
             "Socket type is UDP, tcpReceive() is for TCP only");
     }
 
+    pollMetrics();
     for (auto& pfd : _tcp_fds)
         pfd.revents = 0;
 
@@ -382,6 +815,9 @@ std::vector<int> Server::tcpReceive(int timeout) {
 #else
     int poll_result = PollSockets(_tcp_fds.data(), _tcp_fds.size(), timeout);
 #endif
+    uint64_t syscalls = _metrics.syscalls.value();
+    _metrics.syscalls.add();
+    _metrics.syscallsLastReceive.set(1);
     if (poll_result < 0) {
         _logger.write("ERROR\tPoll error in TCP receive");
         throw PollError();
@@ -389,7 +825,7 @@ std::vector<int> Server::tcpReceive(int timeout) {
     if (poll_result == 0)
         return results;
 
-    uint64_t currentTime = static_cast<uint64_t>(std::time(nullptr));
+    uint64_t currentTime = steadyMilliseconds();
     if (_tcp_fds[0].revents & POLL_IN) {
         Address client_addr;
         int client_fd = acceptClient(client_addr, currentTime);
@@ -402,10 +838,7 @@ std::vector<int> Server::tcpReceive(int timeout) {
         // Check for errors or hangup (connection closed by peer)
         if ((_tcp_fds[i].revents & POLL_ERR)
             || (_tcp_fds[i].revents & POLL_HUP)) {
-            CLOSE_SOCKET(client_fd);
-            _tcp_fds.erase(_tcp_fds.begin() + i);
-            _tcp_clients.erase(client_fd);
-            _tcp_links.erase(client_fd);
+            disconnectTcpClient(i);
             i--;
             continue;
         }
@@ -415,23 +848,23 @@ std::vector<int> Server::tcpReceive(int timeout) {
 
         size_t client_index = i - NB_SERVERFD;
 
-        std::vector<uint8_t> buffer(bufsiz);
+        std::vector<uint8_t>& buffer = _receiveBuffer;
+        buffer.resize(bufsiz);
 
         int received = ::recv(client_fd, reinterpret_cast<char*>(buffer.data()),
                              static_cast<int>(bufsiz), 0);
-
-        _logger.write(
-            "RECV\t" +
-            std::to_string(client_fd) +
-            "\t" +
-            dataToString(buffer));
-        _bytesIn += received;
+        _metrics.syscalls.add();
+
+        if (_logger.isActive()) {
+            _logger.write(
+                "RECV\t" +
+                std::to_string(client_fd) +
+                "\t" +
+                dataToString(buffer));
+        }
 
         if (received == 0) {
-            CLOSE_SOCKET(client_fd);
-            _tcp_fds.erase(_tcp_fds.begin() + i);
-            _tcp_clients.erase(client_fd);
-            _tcp_links.erase(client_fd);
+            disconnectTcpClient(i);
             i--;  // recalage
             continue;
         }
@@ -439,31 +872,57 @@ std::vector<int> Server::tcpReceive(int timeout) {
         if (received < 0)
             continue;
 
+        _metrics.receives.add();
+        _metrics.bytesIn.add(received);
         auto it = _tcp_clients.find(client_fd);
         if (it != _tcp_clients.end()) {
+            if (_capture)
+                capture(it->second.address, _captureAddress,
+                    std::span(buffer.data(), received));
+            std::span<const uint8_t> input(buffer.data(), received);
+            auto stream = _tcp_streams.find(client_fd);
+            if (stream != _tcp_streams.end()) {
+                _streamBuffer.clear();
+                if (!stream->second.decoder.decompress(input, _streamBuffer)) {
+                    _metrics.framingErrors.add();
+                    _logger.write("ERROR\tInvalid compressed stream from " +
+                        std::to_string(client_fd) + ", disconnecting");
+                    disconnectTcpClient(i);
+                    i--;
+                    continue;
+                }
+                input = _streamBuffer;
+            }
+            _metrics.inputQueueBytes.add(input.size());
             it->second.lastPacketTime = currentTime;
-            it->second.input.insert(it->second.input.end(),
-                                    buffer.begin(),
-                                    buffer.begin() + received);
+            appendInput(it->second, input.data(), input.size());
+            it->second.bytesIn += received;
+            _topTalkers.add(it->second.address.toKey(), received);
             results.push_back(client_fd);
         }
     }
+    _metrics.clients.set(_udp_clients.size() + _tcp_clients.size());
+    _metrics.syscallsLastReceive.set(_metrics.syscalls.value() - syscalls);
     return results;
 }
 
-// sketchy j'ai pas le temps de tester
-std::vector<std::vector<uint8_t>> Server::getDataFromBuffer(
-        int nbPackets, ClientInfo& client) {
-    std::vector<std::vector<uint8_t>> result;
-
-    ProtocolManager::preambule preamble = _protocol.getPreambule();
-    ProtocolManager::datetime datetime = _protocol.getDatetime();
-    ProtocolManager::packet_length packetLength = _protocol.getPacketLength();
-    ProtocolManager::end_of_packet packetEnd = _protocol.getEndOfPacket();
+template<typename PacketList>
+PacketList Server::getDataFromBuffer(int nbPackets, ClientInfo& client,
+        const typename PacketList::allocator_type& alloc) {
+    PacketList result(alloc);
+
+    const ProtocolManager::preambule& preamble = _protocol.getPreambule();
+    const ProtocolManager::datetime& datetime = _protocol.getDatetime();
+    const ProtocolManager::packet_length& packetLength =
+        _protocol.getPacketLength();
+    const ProtocolManager::end_of_packet& packetEnd =
+        _protocol.getEndOfPacket();
     ProtocolManager::Endianness endianness = _protocol.getEndianness();
 
     int packetsToUnpack = (nbPackets < 0) ? 1000 : nbPackets;
     int packetCount = 0;
+    size_t inputSize = client.input.size();
+    uint64_t now = _latencies ? steadyNanoseconds() : 0;
 
     while (!client.input.empty() && packetCount < packetsToUnpack) {
         size_t offset = 0;
@@ -509,7 +968,16 @@ std::vector<std::vector<uint8_t>> Server::getDataFromBuffer(
             uint32_t actualDataLength = dataLength;
             if (datetime.active) {
                 if (dataLength < CAST_UINT32(datetime.length)) {
-                    break;
+                    // too short to hold its datetime: dropped once whole,
+                    // counted once, the next packets still come through
+                    size_t badSize = offset + dataLength +
+                        (packetEnd.active ? packetEnd.characters.size() : 0);
+                    if (client.input.size() < badSize)
+                        break;
+                    _metrics.framingErrors.add();
+                    client.framingErrors++;
+                    consumeInput(client, badSize, now);
+                    continue;
                 }
                 actualDataLength = dataLength - datetime.length;
             }
@@ -520,26 +988,20 @@ std::vector<std::vector<uint8_t>> Server::getDataFromBuffer(
                 offset += datetime.length;
             }
 
-            if (client.input.size() < offset + actualDataLength)
+            // hand out a packet only once it is whole, end marker included,
+            // or the next call would return it a second time
+            size_t packetSize = offset + actualDataLength +
+                (packetEnd.active ? packetEnd.characters.size() : 0);
+            if (client.input.size() < packetSize)
                 break;
 
-            std::vector<uint8_t> packetData(
+            // built in place so a pmr result hands its resource to the packet
+            result.emplace_back(
                     client.input.begin() + offset,
                     client.input.begin() + offset + actualDataLength);
-
-            result.push_back(packetData);
             packetCount++;
-            offset += actualDataLength;
-            if (packetEnd.active) {
-                if (client.input.size()
-                    < offset + packetEnd.characters.size()) {
-                    break;
-                }
-                offset += packetEnd.characters.size();
-            }
 
-            client.input.erase(client.input.begin(),
-                    client.input.begin() + offset);
+            consumeInput(client, packetSize, now);
 
         } else if (packetEnd.active) {
             if (datetime.active) {
@@ -548,7 +1010,7 @@ std::vector<std::vector<uint8_t>> Server::getDataFromBuffer(
                 offset += datetime.length;
             }
 
-            std::string endMarker = packetEnd.characters;
+            const std::string& endMarker = packetEnd.characters;
             auto it = std::search(
                     client.input.begin() + offset,
                     client.input.end(),
@@ -562,21 +1024,24 @@ std::vector<std::vector<uint8_t>> Server::getDataFromBuffer(
             size_t dataStart = offset;
             dataLength = dataEnd - dataStart;
 
-            std::vector<uint8_t> packetData(
+            result.emplace_back(
                     client.input.begin() + dataStart,
                     client.input.begin() + dataEnd);
-
-            result.push_back(packetData);
             packetCount++;
 
-            client.input.erase(client.input.begin(),
-                    client.input.begin() + dataEnd + endMarker.size());
+            consumeInput(client, dataEnd + endMarker.size(), now);
         } else {
+            _metrics.framingErrors.add();
+            client.framingErrors++;
             _logger.write("ERROR\tData unpacking error, probably bad format");
             throw BadData();
         }
     }
 
+    _metrics.packetsIn.add(packetCount);
+    client.packetsIn += packetCount;
+    _metrics.inputQueueBytes.add(
+        -static_cast<int64_t>(inputSize - client.input.size()));
     return result;
 }
 
@@ -589,24 +1054,47 @@ std::vector<std::vector<uint8_t>> Server::unpack(int src, int nbPackets) {
 
     ClientInfo& client = it->second;
 
-    return getDataFromBuffer(nbPackets, client);
+    return getDataFromBuffer<std::vector<std::vector<uint8_t>>>(
+        nbPackets, client, {});
 }
 
 std::vector<std::vector<uint8_t>> Server::unpack(
         const Address& src, int nbPackets) {
-    auto it = _udp_clients.find(src);
-    if (it == _udp_clients.end()) {
+    ClientInfo* client = _udp_clients.find(src);
+    if (client == nullptr) {
         _logger.write("ERROR\tUnknown address given to unpack data");
         throw UnknownAddressOrFd();
     }
 
-    ClientInfo& client = it->second;
+    return getDataFromBuffer<std::vector<std::vector<uint8_t>>>(
+        nbPackets, *client, {});
+}
 
-    return getDataFromBuffer(nbPackets, client);
+std::pmr::vector<std::pmr::vector<uint8_t>> Server::unpack(int src,
+        int nbPackets, std::pmr::memory_resource* arena) {
+    auto it = _tcp_clients.find(src);
+    if (it == _tcp_clients.end()) {
+        _logger.write("ERROR\tUnknown fd given to unpack data");
+        throw UnknownAddressOrFd();
+    }
+
+    return getDataFromBuffer<std::pmr::vector<std::pmr::vector<uint8_t>>>(
+        nbPackets, it->second, arena);
 }
 
-const std::unordered_map<Address, Server::ClientInfo>& Server::getUdpClients()
-    const {
+std::pmr::vector<std::pmr::vector<uint8_t>> Server::unpack(
+        const Address& src, int nbPackets, std::pmr::memory_resource* arena) {
+    ClientInfo* client = _udp_clients.find(src);
+    if (client == nullptr) {
+        _logger.write("ERROR\tUnknown address given to unpack data");
+        throw UnknownAddressOrFd();
+    }
+
+    return getDataFromBuffer<std::pmr::vector<std::pmr::vector<uint8_t>>>(
+        nbPackets, *client, arena);
+}
+
+const AddressTable<Server::ClientInfo>& Server::getUdpClients() const {
     return _udp_clients;
 }
 
@@ -615,7 +1103,7 @@ const std::unordered_map<int, Server::ClientInfo>& Server::getTcpClients()
     return _tcp_clients;
 }
 
-std::unordered_map<Address, Server::ClientInfo>& Server::getUdpClientsRef() {
+AddressTable<Server::ClientInfo>& Server::getUdpClientsRef() {
     return _udp_clients;
 }
 
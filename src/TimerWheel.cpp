@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "Network/TimerWheel.hpp"
+
+namespace net {
+
+TimerWheel::TimerWheel(uint64_t resolution, uint64_t now)
+    : _resolution(std::max<uint64_t>(resolution, 1)),
+    _current(now / _resolution) {}
+
+void TimerWheel::schedule(uint64_t id, uint64_t deadline) {
+    Timer timer;
+    timer.id = id;
+    // already due timers fire on the next tick
+    timer.tick = std::max((deadline + _resolution - 1) / _resolution,
+        _current + 1);
+    insert(timer);
+    _size++;
+}
+
+void TimerWheel::clear(uint64_t now) {
+    for (auto& level : _slots)
+        for (auto& slot : level)
+            slot.clear();
+    _occupied.fill(0);
+    _size = 0;
+    _current = now / _resolution;
+}
+
+void TimerWheel::insert(const Timer& timer) {
+    uint64_t tick = std::max(timer.tick, _current);
+    uint64_t delta = tick - _current;
+
+    for (size_t level = 0; level < LEVELS; ++level) {
+        if (delta >> (SLOT_BITS * (level + 1)) == 0) {
+            size_t slot = (tick >> (SLOT_BITS * level)) & (SLOTS - 1);
+            _slots[level][slot].push_back(timer);
+            _occupied[level] |= 1ULL << slot;
+            return;
+        }
+    }
+
+    // out of range, parked in the farthest slot and placed again later
+    size_t last = LEVELS - 1;
+    uint64_t farthest = _current + (1ULL << (SLOT_BITS * LEVELS)) - 1;
+    size_t slot = (farthest >> (SLOT_BITS * last)) & (SLOTS - 1);
+    _slots[last][slot].push_back(timer);
+    _occupied[last] |= 1ULL << slot;
+}
+
+void TimerWheel::cascade() {
+    // higher levels first so their timers can drop down to the lower ones
+    for (size_t level = LEVELS - 1; level > 0; --level) {
+        uint64_t lowBits = (1ULL << (SLOT_BITS * level)) - 1;
+        if (_current & lowBits)
+            continue;
+
+        size_t slot = (_current >> (SLOT_BITS * level)) & (SLOTS - 1);
+        if (!(_occupied[level] & (1ULL << slot)))
+            continue;
+
+        _pending.swap(_slots[level][slot]);
+        _occupied[level] &= ~(1ULL << slot);
+        for (const Timer& timer : _pending)
+            insert(timer);
+        _pending.clear();
+    }
+}
+
+}  // namespace net
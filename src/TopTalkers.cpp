@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "Network/TopTalkers.hpp"
+
+namespace net {
+
+TopTalkers::TopTalkers(size_t capacity)
+    : _keys(std::max<size_t>(capacity, 1), 0),
+    _entries(_keys.size(), Entry{0, 0, 0}) {}
+
+void TopTalkers::add(uint64_t key, uint64_t weight) {
+    _total += weight;
+
+    for (size_t i = 0; i < _size; ++i) {
+        if (_keys[i] == key) {
+            _entries[i].count += weight;
+            return;
+        }
+    }
+    if (_size < _keys.size()) {
+        _keys[_size] = key;
+        _entries[_size] = {key, weight, 0};
+        _size++;
+        return;
+    }
+
+    size_t smallest = 0;
+    for (size_t i = 1; i < _size; ++i) {
+        if (_entries[i].count < _entries[smallest].count)
+            smallest = i;
+    }
+    uint64_t evicted = _entries[smallest].count;
+    _keys[smallest] = key;
+    _entries[smallest] = {key, evicted + weight, evicted};
+}
+
+std::vector<TopTalkers::Entry> TopTalkers::top(size_t n) const {
+    std::vector<Entry> result(_entries.begin(), _entries.begin() + _size);
+
+    n = std::min(n, result.size());
+    std::partial_sort(result.begin(), result.begin() + n, result.end(),
+        [](const Entry& a, const Entry& b) { return a.count > b.count; });
+    result.resize(n);
+    return result;
+}
+
+void TopTalkers::clear() {
+    _size = 0;
+    _total = 0;
+}
+
+}  // namespace net
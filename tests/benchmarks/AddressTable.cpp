@@ -0,0 +1,132 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** AddressTable.cpp
+*/
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "Network/AddressTable.hpp"
+#include "Network/Server.hpp"
+
+namespace {
+
+constexpr size_t NB_CLIENTS = 50000;
+
+// std::hash<net::Address> before the mixing hash
+struct LegacyAddressHash {
+    size_t operator()(const net::Address& addr) const {
+        size_t h1 = std::hash<uint32_t>()(addr.getIPAsInt());
+        size_t h2 = std::hash<uint16_t>()(addr.getPort());
+        return h1 ^ (h2 << 1);
+    }
+};
+
+enum Distribution {
+    // every client behind one NAT IP, ports handed out in sequence
+    SEQUENTIAL_PORTS,
+    // 64 clients per IP, ports only differing in their high bits
+    STRIDED_PORTS,
+    // one port, IPs only differing in their low byte then next byte
+    SEQUENTIAL_IPS,
+    RANDOM,
+};
+
+std::vector<net::Address> makeAddresses(Distribution distribution) {
+    std::vector<net::Address> addresses;
+    std::mt19937 rng(42);
+
+    addresses.reserve(NB_CLIENTS);
+    for (uint32_t i = 0; i < NB_CLIENTS; ++i) {
+        switch (distribution) {
+            case SEQUENTIAL_PORTS:
+                addresses.emplace_back(0x0A000001,
+                    static_cast<uint16_t>(1024 + i));
+                break;
+            case STRIDED_PORTS:
+                addresses.emplace_back(0x0A000001 + (i / 64),
+                    static_cast<uint16_t>((i % 64) << 10));
+                break;
+            case SEQUENTIAL_IPS:
+                addresses.emplace_back(0x0A000000 + i, 5000);
+                break;
+            case RANDOM:
+                addresses.emplace_back(static_cast<uint32_t>(rng()),
+                    static_cast<uint16_t>(rng()));
+                break;
+        }
+    }
+    return addresses;
+}
+
+std::vector<net::Address> lookupOrder(std::vector<net::Address> addresses) {
+    std::shuffle(addresses.begin(), addresses.end(), std::mt19937(7));
+    return addresses;
+}
+
+template<typename Map>
+void fillMap(Map& map, const std::vector<net::Address>& addresses) {
+    for (auto& addr : addresses)
+        map[addr].lastPacketTime = 1;
+}
+
+void BM_AddressTableLookup(benchmark::State& state) {
+    auto addresses = makeAddresses(static_cast<Distribution>(state.range(0)));
+    auto order = lookupOrder(addresses);
+    net::AddressTable<net::Server::ClientInfo> table;
+    fillMap(table, addresses);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(table.find(order[i]));
+        i = (i + 1 == order.size()) ? 0 : i + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<typename Hash>
+void BM_UnorderedMapLookup(benchmark::State& state) {
+    auto addresses = makeAddresses(static_cast<Distribution>(state.range(0)));
+    auto order = lookupOrder(addresses);
+    std::unordered_map<net::Address, net::Server::ClientInfo, Hash> map;
+    fillMap(map, addresses);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(map.find(order[i]));
+        i = (i + 1 == order.size()) ? 0 : i + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_AddressTableChurn(benchmark::State& state) {
+    auto addresses = makeAddresses(static_cast<Distribution>(state.range(0)));
+    net::AddressTable<net::Server::ClientInfo> table;
+    fillMap(table, addresses);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        table.erase(addresses[i]);
+        table[addresses[i]].lastPacketTime = i;
+        i = (i + 1 == addresses.size()) ? 0 : i + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void distributions(benchmark::internal::Benchmark* bench) {
+    bench->ArgName("distribution");
+    for (int d = SEQUENTIAL_PORTS; d <= RANDOM; ++d)
+        bench->Arg(d);
+}
+
+}  // namespace
+
+BENCHMARK(BM_AddressTableLookup)->Apply(distributions);
+BENCHMARK(BM_UnorderedMapLookup<std::hash<net::Address>>)->Apply(distributions);
+BENCHMARK(BM_UnorderedMapLookup<LegacyAddressHash>)->Apply(distributions);
+BENCHMARK(BM_AddressTableChurn)->Apply(distributions);
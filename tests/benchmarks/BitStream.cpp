@@ -0,0 +1,66 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** BitStream.cpp
+*/
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include "Network/BitStream.hpp"
+
+// Bit fields of the generated messages: 1024 values of the argument's width
+// written by BitWriter, then read back by BitReader.
+
+namespace {
+
+constexpr size_t VALUES = 1024;
+
+void BM_BitWrite(benchmark::State& state) {
+    unsigned bits = static_cast<unsigned>(state.range(0));
+    std::vector<uint8_t> buffer((VALUES * bits + 7) / 8);
+
+    for (auto _ : state) {
+        net::BitWriter writer(buffer.data());
+        for (size_t i = 0; i < VALUES; ++i)
+            writer.write(i * 0x9E3779B97F4A7C15, bits);
+        benchmark::DoNotOptimize(writer.flush());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * VALUES);
+}
+
+void BM_BitRead(benchmark::State& state) {
+    unsigned bits = static_cast<unsigned>(state.range(0));
+    std::vector<uint8_t> buffer((VALUES * bits + 7) / 8, 0x5a);
+
+    for (auto _ : state) {
+        net::BitReader reader(buffer.data(), buffer.size());
+        uint64_t sum = 0;
+        for (size_t i = 0; i < VALUES; ++i)
+            sum += reader.read(bits);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * VALUES);
+}
+
+void BM_Quantize(benchmark::State& state) {
+    std::vector<float> values(VALUES);
+    for (size_t i = 0; i < VALUES; ++i)
+        values[i] = static_cast<float>(i) * 7.9f - 4000.0f;
+
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (float value : values)
+            sum += net::quantize(value, -4096, 4096, 16);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * VALUES);
+}
+
+BENCHMARK(BM_BitWrite)->Arg(1)->Arg(10)->Arg(16)->Arg(33);
+BENCHMARK(BM_BitRead)->Arg(1)->Arg(10)->Arg(16)->Arg(33);
+BENCHMARK(BM_Quantize);
+
+}  // namespace
@@ -0,0 +1,66 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** ByteSwap.cpp
+*/
+
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <vector>
+
+#include "Network/ByteSwap.hpp"
+
+// Numeric arrays of the generated messages: memcpy when the wire matches the
+// host, byteswapCopy otherwise, against the element by element swap. The
+// argument is the element width, over 1024 elements.
+
+namespace {
+
+constexpr size_t ELEMENTS = 1024;
+
+void report(benchmark::State& state, size_t bytes) {
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+void BM_ArrayMemcpy(benchmark::State& state) {
+    size_t bytes = ELEMENTS * state.range(0);
+    std::vector<uint8_t> src(bytes, 0x5a);
+    std::vector<uint8_t> dst(bytes);
+
+    for (auto _ : state) {
+        std::memcpy(dst.data(), src.data(), bytes);
+        benchmark::DoNotOptimize(dst.data());
+    }
+    report(state, bytes);
+}
+
+void BM_ArraySwapScalar(benchmark::State& state) {
+    size_t width = state.range(0);
+    std::vector<uint8_t> src(ELEMENTS * width, 0x5a);
+    std::vector<uint8_t> dst(src.size());
+
+    for (auto _ : state) {
+        net::byteswapCopyScalar(dst.data(), src.data(), ELEMENTS, width);
+        benchmark::DoNotOptimize(dst.data());
+    }
+    report(state, src.size());
+}
+
+void BM_ArraySwap(benchmark::State& state) {
+    size_t width = state.range(0);
+    std::vector<uint8_t> src(ELEMENTS * width, 0x5a);
+    std::vector<uint8_t> dst(src.size());
+
+    for (auto _ : state) {
+        net::byteswapCopy(dst.data(), src.data(), ELEMENTS, width);
+        benchmark::DoNotOptimize(dst.data());
+    }
+    report(state, src.size());
+}
+
+BENCHMARK(BM_ArrayMemcpy)->Arg(2)->Arg(4)->Arg(8);
+BENCHMARK(BM_ArraySwapScalar)->Arg(2)->Arg(4)->Arg(8);
+BENCHMARK(BM_ArraySwap)->Arg(2)->Arg(4)->Arg(8);
+
+}  // namespace
@@ -0,0 +1,266 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Corpus.cpp
+*/
+
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "FuzzProtocols.hpp"
+#include "Network/Server.hpp"
+#include "Network/generated_messages.hpp"
+
+// Throughput over the inputs of the fuzz targets, read exactly as the
+// targets read them: first byte for the protocol (or the message), then the
+// bytes. Valid, truncated and corrupted inputs are mixed, so the cost of the
+// bounds checks and of the error paths shows up next to the happy path.
+//
+// NET_FUZZ_CORPUS=<dir> runs over a libFuzzer corpus instead, one
+// subdirectory per target (UnformatPacket, Framing, Deserialize). Otherwise
+// a synthetic corpus is built.
+
+namespace {
+
+using Corpus = std::vector<std::vector<uint8_t>>;
+
+// letters only, so the payload never contains the end of packet marker
+std::vector<uint8_t> makePayload(size_t size) {
+    std::vector<uint8_t> payload(size);
+
+    for (size_t i = 0; i < size; ++i)
+        payload[i] = static_cast<uint8_t>('a' + i % 26);
+    return payload;
+}
+
+// each input as is, cut in half, and with a byte of its header flipped
+void addVariants(Corpus& corpus, uint8_t selector,
+    const std::vector<uint8_t>& bytes) {
+    std::vector<uint8_t> input = {selector};
+
+    input.insert(input.end(), bytes.begin(), bytes.end());
+    corpus.push_back(input);
+    corpus.emplace_back(input.begin(), input.begin() + input.size() / 2);
+    if (input.size() > 4)
+        input[1 + (input.size() - 1) % 4] ^= 0xFF;
+    corpus.push_back(input);
+}
+
+bool fits(const net::ProtocolManager& protocol, size_t payloadSize) {
+    if (!protocol.getPacketLength().active ||
+        protocol.getPacketLength().length >= 4)
+        return true;
+    return payloadSize + 8 < (1ULL << (8 * protocol.getPacketLength().length));
+}
+
+Corpus readCorpus(const char* target) {
+    Corpus corpus;
+    std::filesystem::path dir =
+        std::filesystem::path(std::getenv("NET_FUZZ_CORPUS")) / target;
+
+    if (!std::filesystem::is_directory(dir))
+        return corpus;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (!entry.is_regular_file())
+            continue;
+        std::ifstream file(entry.path(), std::ios::binary);
+        corpus.emplace_back(std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>());
+    }
+    return corpus;
+}
+
+const Corpus& packetCorpus() {
+    static const Corpus corpus = [] {
+        if (std::getenv("NET_FUZZ_CORPUS"))
+            return readCorpus("UnformatPacket");
+
+        Corpus result;
+        const auto& paths = fuzz::protocolPaths();
+        for (size_t i = 0; i < paths.size(); ++i) {
+            auto protocol = fuzz::makeProtocol(paths[i]);
+            for (size_t size : {16, 200, 1400}) {
+                if (fits(*protocol, size))
+                    addVariants(result, static_cast<uint8_t>(i),
+                        protocol->formatPacket(makePayload(size)));
+            }
+        }
+        return result;
+    }();
+    return corpus;
+}
+
+const Corpus& streamCorpus() {
+    static const Corpus corpus = [] {
+        if (std::getenv("NET_FUZZ_CORPUS"))
+            return readCorpus("Framing");
+
+        Corpus result;
+        const auto& paths = fuzz::protocolPaths();
+        std::mt19937 rng(42);
+        for (size_t i = 0; i < paths.size(); ++i) {
+            auto protocol = fuzz::makeProtocol(paths[i]);
+            // raw stream mode of the Framing target
+            std::vector<uint8_t> stream = {0};
+            for (int packet = 0; packet < 16; ++packet) {
+                auto formatted =
+                    protocol->formatPacket(makePayload(rng() % 200));
+                stream.insert(stream.end(), formatted.begin(),
+                    formatted.end());
+            }
+            addVariants(result, static_cast<uint8_t>(i), stream);
+        }
+        return result;
+    }();
+    return corpus;
+}
+
+template<typename T>
+void deserializeInput(std::span<const uint8_t> data) {
+    try {
+        T message = T::deserialize(data);
+        benchmark::DoNotOptimize(message);
+    } catch (const std::runtime_error&) {
+    }
+}
+
+template<typename T>
+std::vector<uint8_t> serializeDefault() {
+    T message{};
+    return message.serialize();
+}
+
+using Deserialize = void (*)(std::span<const uint8_t>);
+using Serialize = std::vector<uint8_t> (*)();
+
+#define NET_BENCH_DESERIALIZE(name, id) deserializeInput<net::name>,
+const Deserialize DESERIALIZES[] = {
+    NET_GENERATED_MESSAGES(NET_BENCH_DESERIALIZE)
+};
+#undef NET_BENCH_DESERIALIZE
+
+#define NET_BENCH_SERIALIZE(name, id) serializeDefault<net::name>,
+const Serialize SERIALIZES[] = {
+    NET_GENERATED_MESSAGES(NET_BENCH_SERIALIZE)
+};
+#undef NET_BENCH_SERIALIZE
+
+const Corpus& messageCorpus() {
+    static const Corpus corpus = [] {
+        if (std::getenv("NET_FUZZ_CORPUS"))
+            return readCorpus("Deserialize");
+
+        Corpus result;
+        for (size_t i = 0; i < std::size(SERIALIZES); ++i)
+            addVariants(result, static_cast<uint8_t>(i), SERIALIZES[i]());
+        return result;
+    }();
+    return corpus;
+}
+
+size_t totalSize(const Corpus& corpus) {
+    size_t size = 0;
+
+    for (const auto& input : corpus)
+        size += input.size();
+    return size;
+}
+
+void report(benchmark::State& state, const Corpus& corpus,
+    size_t allocations) {
+    double ops = static_cast<double>(state.iterations() * corpus.size());
+
+    state.SetBytesProcessed(state.iterations() * totalSize(corpus));
+    state.SetItemsProcessed(state.iterations() * corpus.size());
+    state.counters["allocs/op"] = benchmark::Counter(
+        ops > 0 ? static_cast<double>(allocations) / ops : 0);
+}
+
+void BM_CorpusUnformatPacket(benchmark::State& state) {
+    const Corpus& corpus = packetCorpus();
+    std::vector<std::unique_ptr<net::ProtocolManager>> protocols;
+    std::vector<uint8_t> packet;
+
+    for (const std::string& path : fuzz::protocolPaths())
+        protocols.push_back(fuzz::makeProtocol(path));
+
+    size_t before = alloc_test::allocationCount();
+    for (auto _ : state) {
+        for (const auto& input : corpus) {
+            const uint8_t* data = input.data();
+            size_t size = input.size();
+            auto& protocol = *protocols[fuzz::pickProtocol(data, size)];
+
+            packet.assign(data, data + size);
+            try {
+                auto unformatted = protocol.unformatPacket(packet);
+                benchmark::DoNotOptimize(unformatted.data.data());
+            } catch (const std::runtime_error&) {
+            }
+        }
+    }
+    report(state, corpus, alloc_test::allocationCount() - before);
+}
+
+void BM_CorpusServerUnpack(benchmark::State& state) {
+    const Corpus& corpus = streamCorpus();
+    std::vector<std::unique_ptr<net::Server>> servers;
+    net::Address from("127.0.0.1", 4242);
+
+    std::ostringstream sink;
+    std::streambuf* old = std::cout.rdbuf(sink.rdbuf());
+    for (const std::string& path : fuzz::protocolPaths())
+        servers.push_back(std::make_unique<net::Server>(0, "UDP", path));
+    std::cout.rdbuf(old);
+
+    size_t before = alloc_test::allocationCount();
+    for (auto _ : state) {
+        for (const auto& input : corpus) {
+            const uint8_t* data = input.data();
+            size_t size = input.size();
+            auto& server = *servers[fuzz::pickProtocol(data, size)];
+            auto& client = server.getUdpClientsRef()[from];
+
+            // skip the mode byte of the Framing target
+            if (size > 0)
+                client.input.assign(data + 1, data + size);
+            auto packets = server.unpack(from, -1);
+            benchmark::DoNotOptimize(packets.data());
+        }
+    }
+    report(state, corpus, alloc_test::allocationCount() - before);
+}
+
+void BM_CorpusDeserialize(benchmark::State& state) {
+    const Corpus& corpus = messageCorpus();
+
+    size_t before = alloc_test::allocationCount();
+    for (auto _ : state) {
+        for (const auto& input : corpus) {
+            if (input.empty())
+                continue;
+            DESERIALIZES[input[0] % std::size(DESERIALIZES)](
+                std::span(input).subspan(1));
+        }
+    }
+    report(state, corpus, alloc_test::allocationCount() - before);
+}
+
+BENCHMARK(BM_CorpusUnformatPacket);
+BENCHMARK(BM_CorpusServerUnpack);
+BENCHMARK(BM_CorpusDeserialize);
+
+}  // namespace
@@ -0,0 +1,79 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Delta.cpp
+*/
+
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <vector>
+
+#include "Network/Delta.hpp"
+#include "Network/generated_messages.hpp"
+
+// PLAYER_UPDATE of config/protocol.json sent every tick, only its position
+// moving: the whole form against the delta from the acknowledged update.
+
+namespace {
+
+net::PLAYER_UPDATE player(uint32_t tick) {
+    net::PLAYER_UPDATE update{};
+    update.player_id = 12;
+    update.pos_x = static_cast<float>(tick % 1000);
+    update.pos_y = 250.0f;
+    update.score = 48000;
+    update.health = 1000;
+    update.alive = 1;
+    std::strcpy(update.name, "benchmark");
+    return update;
+}
+
+void BM_PlayerUpdateWhole(benchmark::State& state) {
+    std::vector<uint8_t> buffer(player(0).serializedSize());
+    uint32_t tick = 0;
+
+    for (auto _ : state) {
+        size_t size = player(tick++).serializeInto(buffer);
+        benchmark::DoNotOptimize(size);
+        state.counters["bytes"] = static_cast<double>(size);
+    }
+}
+
+void BM_PlayerUpdateDelta(benchmark::State& state) {
+    net::DeltaSender<net::PLAYER_UPDATE> sender;
+    std::vector<uint8_t> buffer(player(0).serializedSize());
+    uint32_t tick = 0;
+
+    for (auto _ : state) {
+        // acknowledged one tick late
+        if (tick > 0)
+            sender.acknowledge(static_cast<uint16_t>(tick - 1));
+        size_t size = sender.encodeInto(player(tick++), buffer);
+        benchmark::DoNotOptimize(size);
+        state.counters["bytes"] = static_cast<double>(size);
+    }
+}
+
+void BM_PlayerUpdateDecode(benchmark::State& state) {
+    net::DeltaSender<net::PLAYER_UPDATE> sender;
+    net::DeltaReceiver<net::PLAYER_UPDATE> receiver;
+    std::vector<std::vector<uint8_t>> updates;
+
+    // every update against the first one, decoded over and over
+    receiver.decode(sender.encode(player(0)));
+    sender.acknowledge(0);
+    for (uint32_t tick = 1; tick < 32; ++tick)
+        updates.push_back(sender.encode(player(tick)));
+    for (auto _ : state) {
+        for (const auto& update : updates)
+            benchmark::DoNotOptimize(receiver.decode(update).pos_x);
+    }
+    state.SetItemsProcessed(state.iterations() * updates.size());
+}
+
+BENCHMARK(BM_PlayerUpdateWhole);
+BENCHMARK(BM_PlayerUpdateDelta);
+BENCHMARK(BM_PlayerUpdateDecode);
+
+}  // namespace
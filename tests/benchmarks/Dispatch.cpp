@@ -0,0 +1,86 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Dispatch.cpp
+*/
+
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "FuzzProtocols.hpp"
+#include "Network/MessageProtocol.hpp"
+#include "Network/generated_messages.hpp"
+
+// A formatted CHAT_MESSAGE packet to its handler: getMessageId then
+// unpack<T>, against the generated MessageDispatcher fed with the packet
+// read in place. The argument of BM_Dispatch picks a message handler (0) or
+// a view handler (1).
+
+namespace {
+
+std::vector<uint8_t> makePacket(net::MessageProtocol& messages) {
+    net::CHAT_MESSAGE chat{};
+
+    std::strcpy(chat.content, "hello");
+    std::strcpy(chat.sender, "me");
+    return messages.pack(chat);
+}
+
+void report(benchmark::State& state, size_t bytes, size_t allocations) {
+    double ops = static_cast<double>(state.iterations());
+
+    state.SetBytesProcessed(state.iterations() * bytes);
+    state.counters["allocs/op"] = benchmark::Counter(
+        ops > 0 ? static_cast<double>(allocations) / ops : 0);
+}
+
+void BM_IdThenUnpack(benchmark::State& state) {
+    auto protocol = fuzz::makeProtocol(fuzz::protocolPaths()[0]);
+    net::MessageProtocol messages(*protocol);
+    std::vector<uint8_t> packet = makePacket(messages);
+    size_t handled = 0;
+
+    size_t before = alloc_test::allocationCount();
+    for (auto _ : state) {
+        if (messages.getMessageId(packet) == net::CHAT_MESSAGE::ID) {
+            auto chat = messages.unpack<net::CHAT_MESSAGE>(packet);
+            handled += chat.content[0] != 0;
+        }
+    }
+    benchmark::DoNotOptimize(handled);
+    report(state, packet.size(), alloc_test::allocationCount() - before);
+}
+
+void BM_Dispatch(benchmark::State& state) {
+    auto protocol = fuzz::makeProtocol(fuzz::protocolPaths()[0]);
+    net::MessageProtocol messages(*protocol);
+    net::MessageDispatcher dispatcher;
+    std::vector<uint8_t> packet = makePacket(messages);
+    size_t handled = 0;
+
+    if (state.range(0)) {
+        dispatcher.on<net::CHAT_MESSAGEView>(
+            [&](const net::CHAT_MESSAGEView& chat) {
+                handled += !chat.content().empty();
+            });
+    } else {
+        dispatcher.on<net::CHAT_MESSAGE>([&](const net::CHAT_MESSAGE& chat) {
+            handled += chat.content[0] != 0;
+        });
+    }
+
+    size_t before = alloc_test::allocationCount();
+    for (auto _ : state)
+        messages.dispatch(packet, dispatcher);
+    benchmark::DoNotOptimize(handled);
+    report(state, packet.size(), alloc_test::allocationCount() - before);
+}
+
+BENCHMARK(BM_IdThenUnpack);
+BENCHMARK(BM_Dispatch)->ArgName("view")->Arg(0)->Arg(1);
+
+}  // namespace
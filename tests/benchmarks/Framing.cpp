@@ -0,0 +1,217 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Framing.cpp
+*/
+
+#include <benchmark/benchmark.h>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "ProtocolFile.hpp"
+#include "Network/Client.hpp"
+#include "Network/ProtocolManager.hpp"
+#include "Network/Server.hpp"
+
+namespace {
+
+// packets per framing iteration, as if received in a single read
+constexpr size_t BATCH = 16;
+// MTU sized payload last, only for length fields wide enough to hold it
+const std::vector<size_t> PAYLOAD_SIZES = {16, 200, 1400};
+
+struct Config {
+    std::string name;
+    std::string path;
+    int lengthBytes;
+    bool datetime;
+};
+
+/**
+ * @brief Write a protocol.json for every combination of the framing options
+ *
+ * Combinations without packet length nor end of packet can't be framed out
+ * of a stream and are left out.
+ */
+std::vector<Config> makeConfigs() {
+    std::vector<Config> configs;
+
+    for (int big = 0; big <= 1; ++big)
+    for (int preamble = 0; preamble <= 1; ++preamble)
+    for (int length : {0, 1, 2, 4})
+    for (int datetime = 0; datetime <= 1; ++datetime)
+    for (int end = 0; end <= 1; ++end) {
+        if (length == 0 && !end)
+            continue;
+
+        std::string name = std::string(preamble ? "pre_" : "") +
+            (length ? "len" + std::to_string(length) + "_" : "") +
+            (datetime ? "dt_" : "") + (end ? "eop_" : "") +
+            (big ? "be" : "le");
+        std::string path = test_support::writeProtocol(
+            "net_benchmarks/" + name + ".json", {big != 0, preamble != 0,
+            length, datetime != 0, end != 0});
+        configs.push_back({name, path, length, datetime != 0});
+    }
+    return configs;
+}
+
+bool fits(const Config& config, size_t payloadSize) {
+    if (config.lengthBytes == 0 || config.lengthBytes == 4)
+        return true;
+    size_t total = payloadSize + (config.datetime ? 8 : 0);
+    return total < (1ULL << (8 * config.lengthBytes));
+}
+
+// letters only, so the payload never contains the end of packet marker
+std::vector<uint8_t> makePayload(size_t size) {
+    std::vector<uint8_t> payload(size);
+
+    for (size_t i = 0; i < size; ++i)
+        payload[i] = static_cast<uint8_t>('a' + i % 26);
+    return payload;
+}
+
+// ProtocolManager prints the loaded configuration, keep the report readable
+template<typename T, typename... Args>
+std::unique_ptr<T> makeQuiet(Args&&... args) {
+    std::ostringstream sink;
+    std::streambuf* old = std::cout.rdbuf(sink.rdbuf());
+    auto object = std::make_unique<T>(std::forward<Args>(args)...);
+    std::cout.rdbuf(old);
+    return object;
+}
+
+std::vector<uint8_t> makeStream(net::ProtocolManager& protocol,
+    size_t payloadSize) {
+    std::vector<uint8_t> payload = makePayload(payloadSize);
+    std::vector<uint8_t> stream;
+
+    for (size_t i = 0; i < BATCH; ++i) {
+        std::vector<uint8_t> packet = protocol.formatPacket(payload);
+        stream.insert(stream.end(), packet.begin(), packet.end());
+    }
+    return stream;
+}
+
+void report(benchmark::State& state, size_t bytesPerIteration,
+    size_t itemsPerIteration, size_t allocations) {
+    double ops = static_cast<double>(state.iterations() * itemsPerIteration);
+
+    state.SetBytesProcessed(state.iterations() * bytesPerIteration);
+    state.SetItemsProcessed(state.iterations() * itemsPerIteration);
+    state.counters["allocs/op"] = benchmark::Counter(
+        ops > 0 ? static_cast<double>(allocations) / ops : 0);
+}
+
+void BM_FormatPacket(benchmark::State& state, const Config& config,
+    size_t payloadSize) {
+    auto protocol = makeQuiet<net::ProtocolManager>(config.path);
+    std::vector<uint8_t> payload = makePayload(payloadSize);
+
+    size_t before = alloc_test::allocationCount();
+    for (auto _ : state) {
+        std::vector<uint8_t> packet = protocol->formatPacket(payload);
+        benchmark::DoNotOptimize(packet.data());
+    }
+    report(state, payloadSize, 1, alloc_test::allocationCount() - before);
+}
+
+void BM_FormatPacketInto(benchmark::State& state, const Config& config,
+    size_t payloadSize) {
+    auto protocol = makeQuiet<net::ProtocolManager>(config.path);
+    std::vector<uint8_t> payload = makePayload(payloadSize);
+    std::vector<uint8_t> packet;
+
+    size_t before = alloc_test::allocationCount();
+    for (auto _ : state) {
+        protocol->formatPacketInto(payload, packet);
+        benchmark::DoNotOptimize(packet.data());
+    }
+    report(state, payloadSize, 1, alloc_test::allocationCount() - before);
+}
+
+void BM_UnformatPacket(benchmark::State& state, const Config& config,
+    size_t payloadSize) {
+    auto protocol = makeQuiet<net::ProtocolManager>(config.path);
+    std::vector<uint8_t> packet =
+        protocol->formatPacket(makePayload(payloadSize));
+
+    size_t before = alloc_test::allocationCount();
+    for (auto _ : state) {
+        auto unformatted = protocol->unformatPacket(packet);
+        benchmark::DoNotOptimize(unformatted.data.data());
+    }
+    report(state, packet.size(), 1, alloc_test::allocationCount() - before);
+}
+
+void BM_ServerUnpack(benchmark::State& state, const Config& config,
+    size_t payloadSize) {
+    auto protocol = makeQuiet<net::ProtocolManager>(config.path);
+    std::vector<uint8_t> stream = makeStream(*protocol, payloadSize);
+    auto server = makeQuiet<net::Server>(0, "UDP", config.path);
+    net::Address from("127.0.0.1", 4242);
+    net::Server::ClientInfo& client = server->getUdpClientsRef()[from];
+
+    size_t before = alloc_test::allocationCount();
+    for (auto _ : state) {
+        client.input.assign(stream.begin(), stream.end());
+        auto packets = server->unpack(from, -1);
+        benchmark::DoNotOptimize(packets.data());
+    }
+    report(state, stream.size(), BATCH, alloc_test::allocationCount() - before);
+}
+
+void BM_ClientExtractPackets(benchmark::State& state, const Config& config,
+    size_t payloadSize) {
+    auto protocol = makeQuiet<net::ProtocolManager>(config.path);
+    std::vector<uint8_t> stream = makeStream(*protocol, payloadSize);
+    auto client = makeQuiet<net::Client>("UDP", config.path);
+    std::vector<uint8_t>& input = client->getInputBufferRef();
+
+    size_t before = alloc_test::allocationCount();
+    for (auto _ : state) {
+        input.assign(stream.begin(), stream.end());
+        auto packets = client->extractPacketsFromBuffer();
+        benchmark::DoNotOptimize(packets.data());
+    }
+    report(state, stream.size(), BATCH, alloc_test::allocationCount() - before);
+}
+
+using Function = void (*)(benchmark::State&, const Config&, size_t);
+
+bool registerFramingBenchmarks() {
+    static const std::vector<Config> configs = makeConfigs();
+    const std::pair<const char*, Function> functions[] = {
+        {"BM_FormatPacket", BM_FormatPacket},
+        {"BM_FormatPacketInto", BM_FormatPacketInto},
+        {"BM_UnformatPacket", BM_UnformatPacket},
+        {"BM_ServerUnpack", BM_ServerUnpack},
+        {"BM_ClientExtractPackets", BM_ClientExtractPackets},
+    };
+
+    for (auto& [prefix, function] : functions) {
+        for (const Config& config : configs) {
+            for (size_t size : PAYLOAD_SIZES) {
+                if (!fits(config, size))
+                    continue;
+                std::string name = std::string(prefix) + "/" + config.name +
+                    "/" + std::to_string(size);
+                // 800 odd cases, keep a full run in the minute range
+                benchmark::RegisterBenchmark(name.c_str(), function,
+                    config, size)->MinTime(0.1);
+            }
+        }
+    }
+    return true;
+}
+
+[[maybe_unused]] const bool registered = registerFramingBenchmarks();
+
+}  // namespace
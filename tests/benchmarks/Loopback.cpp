@@ -0,0 +1,323 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Loopback.cpp
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Network/Client.hpp"
+#include "Network/LatencyHistogram.hpp"
+#include "Network/Server.hpp"
+
+/*
+** End to end benchmark over 127.0.0.1: a Server echoes every packet back to
+** N Clients, which timestamp what they send and record the round trip time.
+**
+** With a rate, each client sends at fixed intervals and the round trip is
+** measured from the time the packet was due, so a stalled loop shows up in
+** the latencies instead of silently sending less (coordinated omission).
+** Without a rate, each client waits for its echo before sending again, or
+** for the timeout when it was lost.
+*/
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// send time and sequence number, the rest of the payload is padding
+constexpr size_t HEADER_SIZE = 16;
+
+struct Options {
+    std::string mode = "both";
+    std::string config = "config/protocol.json";
+    uint16_t port = 4250;
+    size_t clients = 4;
+    size_t size = 64;
+    uint64_t rate = 1000;
+    double duration = 5;
+    uint64_t timeout = 500;
+    bool logging = false;
+};
+
+struct Result {
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    // ping-pong requests given up after the timeout
+    uint64_t expired = 0;
+    // packets the server failed to unpack or send back
+    uint64_t drops = 0;
+    double elapsed = 0;
+    net::LatencyHistogram rtt;
+};
+
+void usage() {
+    std::cout
+        << "USAGE: NET_loopback [options]\n"
+        << "    --mode udp|tcp|both    Protocol to measure (both)\n"
+        << "    --clients N            Number of clients (4)\n"
+        << "    --size BYTES           Payload size, at least "
+        << HEADER_SIZE << " (64)\n"
+        << "    --rate N               Packets per second per client,"
+        << " 0 for ping-pong (1000)\n"
+        << "    --duration SECONDS     Sending time (5)\n"
+        << "    --timeout MS           Echo counted as lost after it (500)\n"
+        << "    --port PORT            Server port (4250)\n"
+        << "    --config PATH          protocol.json (config/protocol.json)\n"
+        << "    --logging              Keep Server and Client logs\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--logging") {
+            options.logging = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            return false;
+        std::string value = argv[++i];
+        if (arg == "--mode")
+            options.mode = value;
+        else if (arg == "--clients")
+            options.clients = std::stoul(value);
+        else if (arg == "--size")
+            options.size = std::stoul(value);
+        else if (arg == "--rate")
+            options.rate = std::stoull(value);
+        else if (arg == "--duration")
+            options.duration = std::stod(value);
+        else if (arg == "--timeout")
+            options.timeout = std::stoull(value);
+        else if (arg == "--port")
+            options.port = static_cast<uint16_t>(std::stoul(value));
+        else if (arg == "--config")
+            options.config = value;
+        else
+            return false;
+    }
+    return options.clients > 0 && options.size >= HEADER_SIZE &&
+        options.size <= BUFSIZ &&
+        (options.mode == "udp" || options.mode == "tcp" ||
+        options.mode == "both");
+}
+
+uint64_t nanoseconds(Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        time.time_since_epoch()).count();
+}
+
+// ProtocolManager and Client print their setup, keep the report readable
+class QuietStdout {
+ public:
+    QuietStdout() : _old(std::cout.rdbuf(_sink.rdbuf())) {}
+    ~QuietStdout() { std::cout.rdbuf(_old); }
+
+ private:
+    std::ostringstream _sink;
+    std::streambuf* _old;
+};
+
+// a packet that fails is a drop, a throw out of the thread would terminate
+template<typename Source>
+void echoFrom(net::Server& server, const Source& from,
+    std::atomic<uint64_t>& drops) {
+    try {
+        for (auto& packet : server.unpack(from, -1)) {
+            try {
+                if constexpr (std::is_same_v<Source, int>)
+                    server.tcpSend(from, packet);
+                else
+                    server.udpSend(from, packet);
+            } catch (const std::exception&) {
+                drops++;
+            }
+        }
+    } catch (const std::exception&) {
+        drops++;
+    }
+}
+
+void echo(net::Server& server, bool tcp, const std::atomic<bool>& stop,
+    std::atomic<uint64_t>& drops) {
+    while (!stop.load(std::memory_order_relaxed)) {
+        try {
+            if (tcp) {
+                for (int fd : server.tcpReceive(1))
+                    echoFrom(server, fd, drops);
+            } else {
+                for (auto& from : server.udpReceive(1, 256))
+                    echoFrom(server, from, drops);
+            }
+        } catch (const std::exception&) {
+            drops++;
+        }
+    }
+}
+
+Result run(const Options& options, bool tcp) {
+    const std::string protocol = tcp ? "TCP" : "UDP";
+    std::unique_ptr<net::Server> server;
+    std::vector<std::unique_ptr<net::Client>> clients;
+    std::atomic<bool> stop = false;
+    std::atomic<uint64_t> drops = 0;
+    Result result;
+
+    {
+        QuietStdout quiet;
+        server = std::make_unique<net::Server>(options.port, protocol,
+            options.config, options.logging);
+        server->start();
+        server->setNonBlocking(true);
+    }
+    std::thread serverThread(echo, std::ref(*server), tcp, std::cref(stop),
+        std::ref(drops));
+
+    {
+        QuietStdout quiet;
+        for (size_t i = 0; i < options.clients; ++i) {
+            clients.push_back(std::make_unique<net::Client>(protocol,
+                options.config, options.logging));
+            clients.back()->connect("127.0.0.1", options.port);
+            clients.back()->setNonBlocking(true);
+        }
+    }
+
+    std::vector<uint8_t> payload(options.size, 0);
+    std::vector<Clock::time_point> nextSend(options.clients);
+    std::vector<uint64_t> inFlight(options.clients, 0);
+    // ping-pong: sequence and send time of the request waited for
+    std::vector<uint64_t> pending(options.clients, 0);
+    std::vector<Clock::time_point> pendingSince(options.clients);
+    auto timeout = std::chrono::milliseconds(options.timeout);
+    uint64_t interval = options.rate ? 1000000000ULL / options.rate : 0;
+    auto start = Clock::now();
+    auto sendEnd = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.duration));
+    // UDP packets still missing after this are counted as lost
+    auto drainEnd = sendEnd + timeout;
+
+    for (auto& next : nextSend)
+        next = start;
+    for (auto now = start; now < drainEnd; now = Clock::now()) {
+        bool sending = now < sendEnd;
+        if (!sending && result.received + result.expired == result.sent)
+            break;
+
+        for (size_t i = 0; i < clients.size(); ++i) {
+            net::Client& client = *clients[i];
+            if (!client.isConnected())
+                continue;
+            // a lost datagram would stall the client for the whole run
+            if (!interval && inFlight[i] > 0
+                && now - pendingSince[i] > timeout) {
+                result.expired += inFlight[i];
+                inFlight[i] = 0;
+            }
+
+            while (sending && (interval ? nextSend[i] <= now
+                : inFlight[i] == 0)) {
+                uint64_t stamp = nanoseconds(interval ? nextSend[i] : now);
+                std::memcpy(payload.data(), &stamp, sizeof(stamp));
+                std::memcpy(payload.data() + 8, &result.sent, 8);
+                if (!client.send(payload))
+                    break;
+                pending[i] = result.sent;
+                pendingSince[i] = now;
+                result.sent++;
+                inFlight[i]++;
+                nextSend[i] += std::chrono::nanoseconds(interval);
+            }
+
+            if (tcp)
+                client.tcpReceive(0);
+            else
+                client.udpReceive(0, 256);
+            uint64_t received = nanoseconds(Clock::now());
+            for (auto& packet : client.extractPacketsFromBuffer()) {
+                uint64_t stamp = 0;
+                uint64_t sequence = 0;
+                if (packet.size() < HEADER_SIZE)
+                    continue;
+                std::memcpy(&stamp, packet.data(), sizeof(stamp));
+                std::memcpy(&sequence, packet.data() + 8, sizeof(sequence));
+                // the late echo of an expired request, already counted
+                if (inFlight[i] == 0 || (!interval && sequence != pending[i]))
+                    continue;
+                result.rtt.record(received - stamp);
+                result.received++;
+                inFlight[i]--;
+            }
+        }
+    }
+    result.elapsed = std::chrono::duration<double>(
+        std::min(Clock::now(), sendEnd) - start).count();
+
+    stop = true;
+    serverThread.join();
+    result.drops = drops.load();
+    {
+        QuietStdout quiet;
+        clients.clear();
+        server.reset();
+    }
+    return result;
+}
+
+void report(const Options& options, bool tcp, const Result& result) {
+    auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+    uint64_t lost = result.sent - result.received;
+    double packets = static_cast<double>(result.received) / result.elapsed;
+    double bytes = packets * static_cast<double>(options.size);
+
+    std::cout << std::fixed << std::setprecision(2)
+        << (tcp ? "TCP" : "UDP") << "\tclients " << options.clients
+        << "\tsize " << options.size << " B\trate "
+        << (options.rate ? std::to_string(options.rate) + "/s"
+            : std::string("ping-pong")) << "\n"
+        << "  sent " << result.sent << "\treceived " << result.received
+        << "\tlost " << lost << " ("
+        << (result.sent ? 100.0 * lost / result.sent : 0) << "%)"
+        << "\texpired " << result.expired << "\tserver drops " << result.drops
+        << "\n"
+        << "  throughput " << bytes / (1024 * 1024) << " MiB/s\t"
+        << packets << " packets/s\n"
+        << "  rtt us\tmin " << us(result.rtt.min())
+        << "\tp50 " << us(result.rtt.percentile(50))
+        << "\tp99 " << us(result.rtt.percentile(99))
+        << "\tp999 " << us(result.rtt.percentile(99.9))
+        << "\tmax " << us(result.rtt.max()) << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+
+    try {
+        if (!parseOptions(argc, argv, options)) {
+            usage();
+            return 84;
+        }
+        if (options.mode != "tcp")
+            report(options, false, run(options, false));
+        if (options.mode != "udp")
+            report(options, true, run(options, true));
+    } catch (const std::exception& e) {
+        std::cerr << "NET_loopback: " << e.what() << std::endl;
+        return 84;
+    }
+    return 0;
+}
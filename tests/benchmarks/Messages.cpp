@@ -0,0 +1,133 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Messages.cpp
+*/
+
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "Network/generated_messages.hpp"
+
+// Generated serialize / serializeInto / deserialize of every message of the
+// protocol.
+
+namespace {
+
+// every byte set when the message is plain data, so nothing compresses to
+// nothing, otherwise zeroed with empty arrays
+template<typename T>
+T makeMessage() {
+    T message{};
+
+    if constexpr (std::is_trivially_copyable_v<T>)
+        std::memset(static_cast<void*>(&message), 'a', sizeof(T));
+    return message;
+}
+
+void report(benchmark::State& state, size_t bytes, size_t allocations) {
+    double ops = static_cast<double>(state.iterations());
+
+    state.SetBytesProcessed(state.iterations() * bytes);
+    state.counters["allocs/op"] = benchmark::Counter(
+        ops > 0 ? static_cast<double>(allocations) / ops : 0);
+}
+
+template<typename T>
+void BM_Serialize(benchmark::State& state) {
+    T message = makeMessage<T>();
+    size_t size = message.serialize().size();
+
+    size_t before = alloc_test::allocationCount();
+    for (auto _ : state) {
+        std::vector<uint8_t> bytes = message.serialize();
+        benchmark::DoNotOptimize(bytes.data());
+    }
+    report(state, size, alloc_test::allocationCount() - before);
+}
+
+template<typename T>
+void BM_SerializeInto(benchmark::State& state) {
+    T message = makeMessage<T>();
+    std::vector<uint8_t> buffer(message.serializedSize());
+    size_t size = message.serializeInto(buffer);
+
+    size_t before = alloc_test::allocationCount();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(message.serializeInto(buffer));
+        benchmark::ClobberMemory();
+    }
+    report(state, size, alloc_test::allocationCount() - before);
+}
+
+template<typename T>
+void BM_Deserialize(benchmark::State& state) {
+    std::vector<uint8_t> bytes = makeMessage<T>().serialize();
+
+    size_t before = alloc_test::allocationCount();
+    for (auto _ : state) {
+        T message = T::deserialize(bytes);
+        benchmark::DoNotOptimize(message);
+    }
+    report(state, bytes.size(), alloc_test::allocationCount() - before);
+}
+
+// checks the bytes, reads nothing
+template<typename T>
+void BM_View(benchmark::State& state) {
+    std::vector<uint8_t> bytes = makeMessage<T>().serialize();
+
+    size_t before = alloc_test::allocationCount();
+    for (auto _ : state) {
+        typename T::View view(bytes);
+        benchmark::DoNotOptimize(view);
+    }
+    report(state, bytes.size(), alloc_test::allocationCount() - before);
+}
+
+// what a router does: one field out of the message
+void BM_PeekField(benchmark::State& state) {
+    std::vector<uint8_t> bytes = makeMessage<net::LOGIN_REQUEST>().serialize();
+
+    size_t before = alloc_test::allocationCount();
+    for (auto _ : state) {
+        if (state.range(0))
+            benchmark::DoNotOptimize(
+                net::LOGIN_REQUEST::View(bytes).client_version());
+        else
+            benchmark::DoNotOptimize(
+                net::LOGIN_REQUEST::deserialize(bytes).client_version);
+    }
+    report(state, bytes.size(), alloc_test::allocationCount() - before);
+}
+
+BENCHMARK(BM_PeekField)->ArgName("view")->Arg(0)->Arg(1);
+
+template<typename T>
+void registerView(const char* name) {
+    if constexpr (requires { typename T::View; })
+        benchmark::RegisterBenchmark(name, BM_View<T>);
+}
+
+bool registerMessageBenchmarks() {
+#define NET_BENCH_MESSAGE(name, id) \
+    benchmark::RegisterBenchmark("BM_Serialize/" #name, \
+        BM_Serialize<net::name>); \
+    benchmark::RegisterBenchmark("BM_SerializeInto/" #name, \
+        BM_SerializeInto<net::name>); \
+    benchmark::RegisterBenchmark("BM_Deserialize/" #name, \
+        BM_Deserialize<net::name>); \
+    registerView<net::name>("BM_View/" #name);
+    NET_GENERATED_MESSAGES(NET_BENCH_MESSAGE)
+#undef NET_BENCH_MESSAGE
+    return true;
+}
+
+[[maybe_unused]] const bool registered = registerMessageBenchmarks();
+
+}  // namespace
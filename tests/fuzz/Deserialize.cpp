@@ -0,0 +1,78 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Deserialize.cpp
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "Network/generated_messages.hpp"
+
+namespace {
+
+// The view of a message accepts the same bytes as deserialize and spans
+// exactly what serialize writes back, message ID aside.
+template<typename T>
+void checkView(std::span<const uint8_t> data, const T* message) {
+    if constexpr (requires { typename T::View; }) {
+        try {
+            typename T::View view(data);
+            if (!message)
+                std::abort();
+            std::vector<uint8_t> bytes = message->serialize();
+            if (view.bytes().size() != bytes.size() ||
+                !std::equal(bytes.begin() + 1, bytes.end(),
+                    view.bytes().begin() + 1))
+                std::abort();
+        } catch (const std::runtime_error&) {
+            if (message)
+                std::abort();
+        }
+    }
+}
+
+// Must throw std::runtime_error or decode a message that serializes, within
+// serializedSize(), to bytes decoding back to the same message.
+template<typename T>
+void roundTrip(std::span<const uint8_t> data) {
+    T message;
+
+    try {
+        message = T::deserialize(data);
+    } catch (const std::runtime_error&) {
+        checkView<T>(data, nullptr);
+        return;
+    }
+    checkView(data, &message);
+    std::vector<uint8_t> bytes = message.serialize();
+    if (bytes.size() > message.serializedSize())
+        std::abort();
+    if (T::deserialize(bytes).serialize() != bytes)
+        std::abort();
+}
+
+using RoundTrip = void (*)(std::span<const uint8_t>);
+
+#define NET_FUZZ_ROUND_TRIP(name, id) roundTrip<net::name>,
+const RoundTrip ROUND_TRIPS[] = {
+    NET_GENERATED_MESSAGES(NET_FUZZ_ROUND_TRIP)
+};
+#undef NET_FUZZ_ROUND_TRIP
+
+}  // namespace
+
+// Every generated deserialize, the first byte picks the message.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    constexpr size_t count = std::size(ROUND_TRIPS);
+
+    if (size == 0)
+        return 0;
+    ROUND_TRIPS[data[0] % count](std::span(data + 1, size - 1));
+    return 0;
+}
@@ -0,0 +1,130 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Framing.cpp
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "FuzzProtocols.hpp"
+#include "Network/Client.hpp"
+#include "Network/Server.hpp"
+
+namespace {
+
+struct Framers {
+    std::unique_ptr<net::Server> server;
+    std::unique_ptr<net::Client> client;
+};
+
+Framers& framers(size_t index) {
+    static std::vector<Framers> all(fuzz::protocolPaths().size());
+    Framers& framers = all[index];
+
+    if (!framers.server) {
+        const std::string& path = fuzz::protocolPaths()[index];
+        std::ostringstream sink;
+        std::streambuf* old = std::cout.rdbuf(sink.rdbuf());
+        framers.server = std::make_unique<net::Server>(0, "UDP", path);
+        framers.client = std::make_unique<net::Client>("UDP", path);
+        std::cout.rdbuf(old);
+    }
+    return framers;
+}
+
+// Well formed stream: the input cut in payloads of at most 63 bytes, each one
+// formatted by the protocol. Carriage returns are dropped so a payload never
+// holds the end of packet marker.
+std::vector<std::vector<uint8_t>> makePayloads(const uint8_t* data,
+    size_t size) {
+    std::vector<std::vector<uint8_t>> payloads;
+
+    while (size > 0) {
+        size_t length = std::min<size_t>(data[0] % 64, size - 1);
+        std::vector<uint8_t> payload(data + 1, data + 1 + length);
+        std::erase(payload, '\r');
+        payloads.push_back(std::move(payload));
+        data += length + 1;
+        size -= length + 1;
+    }
+    return payloads;
+}
+
+}  // namespace
+
+// The stream framers of Server (unpack) and Client (extractPacketsFromBuffer)
+// fed the same bytes, cut in reads of fuzzed sizes. Neither may read out of
+// bounds and both must hand out the same packets. The byte after the protocol
+// selects a raw stream or a well formed one, which must come out as exactly
+// the payloads that went in, each one once.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    size_t index = fuzz::pickProtocol(data, size);
+    Framers& f = framers(index);
+    net::Address from("127.0.0.1", 4242);
+    net::Server::ClientInfo& info = f.server->getUdpClientsRef()[from];
+    std::vector<uint8_t>& clientInput = f.client->getInputBufferRef();
+    std::vector<std::vector<uint8_t>> serverPackets;
+    std::vector<std::vector<uint8_t>> clientPackets;
+    std::vector<std::vector<uint8_t>> payloads;
+    std::vector<uint8_t> stream;
+
+    if (size == 0)
+        return 0;
+    bool wellFormed = data[0] % 2 == 1;
+    if (wellFormed) {
+        static std::vector<std::unique_ptr<net::ProtocolManager>> protocols(
+            fuzz::protocolPaths().size());
+        if (!protocols[index])
+            protocols[index] = fuzz::makeProtocol(fuzz::protocolPaths()[index]);
+
+        payloads = makePayloads(data + 1, size - 1);
+        for (const auto& payload : payloads) {
+            std::vector<uint8_t> packet =
+                protocols[index]->formatPacket(payload);
+            stream.insert(stream.end(), packet.begin(), packet.end());
+        }
+    } else {
+        stream.assign(data + 1, data + size);
+    }
+
+    info.input.clear();
+    clientInput.clear();
+    // read sizes cycle over the input bytes
+    for (size_t offset = 0, read = 0; offset < stream.size(); ++read) {
+        size_t chunk = std::min<size_t>(data[read % size] % 64 + 1,
+            stream.size() - offset);
+        info.input.insert(info.input.end(), stream.begin() + offset,
+            stream.begin() + offset + chunk);
+        clientInput.insert(clientInput.end(), stream.begin() + offset,
+            stream.begin() + offset + chunk);
+        offset += chunk;
+
+        // every packet takes at least a byte, a framer handing out more
+        // packets than that repeats one
+        for (size_t round = 0;; ++round) {
+            auto packets = f.server->unpack(from, -1);
+            if (packets.empty())
+                break;
+            if (round > stream.size())
+                std::abort();
+            serverPackets.insert(serverPackets.end(),
+                packets.begin(), packets.end());
+        }
+        auto packets = f.client->extractPacketsFromBuffer();
+        clientPackets.insert(clientPackets.end(),
+            packets.begin(), packets.end());
+    }
+
+    if (serverPackets != clientPackets || info.input != clientInput)
+        std::abort();
+    if (wellFormed && (serverPackets != payloads || !info.input.empty()))
+        std::abort();
+    return 0;
+}
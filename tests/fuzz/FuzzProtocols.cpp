@@ -0,0 +1,54 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** FuzzProtocols.cpp
+*/
+
+#include <iostream>
+#include <sstream>
+
+#include "FuzzProtocols.hpp"
+#include "ProtocolFile.hpp"
+
+namespace fuzz {
+
+const std::vector<std::string>& protocolPaths() {
+    static const std::vector<std::string> paths = [] {
+        std::vector<std::string> result;
+
+        for (int big = 0; big <= 1; ++big)
+        for (int preamble = 0; preamble <= 1; ++preamble)
+        for (int length : {0, 1, 2, 4})
+        for (int datetime = 0; datetime <= 1; ++datetime)
+        for (int end = 0; end <= 1; ++end) {
+            if (length == 0 && !end)
+                continue;
+
+            result.push_back(test_support::writeProtocol("net_fuzz/protocol_" +
+                std::to_string(result.size()) + ".json", {big != 0,
+                preamble != 0, length, datetime != 0, end != 0}));
+        }
+        return result;
+    }();
+    return paths;
+}
+
+size_t pickProtocol(const uint8_t*& data, size_t& size) {
+    if (size == 0)
+        return 0;
+    size_t index = data[0] % protocolPaths().size();
+    data++;
+    size--;
+    return index;
+}
+
+std::unique_ptr<net::ProtocolManager> makeProtocol(const std::string& path) {
+    std::ostringstream sink;
+    std::streambuf* old = std::cout.rdbuf(sink.rdbuf());
+    auto protocol = std::make_unique<net::ProtocolManager>(path);
+    std::cout.rdbuf(old);
+    return protocol;
+}
+
+}  // namespace fuzz
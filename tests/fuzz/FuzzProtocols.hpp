@@ -0,0 +1,47 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** FuzzProtocols.hpp
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Network/ProtocolManager.hpp"
+
+namespace fuzz {
+
+/**
+ * @brief protocol.json files for every combination of the framing options
+ *
+ * Written once in the temp directory. Combinations without packet length
+ * nor end of packet can't be framed out of a stream and are left out.
+ *
+ * @return const std::vector<std::string>& Paths of the files
+ */
+const std::vector<std::string>& protocolPaths();
+
+/**
+ * @brief Pick a protocol from the first byte of a fuzz input
+ *
+ * @param data Fuzz input, the byte used is removed from it
+ * @param size Size of the input, decremented
+ * @return size_t Index in protocolPaths()
+ */
+size_t pickProtocol(const uint8_t*& data, size_t& size);
+
+/**
+ * @brief Build an object reading a protocol.json without its console report
+ *
+ * ProtocolManager prints the loaded configuration, which would flood the
+ * fuzzer output.
+ */
+std::unique_ptr<net::ProtocolManager> makeProtocol(const std::string& path);
+
+}  // namespace fuzz
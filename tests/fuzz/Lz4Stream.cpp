@@ -0,0 +1,59 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Lz4Stream.cpp
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <span>
+#include <vector>
+
+#include "Network/Lz4.hpp"
+
+// StreamDecoder fed the bytes of a TCP connection, cut in reads of fuzzed
+// sizes. The first byte selects raw bytes, which may only be refused, or a
+// stream written by a StreamEncoder, which must come out as it went in.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    net::lz4::StreamDecoder decoder;
+    std::vector<uint8_t> sent;
+    std::vector<uint8_t> stream;
+    std::vector<uint8_t> received;
+
+    if (size == 0)
+        return 0;
+    bool wellFormed = data[0] % 2 == 1;
+    if (wellFormed) {
+        net::lz4::StreamEncoder encoder(data[0] % 4 == 3 ? 9 : 0);
+        // the input cut in packets, each one repeated to give LZ4 matches
+        for (size_t offset = 1; offset < size;) {
+            size_t length = std::min<size_t>(data[offset] % 64 + 1,
+                size - offset);
+            std::span<const uint8_t> packet(data + offset, length);
+            for (int i = 0; i < data[offset] % 3 + 1; ++i) {
+                sent.insert(sent.end(), packet.begin(), packet.end());
+                encoder.compress(packet, stream);
+            }
+            offset += length;
+        }
+    } else {
+        stream.assign(data + 1, data + size);
+    }
+
+    bool valid = true;
+    for (size_t offset = 0, read = 0; offset < stream.size(); ++read) {
+        size_t chunk = std::min<size_t>(data[read % size] % 64 + 1,
+            stream.size() - offset);
+        valid = decoder.decompress(std::span(stream).subspan(offset, chunk),
+            received) && valid;
+        offset += chunk;
+    }
+
+    // a block decompresses to a block at most
+    if (received.size() > stream.size() * 255 + net::lz4::STREAM_BLOCK_SIZE)
+        std::abort();
+    if (wellFormed && (!valid || received != sent || decoder.pending() != 0))
+        std::abort();
+    return 0;
+}
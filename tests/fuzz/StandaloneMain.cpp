@@ -0,0 +1,69 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** StandaloneMain.cpp
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+// Driver for compilers without libFuzzer: runs the target over the given
+// files and directories (a corpus, a crash reproducer), and over random
+// inputs with -runs=N. It doesn't mutate, use a Clang build to fuzz.
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+static void runFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> input((std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>());
+
+    LLVMFuzzerTestOneInput(input.data(), input.size());
+}
+
+static void runRandom(size_t runs) {
+    std::mt19937 rng(42);
+    std::vector<uint8_t> input;
+
+    for (size_t i = 0; i < runs; ++i) {
+        input.resize(rng() % 512);
+        for (uint8_t& byte : input)
+            byte = static_cast<uint8_t>(rng());
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "USAGE: " << argv[0]
+            << " [-runs=N] [file or directory]..." << std::endl;
+        return 84;
+    }
+    for (int i = 1; i < argc; ++i) {
+        std::filesystem::path arg = argv[i];
+
+        if (std::strncmp(argv[i], "-runs=", 6) == 0) {
+            runRandom(std::stoul(argv[i] + 6));
+        } else if (std::filesystem::is_directory(arg)) {
+            for (const auto& entry :
+                std::filesystem::directory_iterator(arg)) {
+                if (entry.is_regular_file())
+                    runFile(entry.path());
+            }
+        } else if (std::filesystem::exists(arg)) {
+            runFile(arg);
+        } else {
+            std::cerr << argv[i] << ": no such file" << std::endl;
+            return 84;
+        }
+    }
+    return 0;
+}
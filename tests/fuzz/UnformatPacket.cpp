@@ -0,0 +1,45 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** UnformatPacket.cpp
+*/
+
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "FuzzProtocols.hpp"
+
+// ProtocolManager::unformatPacket over any protocol and any bytes: it must
+// either throw std::runtime_error or return data that formats back to a
+// packet carrying the same data.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static std::vector<std::unique_ptr<net::ProtocolManager>> protocols;
+    if (protocols.empty()) {
+        for (const std::string& path : fuzz::protocolPaths())
+            protocols.push_back(fuzz::makeProtocol(path));
+    }
+
+    net::ProtocolManager& protocol = *protocols[fuzz::pickProtocol(data, size)];
+    std::vector<uint8_t> packet(data, data + size);
+    net::ProtocolManager::UnformattedPacket unformatted;
+
+    try {
+        unformatted = protocol.unformatPacket(packet);
+    } catch (const std::runtime_error&) {
+        return 0;
+    }
+    // a length field too narrow for the data can't round trip
+    if (protocol.getPacketLength().active &&
+        unformatted.data.size() + 8 >=
+        (1ULL << (8 * protocol.getPacketLength().length)))
+        return 0;
+
+    std::vector<uint8_t> again =
+        protocol.unformatPacket(protocol.formatPacket(unformatted.data)).data;
+    if (again != unformatted.data)
+        std::abort();
+    return 0;
+}
@@ -0,0 +1,39 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** AllocationCounter.hpp
+*/
+
+#pragma once
+
+#include <cstddef>
+
+namespace alloc_test {
+
+/**
+ * @brief Number of calls to the global operator new since the program start
+ *
+ * Linking AllocationCounter.cpp replaces every global operator new, aligned
+ * and nothrow ones included, so every heap allocation of the test or
+ * benchmark binary is counted (compare counts around the measured code).
+ *
+ * @return size_t
+ */
+size_t allocationCount();
+
+/**
+ * @brief Count the heap allocations made by a callable
+ *
+ * @tparam F Callable without parameter
+ * @param f Code to measure, run once
+ * @return size_t Allocations made while it ran
+ */
+template<typename F>
+size_t countAllocations(F&& f) {
+    size_t before = allocationCount();
+    f();
+    return allocationCount() - before;
+}
+
+}  // namespace alloc_test
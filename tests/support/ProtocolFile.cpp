@@ -0,0 +1,41 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** ProtocolFile.cpp
+*/
+
+#include <filesystem>
+#include <fstream>
+
+#include "ProtocolFile.hpp"
+
+namespace test_support {
+
+std::string writeProtocol(const std::string& name,
+    const FramingOptions& options) {
+    std::filesystem::path path =
+        std::filesystem::temp_directory_path() / name;
+    auto flag = [](bool on) { return on ? "true" : "false"; };
+
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream file(path);
+    file << "{\n"
+         << "  \"endianness\": \""
+         << (options.bigEndian ? "big" : "little") << "\",\n"
+         << "  \"preambule\": { \"active\": " << flag(options.preamble)
+         << ", \"characters\": \"\\r\\t\\r\\t\" },\n"
+         << "  \"packet_length\": { \"active\": "
+         << flag(options.packetLength != 0) << ", \"length\": "
+         << (options.packetLength ? options.packetLength : 4) << " },\n"
+         << "  \"datetime\": { \"active\": " << flag(options.datetime)
+         << ", \"length\": 8 },\n"
+         << "  \"end_of_packet\": { \"active\": " << flag(options.endOfPacket)
+         << ", \"characters\": \"\\r\\n\" },\n"
+         << "  \"stream_compression\": { \"active\": "
+         << flag(options.streamCompression) << " }\n"
+         << "}\n";
+    return path.string();
+}
+
+}  // namespace test_support
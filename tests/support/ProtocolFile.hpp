@@ -0,0 +1,39 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** ProtocolFile.hpp
+*/
+
+#pragma once
+
+#include <string>
+
+namespace test_support {
+
+/**
+ * @brief Framing options of a protocol.json written by writeProtocol
+ *
+ * The defaults turn every part of the framing on, little endian.
+ */
+struct FramingOptions {
+    bool bigEndian = false;
+    bool preamble = true;     // "\r\t\r\t"
+    int packetLength = 4;     // bytes of the length, 0 when inactive
+    bool datetime = true;     // 8 bytes
+    bool endOfPacket = true;  // "\r\n"
+    bool streamCompression = false;
+};
+
+/**
+ * @brief Write a protocol.json in the temp directory
+ *
+ * @param name File name, relative to the temp directory, its directories
+ * are created
+ * @param options Framing of the packets
+ * @return std::string Path of the file
+ */
+std::string writeProtocol(const std::string& name,
+    const FramingOptions& options = {});
+
+}  // namespace test_support
@@ -0,0 +1,60 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** AddressTable.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <unordered_map>
+
+#include "Network/AddressTable.hpp"
+
+TEST(ADDRESS_TABLE, insert_find_erase) {
+    net::AddressTable<int> table;
+    net::Address a("127.0.0.1", 4000);
+    net::Address b("127.0.0.1", 4001);
+
+    EXPECT_EQ(nullptr, table.find(a));
+    EXPECT_TRUE(table.tryEmplace(a).second);
+    EXPECT_FALSE(table.tryEmplace(a).second);
+    table[b] = 2;
+    *table.find(a) = 1;
+
+    EXPECT_EQ(2u, table.size());
+    EXPECT_EQ(1, *table.find(a));
+    EXPECT_EQ(2, *table.find(b));
+    EXPECT_TRUE(table.erase(a));
+    EXPECT_FALSE(table.erase(a));
+    EXPECT_EQ(nullptr, table.find(a));
+    EXPECT_EQ(2, *table.find(b));
+}
+
+// same NAT IP, sequential ports, with erases in the middle of probe chains
+TEST(ADDRESS_TABLE, matches_unordered_map_under_churn) {
+    net::AddressTable<uint32_t> table;
+    std::unordered_map<net::Address, uint32_t> reference;
+
+    for (uint32_t i = 0; i < 20000; ++i) {
+        net::Address addr(0x0A000001, static_cast<uint16_t>(i * 7));
+        table[addr] = i;
+        reference[addr] = i;
+        if (i % 3 == 0) {
+            net::Address old(0x0A000001, static_cast<uint16_t>((i / 2) * 7));
+            EXPECT_EQ(reference.erase(old) == 1, table.erase(old));
+        }
+    }
+
+    ASSERT_EQ(reference.size(), table.size());
+    for (auto& [addr, value] : reference) {
+        ASSERT_NE(nullptr, table.find(addr));
+        EXPECT_EQ(value, *table.find(addr));
+    }
+
+    size_t visited = 0;
+    for (auto& entry : table) {
+        EXPECT_EQ(reference.at(entry.address), entry.value);
+        ++visited;
+    }
+    EXPECT_EQ(reference.size(), visited);
+}
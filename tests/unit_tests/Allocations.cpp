@@ -0,0 +1,225 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Allocations.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "ProtocolFile.hpp"
+#include "Network/Client.hpp"
+#include "Network/MessageProtocol.hpp"
+#include "Network/ProtocolManager.hpp"
+#include "Network/Server.hpp"
+#include "Network/generated_messages.hpp"
+
+// Upper bounds of heap allocations per operation. A change that adds one
+// to a hot path fails here instead of showing up later as jitter.
+
+static std::string writeProtocol() {
+    return test_support::writeProtocol("net_alloc_protocol.json");
+}
+
+static void feed(net::Server& server, const net::Address& address,
+    const std::vector<uint8_t>& payload, int packets) {
+    net::ProtocolManager protocol(writeProtocol());
+    auto& input = server.getUdpClientsRef().tryEmplace(address).first->input;
+
+    for (int i = 0; i < packets; ++i) {
+        std::vector<uint8_t> packet = protocol.formatPacket(payload);
+        input.insert(input.end(), packet.begin(), packet.end());
+    }
+}
+
+TEST(ALLOCATIONS, counter_sees_allocations) {
+    std::vector<uint8_t> buffer;
+
+    EXPECT_EQ(alloc_test::countAllocations([&] {
+        buffer.resize(64);
+    }), 1u);
+}
+
+TEST(ALLOCATIONS, format_packet) {
+    net::ProtocolManager protocol(writeProtocol());
+    std::vector<uint8_t> payload(100, 0x2a);
+    std::vector<uint8_t> buffer;
+
+    protocol.formatPacketInto(payload, buffer);
+    EXPECT_EQ(alloc_test::countAllocations([&] {
+        protocol.formatPacketInto(payload, buffer);
+    }), 0u);
+    EXPECT_LE(alloc_test::countAllocations([&] {
+        buffer = protocol.formatPacket(payload);
+    }), 1u);
+    EXPECT_LE(alloc_test::countAllocations([&] {
+        auto unformatted = protocol.unformatPacket(buffer);
+        EXPECT_EQ(unformatted.data, payload);
+    }), 1u);
+}
+
+TEST(ALLOCATIONS, message_protocol_pack) {
+    net::ProtocolManager protocol(writeProtocol());
+    net::MessageProtocol messages(protocol);
+    net::LOGIN_REQUEST login{};
+    std::strcpy(login.username, "player");
+    std::vector<uint8_t> packet;
+
+    // serialized straight into the packet, no intermediate buffer
+    EXPECT_LE(alloc_test::countAllocations([&] {
+        packet = messages.pack(login);
+    }), 1u);
+    EXPECT_EQ(protocol.unformatPacketView(packet).data.size(),
+        login.serializedSize());
+    EXPECT_STREQ(messages.unpack<net::LOGIN_REQUEST>(packet).username,
+        "player");
+    EXPECT_EQ(alloc_test::countAllocations([&] {
+        messages.packInto(login, packet);
+    }), 0u);
+
+    // compressed: the frame ends where the compressed fields do
+    net::LARGE_DATA large{};
+    std::memset(large.data_content, 'x', sizeof(large.data_content));
+    messages.packInto(large, packet);
+    EXPECT_EQ(alloc_test::countAllocations([&] {
+        messages.packInto(large, packet);
+    }), 0u);
+    EXPECT_LT(packet.size(), large.serializedSize());
+    EXPECT_EQ(messages.unpack<net::LARGE_DATA>(packet).data_content[2047],
+        'x');
+}
+
+TEST(ALLOCATIONS, server_unpack) {
+    net::Server server(4264, "UDP", writeProtocol(), false);
+    net::Address address("127.0.0.1", 5000);
+    std::vector<uint8_t> payload(64, 0x11);
+
+    // every packet and the list come from the tick arena
+    feed(server, address, payload, 8);
+    EXPECT_EQ(alloc_test::countAllocations([&] {
+        auto packets = server.unpack(address, -1, server.getTickArena());
+        EXPECT_EQ(packets.size(), 8u);
+    }), 0u);
+    server.resetTickArena();
+
+    // one per packet, plus the growth of the list
+    feed(server, address, payload, 8);
+    EXPECT_LE(alloc_test::countAllocations([&] {
+        auto packets = server.unpack(address, -1);
+        EXPECT_EQ(packets.size(), 8u);
+    }), 8u + 4u);
+}
+
+TEST(ALLOCATIONS, idle_client_info) {
+    // created, moved around the client table and erased for every client,
+    // latency tracking on or off
+    EXPECT_EQ(alloc_test::countAllocations([] {
+        net::Server::ClientInfo info{};
+        net::Server::ClientInfo moved = std::move(info);
+        info = std::move(moved);
+    }), 0u);
+}
+
+TEST(ALLOCATIONS, server_udp_receive) {
+    std::string path = writeProtocol();
+    net::Server server(4265, "UDP", path, false);
+    net::Client client("UDP", path, false);
+    std::vector<uint8_t> payload(200, 0x42);
+    std::vector<net::Address> senders;
+    size_t calls = 0;
+    size_t allocations = 0;
+
+    server.start();
+    server.setNonBlocking(true);
+    client.connect("127.0.0.1", 4265);
+
+    auto receive = [&](size_t expected) {
+        senders.clear();
+        calls = 0;
+        allocations = 0;
+        for (; calls < 50 && senders.size() < expected; ++calls) {
+            std::vector<net::Address> received;
+            allocations += alloc_test::countAllocations([&] {
+                received = server.udpReceive(10, 10);
+            });
+            senders.insert(senders.end(), received.begin(), received.end());
+        }
+        ASSERT_EQ(senders.size(), expected);
+    };
+
+    // the first round creates the client and sizes the buffers
+    for (int i = 0; i < 4; ++i)
+        client.send(payload);
+    receive(4);
+    server.unpack(senders[0], -1);
+
+    for (int i = 0; i < 4; ++i)
+        client.send(payload);
+    receive(4);
+    // only the returned list
+    EXPECT_LE(allocations, calls);
+}
+
+TEST(ALLOCATIONS, generated_messages) {
+    net::LOGIN_REQUEST login{};
+    std::strcpy(login.username, "player");
+    login.client_version = 3;
+    std::vector<uint8_t> loginBytes;
+
+    EXPECT_LE(alloc_test::countAllocations([&] {
+        loginBytes = login.serialize();
+    }), 1u);
+    EXPECT_EQ(alloc_test::countAllocations([&] {
+        login.serializeInto(loginBytes);
+    }), 0u);
+    EXPECT_EQ(alloc_test::countAllocations([&] {
+        auto decoded = net::LOGIN_REQUEST::deserialize(loginBytes);
+        EXPECT_EQ(decoded.client_version, 3);
+    }), 0u);
+
+    net::CHAT_MESSAGE chat{};
+    std::strcpy(chat.content, "hello");
+    std::vector<uint8_t> chatBytes;
+
+    EXPECT_LE(alloc_test::countAllocations([&] {
+        chatBytes = chat.serialize();
+    }), 1u);
+    EXPECT_EQ(alloc_test::countAllocations([&] {
+        auto decoded = net::CHAT_MESSAGE::deserialize(chatBytes);
+        EXPECT_STREQ(decoded.content, "hello");
+    }), 0u);
+
+    net::LARGE_DATA large{};
+    std::memset(large.data_content, 'x', sizeof(large.data_content));
+    std::vector<uint8_t> largeBytes;
+
+    // the raw form goes to a per-thread buffer, sized by the first call
+    largeBytes = large.serialize();
+    EXPECT_LE(alloc_test::countAllocations([&] {
+        largeBytes = large.serialize();
+    }), 1u);
+    std::vector<uint8_t> largeBuffer(large.serializedSize());
+    EXPECT_EQ(alloc_test::countAllocations([&] {
+        large.serializeInto(largeBuffer);
+    }), 0u);
+    // decompressed in a per-thread buffer, sized by the first call too
+    net::LARGE_DATA::deserialize(largeBytes);
+    EXPECT_EQ(alloc_test::countAllocations([&] {
+        net::LARGE_DATA::deserialize(largeBytes);
+    }), 0u);
+
+    std::byte stack[4096];
+    std::pmr::monotonic_buffer_resource scratch(stack, sizeof(stack),
+        std::pmr::null_memory_resource());
+    EXPECT_EQ(alloc_test::countAllocations([&] {
+        auto decoded = net::LARGE_DATA::deserialize(
+            std::span<const uint8_t>(largeBytes), &scratch);
+        EXPECT_EQ(decoded.data_content[2047], 'x');
+    }), 0u);
+}
@@ -0,0 +1,71 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** BitStream.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "Network/BitStream.hpp"
+
+TEST(BIT_STREAM, round_trip_of_every_width) {
+    std::mt19937_64 rng(7);
+    std::vector<std::pair<uint64_t, unsigned>> values;
+    size_t total = 0;
+
+    // crosses the 64 bit words at every offset
+    for (int i = 0; i < 500; ++i) {
+        unsigned bits = static_cast<unsigned>(rng() % 64) + 1;
+        values.push_back({rng() & net::BitWriter::mask(bits), bits});
+        total += bits;
+    }
+    std::vector<uint8_t> buffer((total + 7) / 8 + 4, 0xEE);
+
+    net::BitWriter writer(buffer.data());
+    for (auto [value, bits] : values)
+        writer.write(value, bits);
+    EXPECT_EQ(writer.flush(), (total + 7) / 8);
+    EXPECT_EQ(buffer[(total + 7) / 8], 0xEE);
+
+    net::BitReader reader(buffer.data(), (total + 7) / 8);
+    for (auto [value, bits] : values)
+        EXPECT_EQ(reader.read(bits), value);
+    EXPECT_EQ(reader.position(), total);
+}
+
+TEST(BIT_STREAM, lowest_bits_first) {
+    uint8_t buffer[2] = {};
+    net::BitWriter writer(buffer);
+
+    writer.write(0b101, 3);
+    // only the low bits are kept
+    writer.write(0xFF, 6);
+    EXPECT_EQ(writer.flush(), 2u);
+    EXPECT_EQ(buffer[0], 0b11111101);
+    // the unused bits of the last byte stay 0
+    EXPECT_EQ(buffer[1], 0b1);
+
+    EXPECT_EQ(net::BitReader(buffer, 2, 3).read(6), 0x3Fu);
+    // nothing is read past the end
+    EXPECT_EQ(net::BitReader(buffer, 1, 3).read(6), 0x1Fu);
+}
+
+TEST(BIT_STREAM, quantize_within_half_a_step) {
+    double step = 8192.0 / 65535;
+
+    for (float value : {-4096.0f, -1.5f, 0.0f, 0.3f, 1234.567f, 4096.0f}) {
+        uint64_t quantized = net::quantize(value, -4096, 4096, 16);
+        EXPECT_NEAR(net::dequantize(quantized, -4096, 4096, 16), value,
+            step / 2);
+    }
+    EXPECT_EQ(net::quantize(-5000, -4096, 4096, 16), 0u);
+    EXPECT_EQ(net::quantize(5000, -4096, 4096, 16), 65535u);
+    EXPECT_EQ(net::quantize(NAN, -4096, 4096, 16), 0u);
+    EXPECT_EQ(net::dequantize(65535, -1, 1, 16), 1.0f);
+}
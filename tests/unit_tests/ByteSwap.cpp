@@ -0,0 +1,49 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** ByteSwap.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "Network/ByteSwap.hpp"
+
+TEST(BYTE_SWAP, reverses_every_element) {
+    std::mt19937 rng(7);
+
+    // counts around the 16 and 32 byte blocks, misaligned on both sides
+    for (size_t width : {1, 2, 4, 8}) {
+        for (size_t count = 0; count < 70; ++count) {
+            std::vector<uint8_t> src(count * width + 3);
+            std::vector<uint8_t> dst(count * width + 5, 0xEE);
+            for (auto& byte : src)
+                byte = static_cast<uint8_t>(rng());
+
+            net::byteswapCopy(dst.data() + 5, src.data() + 3, count, width);
+            for (size_t i = 0; i < count; ++i) {
+                EXPECT_TRUE(std::equal(dst.begin() + 5 + i * width,
+                    dst.begin() + 5 + (i + 1) * width,
+                    src.rbegin() + (count - 1 - i) * width))
+                    << "width " << width << " count " << count;
+            }
+            EXPECT_TRUE(std::all_of(dst.begin(), dst.begin() + 5,
+                [](uint8_t byte) { return byte == 0xEE; }));
+        }
+    }
+}
+
+TEST(BYTE_SWAP, matches_scalar_in_place) {
+    std::vector<uint32_t> values(1000);
+    std::iota(values.begin(), values.end(), 0x01020300u);
+    std::vector<uint32_t> expected(values.size());
+
+    net::byteswapCopyScalar(expected.data(), values.data(), values.size(), 4);
+    net::byteswapCopy(values.data(), values.data(), values.size(), 4);
+    EXPECT_EQ(values, expected);
+    EXPECT_EQ(values[0], 0x00030201u);
+}
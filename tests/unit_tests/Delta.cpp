@@ -0,0 +1,229 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Delta.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ProtocolFile.hpp"
+#include "Network/Address.hpp"
+#include "Network/Client.hpp"
+#include "Network/Delta.hpp"
+#include "Network/Server.hpp"
+#include "Network/generated_messages.hpp"
+
+static net::PLAYER_UPDATE player(uint32_t score) {
+    net::PLAYER_UPDATE update{};
+    update.player_id = 9;
+    update.pos_x = 100.0f;
+    update.pos_y = -20.0f;
+    update.score = score;
+    update.health = 1000;
+    update.alive = 1;
+    std::strcpy(update.name, "player");
+    return update;
+}
+
+static std::string writeProtocol() {
+    return test_support::writeProtocol("net_delta_protocol.json");
+}
+
+TEST(DELTA, whole_until_acknowledged) {
+    net::DeltaSender<net::PLAYER_UPDATE> sender;
+    net::DeltaReceiver<net::PLAYER_UPDATE> receiver;
+
+    std::vector<uint8_t> first = sender.encode(player(1));
+    std::vector<uint8_t> second = sender.encode(player(2));
+    EXPECT_EQ(first.size(), player(1).serializedSize());
+    EXPECT_FALSE(net::PLAYER_UPDATE::readDeltaHeader(second).hasBaseline());
+
+    // the first one was lost, the second decodes on its own
+    EXPECT_EQ(receiver.decode(second).score, 2u);
+    EXPECT_EQ(receiver.latest(), 1);
+    sender.acknowledge(receiver.latest());
+
+    // only the score changed: header, mask and a 1 byte varint
+    std::vector<uint8_t> third = sender.encode(player(3));
+    EXPECT_EQ(third.size(), 1u + 2 + 2 + 1 + 1);
+    EXPECT_EQ(net::PLAYER_UPDATE::readDeltaHeader(third).baseline, 1);
+    const net::PLAYER_UPDATE& decoded = receiver.decode(third);
+    EXPECT_EQ(decoded.score, 3u);
+    EXPECT_EQ(decoded.health, 1000);
+    EXPECT_STREQ(decoded.name, "player");
+}
+
+TEST(DELTA, newest_acknowledgement_wins) {
+    net::DeltaSender<net::PLAYER_UPDATE, 4> sender;
+
+    for (uint32_t score = 0; score < 3; ++score)
+        sender.encode(player(score));
+    sender.acknowledge(2);
+    // late and unknown acknowledgements are ignored
+    sender.acknowledge(0);
+    sender.acknowledge(50);
+    std::vector<uint8_t> bytes = sender.encode(player(2));
+    EXPECT_EQ(net::PLAYER_UPDATE::readDeltaHeader(bytes).baseline, 2);
+    EXPECT_EQ(bytes.size(), 1u + 2 + 2 + 1);
+
+    // once out of the history, back to the whole form
+    for (int i = 0; i < 4; ++i)
+        bytes = sender.encode(player(2));
+    EXPECT_FALSE(net::PLAYER_UPDATE::readDeltaHeader(bytes).hasBaseline());
+
+    sender.acknowledge(static_cast<uint16_t>(sender.nextSequence() - 1));
+    sender.reset();
+    bytes = sender.encode(player(2));
+    EXPECT_FALSE(net::PLAYER_UPDATE::readDeltaHeader(bytes).hasBaseline());
+}
+
+TEST(DELTA, unknown_baseline_throws) {
+    net::DeltaSender<net::PLAYER_UPDATE, 4> sender;
+    net::DeltaReceiver<net::PLAYER_UPDATE, 4> receiver;
+
+    receiver.decode(sender.encode(player(1)));
+    sender.acknowledge(0);
+    std::vector<uint8_t> delta = sender.encode(player(2));
+
+    net::DeltaReceiver<net::PLAYER_UPDATE, 4> restarted;
+    EXPECT_THROW(restarted.decode(delta), std::runtime_error);
+    EXPECT_EQ(receiver.decode(delta).score, 2u);
+
+    // older than the history of the receiver
+    std::vector<uint8_t> old = sender.encode(player(3));
+    for (int i = 0; i < 4; ++i)
+        receiver.decode(sender.encode(player(4)));
+    EXPECT_THROW(receiver.decode(old), std::runtime_error);
+}
+
+TEST(DELTA, one_sender_per_client) {
+    net::ClientBaselines<net::PLAYER_UPDATE> baselines;
+    net::Address first("127.0.0.1", 4000);
+    net::Address second("127.0.0.1", 4001);
+
+    baselines[first].encode(player(1));
+    baselines[first].acknowledge(0);
+    EXPECT_EQ(baselines[first].encode(player(2)).size(), 1u + 2 + 2 + 1 + 1);
+    EXPECT_EQ(baselines[second].encode(player(2)).size(),
+        player(2).serializedSize());
+
+    EXPECT_TRUE(baselines.erase(first));
+    EXPECT_EQ(baselines[first].encode(player(2)).size(),
+        player(2).serializedSize());
+}
+
+TEST(DELTA, dispatcher_decodes_against_baselines) {
+    net::DeltaSender<net::PLAYER_UPDATE> sender;
+    net::MessageDispatcher dispatcher;
+    std::vector<uint32_t> scores;
+
+    dispatcher.on<net::PLAYER_UPDATE>([&](const net::PLAYER_UPDATE& update) {
+        scores.push_back(update.score);
+    });
+    EXPECT_TRUE(dispatcher.dispatch(sender.encode(player(1))));
+    sender.acknowledge(dispatcher.receiver<net::PLAYER_UPDATE>().latest());
+    std::vector<uint8_t> delta = sender.encode(player(2));
+    ASSERT_TRUE(net::PLAYER_UPDATE::readDeltaHeader(delta).hasBaseline());
+    EXPECT_TRUE(dispatcher.dispatch(delta));
+    EXPECT_EQ(scores, (std::vector<uint32_t>{1, 2}));
+
+    // a new connection forgets the baselines
+    dispatcher.receiver<net::PLAYER_UPDATE>().reset();
+    EXPECT_THROW(dispatcher.dispatch(delta), std::runtime_error);
+}
+
+TEST(DELTA, payload_handler_wins) {
+    net::DeltaSender<net::PLAYER_UPDATE> sender;
+    net::MessageDispatcher dispatcher;
+    std::vector<net::DeltaHeader> headers;
+    int decoded = 0;
+
+    dispatcher.on<net::PLAYER_UPDATE>([&](const net::PLAYER_UPDATE&) {
+        decoded++;
+    });
+    dispatcher.on<net::DeltaPayload<net::PLAYER_UPDATE>>(
+        [&](const net::DeltaPayload<net::PLAYER_UPDATE>& payload) {
+            headers.push_back(payload.header);
+            EXPECT_EQ(payload.data[0], net::PLAYER_UPDATE::ID);
+        });
+    sender.encode(player(1));
+    sender.acknowledge(0);
+    EXPECT_TRUE(dispatcher.dispatch(sender.encode(player(2))));
+    EXPECT_EQ(decoded, 0);
+    ASSERT_EQ(headers.size(), 1u);
+    EXPECT_EQ(headers[0].sequence, 1);
+    EXPECT_EQ(headers[0].baseline, 0);
+}
+
+TEST(DELTA, client_resets_its_receivers) {
+    net::Client client("UDP", writeProtocol(), false);
+    net::DeltaReceiver<net::PLAYER_UPDATE> receiver;
+    net::DeltaSender<net::PLAYER_UPDATE> sender;
+
+    client.addDeltaReceiver(receiver);
+    receiver.decode(sender.encode(player(1)));
+    ASSERT_TRUE(receiver.hasReceived());
+    ASSERT_TRUE(client.connect("127.0.0.1", 4268));
+    EXPECT_FALSE(receiver.hasReceived());
+    receiver.decode(sender.encode(player(2)));
+    client.disconnect();
+    EXPECT_FALSE(receiver.hasReceived());
+}
+
+TEST(DELTA, server_forgets_evicted_clients) {
+    std::string path = writeProtocol();
+    net::Server server(4268, "UDP", path, false);
+    net::Client client("UDP", path, false);
+    net::ClientBaselines<net::PLAYER_UPDATE> baselines;
+    std::vector<uint8_t> payload = {1, 2, 3};
+    std::vector<net::Address> senders;
+
+    server.addClientTable(baselines);
+    server.start();
+    server.setNonBlocking(true);
+    client.connect("127.0.0.1", 4268);
+    client.send(payload);
+    for (int tries = 0; tries < 50 && senders.empty(); ++tries)
+        senders = server.udpReceive(10, 10);
+    ASSERT_EQ(senders.size(), 1u);
+    baselines[senders[0]].encode(player(1));
+    baselines[senders[0]].acknowledge(0);
+
+    server.setClientTimeout(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(server.expireIdleClients(), 1u);
+    EXPECT_EQ(baselines.find(senders[0]), nullptr);
+}
+
+TEST(DELTA, server_forgets_disconnected_clients) {
+    std::string path = writeProtocol();
+    net::Server server(4269, "TCP", path, false);
+    net::Client client("TCP", path, false);
+    net::ClientBaselines<net::PLAYER_UPDATE> baselines;
+    std::vector<net::Address> left;
+
+    // the handler runs first, the entry it creates is erased too
+    server.setDisconnectHandler(
+        [&](const net::Address& address, const net::Server::ClientInfo&) {
+            baselines[address].encode(player(1));
+            left.push_back(address);
+        });
+    server.addClientTable(baselines);
+    ASSERT_TRUE(server.start());
+    ASSERT_TRUE(client.connect("127.0.0.1", 4269));
+    for (int tries = 0; tries < 10; ++tries)
+        server.tcpReceive(10);
+    client.disconnect();
+    for (int tries = 0; tries < 50 && left.empty(); ++tries)
+        server.tcpReceive(10);
+    ASSERT_EQ(left.size(), 1u);
+    EXPECT_EQ(baselines.find(left[0]), nullptr);
+    EXPECT_EQ(baselines.size(), 0u);
+}
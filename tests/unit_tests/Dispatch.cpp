@@ -0,0 +1,214 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Dispatch.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "ProtocolFile.hpp"
+#include "Network/MessageProtocol.hpp"
+#include "Network/ProtocolManager.hpp"
+#include "Network/generated_messages.hpp"
+
+static std::string writeProtocol() {
+    return test_support::writeProtocol("net_dispatch_protocol.json");
+}
+
+TEST(DISPATCH, calls_the_handler_of_the_id) {
+    net::MessageDispatcher dispatcher;
+    uint16_t version = 0;
+    std::string content;
+    char large = 0;
+
+    dispatcher.on<net::LOGIN_REQUEST>([&](const net::LOGIN_REQUEST& login) {
+        version = login.client_version;
+    });
+    dispatcher.on<net::CHAT_MESSAGEView>([&](const net::CHAT_MESSAGEView& chat) {
+        content = chat.content();
+    });
+    dispatcher.on<net::LARGE_DATA>([&](const net::LARGE_DATA& data) {
+        large = data.data_content[10];
+    });
+
+    net::LOGIN_REQUEST login{};
+    login.client_version = 12;
+    EXPECT_TRUE(dispatcher.dispatch(login.serialize()));
+    EXPECT_EQ(version, 12);
+
+    net::CHAT_MESSAGE chat{};
+    std::strcpy(chat.content, "hello");
+    EXPECT_TRUE(dispatcher.dispatch(chat.serialize()));
+    EXPECT_EQ(content, "hello");
+
+    // the ID of a compressed message is in front of its size prefix
+    net::LARGE_DATA data{};
+    std::memset(data.data_content, 'z', sizeof(data.data_content));
+    std::vector<uint8_t> bytes = data.serialize();
+    EXPECT_EQ(bytes[0], net::LARGE_DATA::ID);
+    EXPECT_TRUE(dispatcher.dispatch(bytes));
+    EXPECT_EQ(large, 'z');
+}
+
+TEST(DISPATCH, unknown_and_unhandled_ids) {
+    net::MessageDispatcher dispatcher;
+    net::LOGIN_REQUEST login{};
+    std::vector<uint8_t> bytes = login.serialize();
+
+    // no handler registered
+    EXPECT_FALSE(dispatcher.dispatch(bytes));
+    // no message with these IDs
+    EXPECT_FALSE(dispatcher.dispatch(std::vector<uint8_t>{2, 0, 0}));
+    EXPECT_FALSE(dispatcher.dispatch(std::vector<uint8_t>{255}));
+    EXPECT_FALSE(dispatcher.dispatch(std::vector<uint8_t>()));
+
+    dispatcher.on<net::LOGIN_REQUEST>([](const net::LOGIN_REQUEST&) {});
+    bytes.pop_back();
+    EXPECT_THROW(dispatcher.dispatch(bytes), std::runtime_error);
+}
+
+TEST(DISPATCH, view_handler_wins) {
+    net::MessageDispatcher dispatcher;
+    int views = 0;
+    int messages = 0;
+
+    dispatcher.on<net::LOGIN_REQUEST>([&](const net::LOGIN_REQUEST&) {
+        messages++;
+    });
+    dispatcher.on<net::LOGIN_REQUESTView>([&](const net::LOGIN_REQUESTView&) {
+        views++;
+    });
+    net::LOGIN_REQUEST login{};
+    dispatcher.dispatch(login.serialize());
+    EXPECT_EQ(views, 1);
+    EXPECT_EQ(messages, 0);
+}
+
+TEST(DISPATCH, packet_read_in_place) {
+    net::ProtocolManager protocol(writeProtocol());
+    net::MessageProtocol messages(protocol);
+    net::MessageDispatcher dispatcher;
+    net::CHAT_MESSAGE chat{};
+    std::strcpy(chat.sender, "me");
+    std::vector<uint8_t> packet = messages.pack(chat);
+    const uint8_t* seen = nullptr;
+
+    auto unformatted = protocol.unformatPacketView(packet);
+    EXPECT_EQ(unformatted.data.data(), packet.data() + 4 + 4 + 8);
+    EXPECT_EQ(unformatted.data.size(), chat.serializedSize());
+    EXPECT_EQ(messages.getMessageId(packet), net::CHAT_MESSAGE::ID);
+    EXPECT_STREQ(messages.unpack<net::CHAT_MESSAGE>(packet).sender, "me");
+
+    dispatcher.on<net::CHAT_MESSAGEView>([&](const net::CHAT_MESSAGEView& view) {
+        seen = view.bytes().data();
+    });
+    EXPECT_EQ(alloc_test::countAllocations([&] {
+        EXPECT_TRUE(messages.dispatch(packet, dispatcher));
+    }), 0u);
+    EXPECT_EQ(seen, unformatted.data.data());
+}
+
+TEST(DISPATCH, batch_of_packets) {
+    net::ProtocolManager protocol(writeProtocol());
+    net::MessageProtocol messages(protocol);
+    net::MessageDispatcher dispatcher;
+    std::vector<std::vector<uint8_t>> packets;
+    size_t large = 0;
+    std::string text = "The server will restart in 5 minutes for maintenance.";
+    size_t notices = 0;
+
+    dispatcher.on<net::LARGE_DATA>([&](const net::LARGE_DATA& data) {
+        large += data.data_content[0] == 'a' + large;
+    });
+    dispatcher.on<net::SERVER_NOTICE>([&](const net::SERVER_NOTICE& notice) {
+        notices += text == notice.text;
+    });
+    for (char c : {'a', 'b', 'c'}) {
+        net::LARGE_DATA data{};
+        std::memset(data.data_content, c, sizeof(data.data_content));
+        packets.push_back(messages.pack(data));
+    }
+    net::SERVER_NOTICE notice{};
+    std::strcpy(notice.text, text.c_str());
+    packets.push_back(messages.pack(notice));
+    // no handler for it
+    packets.push_back(messages.pack(net::LOGIN_REQUEST{}));
+
+    EXPECT_EQ(messages.dispatchAll(packets, dispatcher), 4u);
+    EXPECT_EQ(large, 3u);
+    EXPECT_EQ(notices, 1u);
+    // decompressed in the same buffer, kept from the previous batch
+    large = 0;
+    EXPECT_EQ(alloc_test::countAllocations([&] {
+        messages.dispatchAll(packets, dispatcher);
+    }), 0u);
+    EXPECT_EQ(large, 3u);
+
+    // a malformed packet is counted and skipped, the next ones still go
+    packets.insert(packets.begin() + 1, std::vector<uint8_t>{1, 2});
+    large = 0;
+    EXPECT_EQ(messages.dispatchAll(packets, dispatcher), 4u);
+    EXPECT_EQ(large, 3u);
+    EXPECT_EQ(dispatcher.errors(), 1u);
+}
+
+TEST(DISPATCH, batch_skips_malformed_messages) {
+    net::MessageDispatcher dispatcher;
+    std::vector<std::vector<uint8_t>> batch;
+    int notices = 0;
+
+    dispatcher.on<net::SERVER_NOTICE>([&](const net::SERVER_NOTICE&) {
+        notices++;
+    });
+    std::vector<uint8_t> notice = net::SERVER_NOTICE{}.serialize();
+    batch.push_back(notice);
+    // truncated after its ID
+    batch.push_back({notice[0]});
+    batch.push_back(notice);
+
+    EXPECT_THROW(dispatcher.dispatch(batch[1]),
+        net::MessageDispatcher::MalformedMessage);
+    EXPECT_EQ(dispatcher.errors(), 0u);
+    EXPECT_EQ(dispatcher.dispatchAll(batch), 2u);
+    EXPECT_EQ(notices, 2);
+    EXPECT_EQ(dispatcher.errors(), 1u);
+}
+
+TEST(DISPATCH, batch_lets_handler_errors_through) {
+    net::ProtocolManager protocol(writeProtocol());
+    net::MessageProtocol messages(protocol);
+    net::MessageDispatcher dispatcher;
+    std::vector<std::vector<uint8_t>> batch;
+    int notices = 0;
+
+    dispatcher.on<net::SERVER_NOTICE>([&](const net::SERVER_NOTICE&) {
+        if (++notices == 2)
+            throw std::runtime_error("handler failed");
+    });
+    for (int i = 0; i < 3; ++i)
+        batch.push_back(net::SERVER_NOTICE{}.serialize());
+
+    EXPECT_THROW(dispatcher.dispatchAll(batch), std::runtime_error);
+    EXPECT_EQ(notices, 2);
+    EXPECT_EQ(dispatcher.errors(), 0u);
+
+    std::vector<std::vector<uint8_t>> packets;
+    for (auto& message : batch)
+        packets.push_back(protocol.formatPacket(message));
+    notices = 0;
+    try {
+        messages.dispatchAll(packets, dispatcher);
+        ADD_FAILURE() << "the handler error was swallowed";
+    } catch (const net::MessageDispatcher::MalformedMessage&) {
+        ADD_FAILURE() << "the handler error was taken for a malformed one";
+    } catch (const std::runtime_error& e) {
+        EXPECT_STREQ(e.what(), "handler failed");
+    }
+    EXPECT_EQ(dispatcher.errors(), 0u);
+}
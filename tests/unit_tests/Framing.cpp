@@ -0,0 +1,215 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Framing.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <csignal>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ProtocolFile.hpp"
+#include "Network/Client.hpp"
+#include "Network/ProtocolManager.hpp"
+#include "Network/Server.hpp"
+#include "Network/generated_messages.hpp"
+
+static std::string writeProtocol(bool streamCompression = false) {
+    return test_support::writeProtocol(streamCompression ?
+        "net_framing_stream_protocol.json" : "net_framing_protocol.json",
+        {.preamble = false, .streamCompression = streamCompression});
+}
+
+TEST(FRAMING, server_waits_for_end_marker) {
+    std::string path = writeProtocol();
+    net::ProtocolManager protocol(path);
+    net::Server server(4266, "UDP", path, false);
+    net::Address from("127.0.0.1", 5000);
+    std::vector<uint8_t> payload = {1, 2, 3};
+    std::vector<uint8_t> packet = protocol.formatPacket(payload);
+    auto& input = server.getUdpClientsRef()[from].input;
+
+    // everything but the last byte of the end marker
+    input.assign(packet.begin(), packet.end() - 1);
+    EXPECT_TRUE(server.unpack(from, -1).empty());
+    input.push_back(packet.back());
+    auto packets = server.unpack(from, -1);
+    ASSERT_EQ(packets.size(), 1u);
+    EXPECT_EQ(packets[0], payload);
+    EXPECT_TRUE(input.empty());
+}
+
+TEST(FRAMING, server_drops_length_shorter_than_datetime) {
+    std::string path = writeProtocol();
+    net::ProtocolManager protocol(path);
+    net::Server server(4272, "UDP", path, false);
+    net::Address from("127.0.0.1", 5000);
+    std::vector<uint8_t> payload = {1, 2, 3};
+    const std::string& end = protocol.getEndOfPacket().characters;
+    auto& input = server.getUdpClientsRef()[from].input;
+
+    // little endian length of 2, less than the datetime it must hold
+    input = {2, 0, 0, 0, 7, 7};
+    input.insert(input.end(), end.begin(), end.end());
+    std::vector<uint8_t> packet = protocol.formatPacket(payload);
+    input.insert(input.end(), packet.begin(), packet.end());
+
+    auto packets = server.unpack(from, -1);
+    ASSERT_EQ(packets.size(), 1u);
+    EXPECT_EQ(packets[0], payload);
+    EXPECT_TRUE(input.empty());
+    EXPECT_EQ(server.getMetrics().framingErrors.value(), 1u);
+    EXPECT_EQ(server.getUdpClients().find(from)->framingErrors, 1u);
+    EXPECT_TRUE(server.unpack(from, -1).empty());
+    EXPECT_EQ(server.getMetrics().framingErrors.value(), 1u);
+}
+
+TEST(FRAMING, client_waits_for_end_marker) {
+    std::string path = writeProtocol();
+    net::ProtocolManager protocol(path);
+    net::Client client("UDP", path, false);
+    std::vector<uint8_t> payload = {1, 2, 3};
+    std::vector<uint8_t> packet = protocol.formatPacket(payload);
+    auto& input = client.getInputBufferRef();
+
+    input.assign(packet.begin(), packet.end() - 1);
+    EXPECT_TRUE(client.extractPacketsFromBuffer().empty());
+    input.push_back(packet.back());
+    auto packets = client.extractPacketsFromBuffer();
+    ASSERT_EQ(packets.size(), 1u);
+    EXPECT_EQ(packets[0], payload);
+
+    // an empty packet has no message code to track
+    input = protocol.formatPacket(std::vector<uint8_t>());
+    EXPECT_EQ(client.extractPacketsFromBuffer().size(), 1u);
+}
+
+TEST(FRAMING, unformat_checks_wire_lengths) {
+    net::ProtocolManager protocol(writeProtocol());
+    std::vector<uint8_t> payload = {1, 2, 3};
+    std::vector<uint8_t> packet = protocol.formatPacket(payload);
+
+    // length field pointing past the end of the packet
+    std::vector<uint8_t> tooLong = packet;
+    tooLong[0] = 200;
+    EXPECT_THROW(protocol.unformatPacket(tooLong), std::runtime_error);
+
+    // length field smaller than the datetime it covers
+    std::vector<uint8_t> tooShort = packet;
+    tooShort[0] = 2;
+    EXPECT_THROW(protocol.unformatPacket(tooShort), std::runtime_error);
+
+    EXPECT_EQ(protocol.unformatPacket(packet).data, payload);
+}
+
+TEST(FRAMING, deserialize_rejects_truncated_messages) {
+    net::LOGIN_REQUEST login{};
+    login.client_version = 7;
+    std::vector<uint8_t> bytes = login.serialize();
+
+    EXPECT_EQ(net::LOGIN_REQUEST::deserialize(bytes).client_version, 7);
+    bytes.pop_back();
+    EXPECT_THROW(net::LOGIN_REQUEST::deserialize(bytes), std::runtime_error);
+    EXPECT_THROW(net::LOGIN_REQUEST::deserialize(std::vector<uint8_t>()),
+        std::runtime_error);
+
+    net::LARGE_DATA large{};
+    std::vector<uint8_t> compressed = large.serialize();
+    EXPECT_THROW(net::LARGE_DATA::deserialize(
+        std::vector<uint8_t>(compressed.begin(), compressed.begin() + 3)),
+        std::runtime_error);
+    // size claiming far more than the block can expand to
+    compressed[2] = 0x7F;
+    EXPECT_THROW(net::LARGE_DATA::deserialize(compressed),
+        std::runtime_error);
+}
+
+TEST(FRAMING, tcp_stream_compression) {
+    std::string path = writeProtocol(true);
+    net::Server server(4267, "TCP", path, false);
+    net::Client client("TCP", path, false);
+    std::vector<uint8_t> payload(200, 'p');
+    std::vector<std::vector<uint8_t>> packets;
+    int fd = -1;
+
+    ASSERT_TRUE(server.start());
+    ASSERT_TRUE(client.connect("127.0.0.1", 4267));
+    for (int i = 0; i < 3; ++i)
+        ASSERT_TRUE(client.send(payload));
+    for (int tries = 0; tries < 50 && packets.size() < 3; ++tries) {
+        for (int from : server.tcpReceive(20)) {
+            fd = from;
+            for (auto& packet : server.unpack(from, -1))
+                packets.push_back(packet);
+        }
+    }
+    ASSERT_EQ(packets.size(), 3u);
+    EXPECT_EQ(packets[2], payload);
+    // the packets repeat the first one, each takes a few bytes
+    EXPECT_LT(server.getMetrics().bytesIn.value(), payload.size());
+
+    int sent = server.tcpSend(fd, payload);
+    EXPECT_LT(static_cast<size_t>(sent), payload.size());
+    for (int tries = 0; tries < 50 && packets.size() < 4; ++tries) {
+        client.tcpReceive(20);
+        for (auto& packet : client.extractPacketsFromBuffer())
+            packets.push_back(packet);
+    }
+    ASSERT_EQ(packets.size(), 4u);
+    EXPECT_EQ(packets[3], payload);
+}
+
+TEST(FRAMING, tcp_stream_receive_keeps_every_packet) {
+    std::string path = writeProtocol(true);
+    net::Server server(4270, "TCP", path, false);
+    net::Client client("TCP", path, false);
+    int fd = -1;
+
+    ASSERT_TRUE(server.start());
+    ASSERT_TRUE(client.connect("127.0.0.1", 4270));
+    for (int tries = 0; tries < 50 && fd < 0; ++tries) {
+        server.tcpReceive(10);
+        if (!server.getTcpClients().empty())
+            fd = server.getTcpClients().begin()->first;
+    }
+    ASSERT_GE(fd, 0);
+    // three blocks, read by a single recv
+    for (uint8_t i = 1; i <= 3; ++i)
+        server.tcpSend(fd, std::vector<uint8_t>(50, i));
+    client.setTimeout(1000);
+
+    std::vector<uint8_t> buffer(100);
+    for (uint8_t i = 1; i <= 3; ++i) {
+        int received = 0;
+        for (int tries = 0; tries < 10 && received == 0; ++tries)
+            received = client.receive(buffer.data(), buffer.size());
+        ASSERT_EQ(received, 50);
+        EXPECT_EQ(buffer[0], i);
+    }
+    EXPECT_TRUE(client.getInputBufferRef().empty());
+}
+
+TEST(FRAMING, tcp_stream_send_failure_disconnects) {
+    std::string path = writeProtocol(true);
+    net::Server server(4271, "TCP", path, false);
+    net::Client client("TCP", path, false);
+    std::vector<uint8_t> payload(50, 'p');
+
+    std::signal(SIGPIPE, SIG_IGN);
+    ASSERT_TRUE(server.start());
+    ASSERT_TRUE(client.connect("127.0.0.1", 4271));
+    for (int tries = 0; tries < 5; ++tries)
+        server.tcpReceive(10);
+    server.stop();
+
+    // the first sends may still be accepted by the closed socket
+    bool sent = true;
+    for (int tries = 0; tries < 50 && sent; ++tries)
+        sent = client.send(payload);
+    EXPECT_FALSE(sent);
+    // the encoder went ahead of what the server got, the stream is over
+    EXPECT_FALSE(client.isConnected());
+}
@@ -0,0 +1,246 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** GeneratedMessages.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Network/generated_messages.hpp"
+
+TEST(GENERATED_MESSAGES, serialized_size_is_exact) {
+    net::LOGIN_REQUEST login{};
+    std::strcpy(login.username, "player");
+    login.client_version = 0x0102;
+
+    // ID, username[32], password[64], client_version
+    EXPECT_EQ(login.serializedSize(), 1u + 32 + 64 + 2);
+    std::vector<uint8_t> bytes = login.serialize();
+    ASSERT_EQ(bytes.size(), login.serializedSize());
+    EXPECT_EQ(bytes[0], net::LOGIN_REQUEST::ID);
+    EXPECT_EQ(std::memcmp(bytes.data() + 1, "player", 6), 0);
+    // protocol.json is little endian
+    EXPECT_EQ(bytes[97], 0x02);
+    EXPECT_EQ(bytes[98], 0x01);
+}
+
+TEST(GENERATED_MESSAGES, serialize_into_matches_serialize) {
+    net::CHAT_MESSAGE chat{};
+    std::strcpy(chat.content, "hello");
+    std::strcpy(chat.sender, "me");
+    std::vector<uint8_t> buffer(chat.serializedSize() + 10, 0xEE);
+
+    size_t written = chat.serializeInto(buffer);
+    EXPECT_EQ(written, chat.serializedSize());
+    EXPECT_EQ(std::vector<uint8_t>(buffer.begin(), buffer.begin() + written),
+        chat.serialize());
+    // nothing written past the message
+    EXPECT_EQ(buffer[written], 0xEE);
+
+    std::vector<uint8_t> small(chat.serializedSize() - 1);
+    EXPECT_THROW(chat.serializeInto(small), std::runtime_error);
+}
+
+TEST(GENERATED_MESSAGES, compressed_size_is_a_bound) {
+    net::LARGE_DATA large{};
+    std::memset(large.data_content, 'x', sizeof(large.data_content));
+    std::vector<uint8_t> buffer(large.serializedSize());
+
+    size_t written = large.serializeInto(buffer);
+    EXPECT_LT(written, large.serializedSize());
+    buffer.resize(written);
+    EXPECT_EQ(buffer, large.serialize());
+    EXPECT_EQ(net::LARGE_DATA::deserialize(buffer).data_content[100], 'x');
+}
+
+TEST(GENERATED_MESSAGES, compressed_only_when_it_pays) {
+    // below compress_min_size: size with its low bit clear, then the fields
+    net::SERVER_NOTICE notice{};
+    notice.severity = 2;
+    std::strcpy(notice.text, "hi");
+    std::vector<uint8_t> bytes = notice.serialize();
+    EXPECT_EQ(bytes, (std::vector<uint8_t>{net::SERVER_NOTICE::ID, 4 << 1, 2,
+        2, 'h', 'i'}));
+    EXPECT_STREQ(net::SERVER_NOTICE::deserialize(bytes).text, "hi");
+
+    // above it, but nothing to compress
+    std::strcpy(notice.text, "q7#Zk!pW2@xL9&vB4^mT");
+    bytes = notice.serialize();
+    EXPECT_EQ(bytes.size(), notice.serializedSize());
+    EXPECT_EQ(bytes[1] & 1, 0);
+
+    // a phrase of the dictionary takes a few bytes
+    std::strcpy(notice.text,
+        "The server will restart in 5 minutes for maintenance.");
+    bytes = notice.serialize();
+    EXPECT_EQ(bytes[1] & 1, 1);
+    EXPECT_LT(bytes.size(), 16u);
+    net::SERVER_NOTICE decoded = net::SERVER_NOTICE::deserialize(bytes);
+    EXPECT_STREQ(decoded.text, notice.text);
+    EXPECT_EQ(decoded.severity, 2);
+
+    // the fields must fill the size sent
+    bytes = {net::SERVER_NOTICE::ID, 5 << 1, 2, 2, 'h', 'i', 0};
+    EXPECT_THROW(net::SERVER_NOTICE::deserialize(bytes), std::runtime_error);
+}
+
+TEST(GENERATED_MESSAGES, size_checked_before_decompressing) {
+    // the most the fields can take: data_content, and severity then text
+    EXPECT_EQ(net::LARGE_DATA::MAX_UNCOMPRESSED_SIZE, 2048u);
+    EXPECT_EQ(net::SERVER_NOTICE::MAX_UNCOMPRESSED_SIZE, 1u + 2 + 200);
+
+    // one byte more than the limit, with enough data for LZ4 to expand to it
+    std::vector<uint8_t> bytes = {net::LARGE_DATA::ID, 0x83, 0x20};
+    bytes.resize(64, 0);
+    EXPECT_THROW(net::LARGE_DATA::deserialize(bytes), std::runtime_error);
+    // 1 MB, which LZ4 could expand the data to
+    bytes = {net::LARGE_DATA::ID, 0x81, 0x80, 0x80, 0x01};
+    bytes.resize(5 + (1 << 20) / 255 + 1, 0);
+    EXPECT_THROW(net::LARGE_DATA::deserialize(bytes), std::runtime_error);
+    // stored fields are held to the same limit
+    bytes = {net::SERVER_NOTICE::ID, 0x98, 0x03};
+    bytes.resize(3 + 204, 0);
+    EXPECT_THROW(net::SERVER_NOTICE::deserialize(bytes), std::runtime_error);
+
+    net::LARGE_DATA large{};
+    std::memset(large.data_content, 'y', sizeof(large.data_content));
+    bytes = large.serialize();
+    EXPECT_EQ(net::LARGE_DATA::deserialize(bytes).data_content[2047], 'y');
+}
+
+TEST(GENERATED_MESSAGES, view_reads_in_place) {
+    net::LOGIN_REQUEST login{};
+    std::strcpy(login.username, "player");
+    std::memset(login.password, 'p', sizeof(login.password));
+    login.client_version = 0x0102;
+    std::vector<uint8_t> bytes = login.serialize();
+    bytes.push_back(0xEE);
+
+    net::LOGIN_REQUEST::View view(bytes);
+    EXPECT_EQ(view.username(), "player");
+    // not terminated, stops at max_length
+    EXPECT_EQ(view.password(), std::string(64, 'p'));
+    EXPECT_EQ(view.client_version(), 0x0102);
+    EXPECT_EQ(view.bytes().data(), bytes.data());
+    EXPECT_EQ(view.bytes().size(), login.serializedSize());
+    EXPECT_EQ(view.toMessage().client_version, 0x0102);
+
+    bytes.resize(login.serializedSize() - 1);
+    EXPECT_THROW(net::LOGIN_REQUEST::View{bytes}, std::runtime_error);
+}
+
+TEST(GENERATED_MESSAGES, varlen_strings_take_their_length) {
+    net::CHAT_MESSAGE chat{};
+    std::strcpy(chat.content, "hello");
+    std::strcpy(chat.sender, "me");
+
+    // ID, length and characters of content then of sender
+    std::vector<uint8_t> bytes = chat.serialize();
+    ASSERT_EQ(bytes.size(), 1u + 1 + 5 + 1 + 2);
+    EXPECT_EQ(bytes[1], 5);
+    EXPECT_EQ(bytes[7], 2);
+
+    net::CHAT_MESSAGE decoded = net::CHAT_MESSAGE::deserialize(bytes);
+    EXPECT_STREQ(decoded.content, "hello");
+    EXPECT_STREQ(decoded.sender, "me");
+    net::CHAT_MESSAGE::View view(bytes);
+    EXPECT_EQ(view.content(), "hello");
+    EXPECT_EQ(view.sender(), "me");
+
+    // a full string has no terminator, its length is max_length
+    std::memset(chat.content, 'c', sizeof(chat.content));
+    bytes = chat.serialize();
+    EXPECT_EQ(bytes.size(), 1u + 2 + 128 + 1 + 2);
+    EXPECT_EQ(net::CHAT_MESSAGE::View(bytes).content(), std::string(128, 'c'));
+
+    // a zero inside would be lost once written back
+    bytes = {net::CHAT_MESSAGE::ID, 3, 'a', 0, 'b', 0};
+    EXPECT_THROW(net::CHAT_MESSAGE::deserialize(bytes), std::runtime_error);
+    EXPECT_THROW(net::CHAT_MESSAGE::View{bytes}, std::runtime_error);
+
+    // longer than max_length
+    bytes = {net::CHAT_MESSAGE::ID, 129, 1};
+    bytes.resize(200, 'c');
+    EXPECT_THROW(net::CHAT_MESSAGE::deserialize(bytes), std::runtime_error);
+    EXPECT_THROW(net::CHAT_MESSAGE::View{bytes}, std::runtime_error);
+}
+
+TEST(GENERATED_MESSAGES, bit_fields_are_packed) {
+    net::SNAPSHOT snapshot{};
+    snapshot.tick = 7;
+    snapshot.players.push_back({1, -1234.5f, 10.25f, 1000, 1});
+    snapshot.players.push_back({2, 5000.0f, 0.0f, 3, 0});
+
+    // ID, tick, count, then per player: player_id and 16 + 16 + 10 + 1 bits
+    std::vector<uint8_t> bytes = snapshot.serialize();
+    ASSERT_EQ(bytes.size(), 1u + 4 + 4 + 2 * (2 + 6));
+    EXPECT_EQ(bytes.size(), snapshot.serializedSize());
+
+    // positions within half a step, out of range ones clamped
+    double step = 8192.0 / 65535;
+    net::SNAPSHOT decoded = net::SNAPSHOT::deserialize(bytes);
+    ASSERT_EQ(decoded.players.size(), 2u);
+    EXPECT_NEAR(decoded.players[0].pos_x, -1234.5, step / 2);
+    EXPECT_NEAR(decoded.players[0].pos_y, 10.25, step / 2);
+    EXPECT_EQ(decoded.players[0].health, 1000);
+    EXPECT_EQ(decoded.players[0].alive, 1);
+    EXPECT_EQ(decoded.players[1].pos_x, 4096.0f);
+    EXPECT_EQ(decoded.players[1].health, 3);
+    EXPECT_EQ(decoded.serialize(), bytes);
+
+    net::SNAPSHOT::View view(bytes);
+    EXPECT_EQ(view.players(0).health, 1000);
+    EXPECT_EQ(view.players(1).pos_x, 4096.0f);
+
+    // the 5 unused bits of a player must be 0
+    bytes.back() |= 0x80;
+    EXPECT_THROW(net::SNAPSHOT::deserialize(bytes), std::runtime_error);
+    EXPECT_THROW(net::SNAPSHOT::View{bytes}, std::runtime_error);
+}
+
+TEST(GENERATED_MESSAGES, delta_sends_changed_fields) {
+    net::PLAYER_UPDATE baseline{};
+    baseline.player_id = 4;
+    baseline.pos_x = 12.5f;
+    baseline.score = 300;
+    baseline.health = 800;
+    baseline.alive = 1;
+    std::strcpy(baseline.name, "zed");
+
+    // ID, sequence, baseline, mask of the 5 fields and bit groups, then
+    // health and alive packed in 2 bytes
+    net::PLAYER_UPDATE update = baseline;
+    update.health = 750;
+    std::vector<uint8_t> bytes(update.serializedDeltaSize(baseline));
+    ASSERT_EQ(bytes.size(), 1u + 2 + 2 + 1 + 2);
+    ASSERT_EQ(update.serializeDeltaInto(baseline, {8, 6}, bytes), bytes.size());
+    EXPECT_EQ(bytes[5], 1 << 3);
+
+    net::DeltaHeader header = net::PLAYER_UPDATE::readDeltaHeader(bytes);
+    EXPECT_EQ(header.sequence, 8);
+    EXPECT_EQ(header.baseline, 6);
+    net::PLAYER_UPDATE decoded =
+        net::PLAYER_UPDATE::deserializeDelta(bytes, baseline);
+    EXPECT_EQ(decoded.health, 750);
+    EXPECT_EQ(decoded.score, 300u);
+    EXPECT_STREQ(decoded.name, "zed");
+    // the baseline is needed, deserialize only takes the whole form
+    EXPECT_THROW(net::PLAYER_UPDATE::deserialize(bytes), std::runtime_error);
+
+    // the whole form is the delta against an empty message
+    std::vector<uint8_t> whole = update.serialize();
+    EXPECT_EQ(whole.size(), update.serializedSize());
+    EXPECT_EQ(whole[5], 0x1F);
+    EXPECT_EQ(net::PLAYER_UPDATE::deserialize(whole).serialize(), whole);
+
+    // mask bits past the last field
+    bytes[5] |= 0x80;
+    EXPECT_THROW(net::PLAYER_UPDATE::deserializeDelta(bytes, baseline),
+        std::runtime_error);
+}
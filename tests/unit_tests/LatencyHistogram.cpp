@@ -0,0 +1,61 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** LatencyHistogram.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Network/LatencyHistogram.hpp"
+
+TEST(LATENCY_HISTOGRAM, percentiles_within_one_percent) {
+    net::LatencyHistogram histogram;
+    std::mt19937_64 rng(5);
+    std::vector<uint64_t> values;
+
+    // spread over many powers of two, from exact buckets to seconds in ns
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t value = rng() >> (rng() % 60 + 4);
+        values.push_back(value);
+        histogram.record(value);
+    }
+    std::sort(values.begin(), values.end());
+
+    for (double p : {0.0, 1.0, 50.0, 90.0, 99.0, 99.9, 100.0}) {
+        size_t rank = std::max<size_t>(
+            static_cast<size_t>(std::ceil(p / 100.0 * values.size())), 1);
+        double expected = static_cast<double>(values[rank - 1]);
+        double got = static_cast<double>(histogram.percentile(p));
+        EXPECT_GE(got, expected) << "p" << p;
+        EXPECT_LE(got, expected * 1.01 + 1) << "p" << p;
+    }
+    EXPECT_EQ(histogram.count(), values.size());
+    EXPECT_EQ(histogram.min(), values.front());
+    EXPECT_EQ(histogram.max(), values.back());
+}
+
+TEST(LATENCY_HISTOGRAM, merge_and_reset) {
+    net::LatencyHistogram a;
+    net::LatencyHistogram b;
+
+    for (uint64_t i = 1; i <= 100; ++i)
+        a.record(i);
+    for (uint64_t i = 101; i <= 200; ++i)
+        b.record(i);
+    a.merge(b);
+
+    EXPECT_EQ(a.count(), 200u);
+    EXPECT_EQ(a.percentile(50), 100u);
+    EXPECT_EQ(a.max(), 200u);
+    EXPECT_DOUBLE_EQ(a.mean(), 100.5);
+
+    a.reset();
+    EXPECT_EQ(a.count(), 0u);
+    EXPECT_EQ(a.percentile(99), 0u);
+    EXPECT_EQ(a.min(), 0u);
+}
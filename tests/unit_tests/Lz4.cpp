@@ -0,0 +1,163 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Lz4.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Network/Lz4.hpp"
+
+namespace {
+
+std::vector<uint8_t> bytesOf(const std::string& text) {
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+std::vector<uint8_t> compressed(const std::vector<uint8_t>& in,
+    std::span<const uint8_t> dictionary = {}, int level = 0) {
+    std::vector<uint8_t> out(in.size() + 64);
+
+    out.resize(net::lz4::compress(in, out, dictionary, level));
+    return out;
+}
+
+}  // namespace
+
+TEST(LZ4, same_block_whatever_came_before) {
+    std::vector<uint8_t> text = bytesOf(
+        "the server restarts in 5 minutes, the server restarts soon");
+    std::vector<uint8_t> other(4096);
+    for (size_t i = 0; i < other.size(); ++i)
+        other[i] = static_cast<uint8_t>(i * 7 % 13);
+
+    for (int level : {0, 9}) {
+        std::vector<uint8_t> first = compressed(text, {}, level);
+        compressed(other, {}, level);
+        EXPECT_EQ(compressed(text, {}, level), first);
+
+        std::vector<uint8_t> back(text.size());
+        ASSERT_TRUE(net::lz4::decompress(first, back));
+        EXPECT_EQ(back, text);
+    }
+}
+
+TEST(LZ4, dictionary_shrinks_small_blocks) {
+    static const std::string phrase =
+        "The server will restart in 5 minutes for maintenance. ";
+    // LZ4HC takes small and large dictionaries differently
+    static const std::vector<uint8_t> small = bytesOf(phrase);
+    static const std::vector<uint8_t> large =
+        bytesOf(std::string(4096, '-') + phrase);
+    std::vector<uint8_t> text = bytesOf(
+        "The server will restart in 5 minutes for maintenance.");
+
+    for (auto [level, dictionary] : {std::pair(0, &small),
+        std::pair(9, &small), std::pair(0, &large), std::pair(9, &large)}) {
+        std::vector<uint8_t> plain = compressed(text, {}, level);
+        std::vector<uint8_t> withDictionary =
+            compressed(text, *dictionary, level);
+        ASSERT_GT(withDictionary.size(), 0u);
+        EXPECT_LT(withDictionary.size(), plain.size() == 0 ? text.size() :
+            plain.size());
+        // the prepared context is reused for the next block
+        EXPECT_EQ(compressed(text, *dictionary, level), withDictionary);
+
+        std::vector<uint8_t> back(text.size());
+        ASSERT_TRUE(net::lz4::decompress(withDictionary, back, *dictionary));
+        EXPECT_EQ(back, text);
+        EXPECT_FALSE(net::lz4::decompress(withDictionary, back));
+    }
+}
+
+TEST(LZ4, rejects_what_does_not_fit) {
+    std::vector<uint8_t> text(256, 'a');
+    std::vector<uint8_t> block = compressed(text);
+    std::vector<uint8_t> tooSmall(4);
+
+    ASSERT_GT(block.size(), 0u);
+    EXPECT_EQ(net::lz4::compress(text, tooSmall), 0u);
+
+    std::vector<uint8_t> back(text.size() - 1);
+    EXPECT_FALSE(net::lz4::decompress(block, back));
+    back.resize(text.size() + 1);
+    EXPECT_FALSE(net::lz4::decompress(block, back));
+    back.resize(text.size());
+    block.pop_back();
+    EXPECT_FALSE(net::lz4::decompress(block, back));
+}
+
+TEST(LZ4, stream_round_trip_whatever_the_cuts) {
+    std::mt19937 rng(3);
+    std::vector<uint8_t> sent;
+    std::vector<uint8_t> wire;
+
+    for (int level : {0, 9}) {
+        net::lz4::StreamEncoder encoder(level);
+        net::lz4::StreamDecoder decoder;
+        sent.clear();
+        wire.clear();
+        // small packets repeating, and some larger than a block, for more
+        // than the ring buffers of both ends
+        for (int i = 0; i < 400; ++i) {
+            std::string packet = "player " + std::to_string(i % 7) +
+                " moved to " + std::to_string(rng() % 100);
+            if (i % 50 == 0)
+                packet += std::string(net::lz4::STREAM_BLOCK_SIZE + 100,
+                    static_cast<char>('a' + i % 26));
+            sent.insert(sent.end(), packet.begin(), packet.end());
+            encoder.compress(bytesOf(packet), wire);
+        }
+        EXPECT_LT(wire.size(), sent.size() / 4);
+
+        std::vector<uint8_t> received;
+        for (size_t offset = 0; offset < wire.size();) {
+            size_t size = std::min<size_t>(rng() % 100 + 1,
+                wire.size() - offset);
+            ASSERT_TRUE(decoder.decompress(
+                std::span(wire).subspan(offset, size), received));
+            offset += size;
+        }
+        EXPECT_EQ(decoder.pending(), 0u);
+        EXPECT_EQ(received, sent);
+    }
+}
+
+TEST(LZ4, stream_repeated_packet_takes_a_few_bytes) {
+    net::lz4::StreamEncoder encoder;
+    std::vector<uint8_t> packet = bytesOf(
+        "{\"type\":\"heartbeat\",\"session\":\"a81f\",\"ok\":true}");
+    std::vector<uint8_t> wire;
+
+    encoder.compress(packet, wire);
+    wire.clear();
+    encoder.compress(packet, wire);
+    EXPECT_LT(wire.size(), packet.size() / 3);
+}
+
+TEST(LZ4, stream_rejects_invalid_blocks) {
+    net::lz4::StreamEncoder encoder;
+    std::vector<uint8_t> wire;
+    std::vector<uint8_t> out;
+
+    encoder.compress(bytesOf("hello hello hello hello"), wire);
+    // a size larger than any block
+    net::lz4::StreamDecoder tooLarge;
+    EXPECT_FALSE(tooLarge.decompress(std::vector<uint8_t>{0xFF, 0xFF, 0x7F},
+        out));
+    // the first block copying from before the stream
+    net::lz4::StreamDecoder corrupted;
+    std::vector<uint8_t> bad = {3, 0x0F, 0xFF, 0xFF};
+    EXPECT_FALSE(corrupted.decompress(bad, out));
+    // and nothing is read once the stream is broken
+    EXPECT_FALSE(corrupted.decompress(wire, out));
+    EXPECT_TRUE(out.empty());
+}
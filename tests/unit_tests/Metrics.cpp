@@ -0,0 +1,184 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Metrics.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ProtocolFile.hpp"
+#include "Network/Client.hpp"
+#include "Network/Metrics.hpp"
+#include "Network/NetworkPlatform.hpp"
+#include "Network/Server.hpp"
+
+static std::string writeProtocol() {
+    return test_support::writeProtocol("net_metrics_protocol.json",
+        {.preamble = false, .datetime = false, .endOfPacket = false});
+}
+
+TEST(METRICS, registry_reads_live_values) {
+    net::Counter counter;
+    net::Gauge gauge;
+    net::MetricsRegistry registry;
+
+    registry.add("test_total", "A counter", counter);
+    registry.add("test_level", "A gauge", gauge);
+    counter.add();
+    counter.add(41);
+    gauge.set(10);
+    gauge.add(-15);
+
+    ASSERT_NE(registry.find("test_total"), nullptr);
+    EXPECT_EQ(registry.find("test_total")->type(),
+        net::MetricsRegistry::Type::COUNTER);
+    EXPECT_EQ(registry.find("test_total")->value(), 42);
+    EXPECT_EQ(registry.find("test_level")->type(),
+        net::MetricsRegistry::Type::GAUGE);
+    EXPECT_EQ(registry.find("test_level")->value(), -5);
+    EXPECT_EQ(registry.find("unknown"), nullptr);
+    EXPECT_EQ(registry.metrics().size(), 2u);
+}
+
+TEST(METRICS, server_counts_udp_traffic) {
+    std::string path = writeProtocol();
+    net::Server server(4261, "UDP", path, false);
+    net::Client client("UDP", path, false);
+    std::vector<uint8_t> payload = {1, 2, 3, 4, 5};
+
+    server.start();
+    server.setNonBlocking(true);
+    client.connect("127.0.0.1", 4261);
+    for (int i = 0; i < 3; ++i)
+        client.send(payload);
+
+    std::vector<net::Address> senders;
+    for (int tries = 0; tries < 50 && senders.size() < 3; ++tries) {
+        auto received = server.udpReceive(10, 10);
+        senders.insert(senders.end(), received.begin(), received.end());
+    }
+    ASSERT_EQ(senders.size(), 3u);
+
+    const net::Server::Metrics& metrics = server.getMetrics();
+    EXPECT_EQ(metrics.receives.value(), 3u);
+    EXPECT_EQ(metrics.bytesIn.value(), 3 * (payload.size() + 4));
+    EXPECT_EQ(metrics.clients.value(), 1);
+    EXPECT_EQ(metrics.inputQueueBytes.value(), 3 * (payload.size() + 4));
+    EXPECT_GE(metrics.syscallsLastReceive.value(), 2);
+
+    EXPECT_EQ(server.unpack(senders[0], -1).size(), 3u);
+    EXPECT_EQ(metrics.packetsIn.value(), 3u);
+    EXPECT_EQ(metrics.inputQueueBytes.value(), 0);
+
+    server.udpSend(senders[0], payload);
+    EXPECT_EQ(metrics.packetsOut.value(), 1u);
+    EXPECT_EQ(metrics.bytesOut.value(), payload.size() + 4);
+
+    const net::Server::ClientInfo* info =
+        server.getUdpClients().find(senders[0]);
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(info->bytesIn, 3 * (payload.size() + 4));
+    EXPECT_EQ(info->packetsIn, 3u);
+    EXPECT_EQ(info->bytesOut, payload.size() + 4);
+    EXPECT_EQ(info->packetsOut, 1u);
+    EXPECT_EQ(info->framingErrors, 0u);
+
+    auto talkers = server.getTopTalkers();
+    ASSERT_EQ(talkers.size(), 1u);
+    EXPECT_EQ(talkers[0].address, senders[0]);
+    EXPECT_EQ(talkers[0].bytes, 4 * (payload.size() + 4));
+
+    // reading the bandwidth no longer resets the counters
+    server.evalBandwidthUsage();
+    EXPECT_EQ(metrics.bytesIn.value(), 3 * (payload.size() + 4));
+    EXPECT_EQ(server.getMetricsRegistry()
+        .find("net_server_packets_in_total")->value(), 3);
+}
+
+TEST(METRICS, server_records_latencies) {
+    std::string path = writeProtocol();
+    net::Server server(4262, "UDP", path, false);
+    net::Client client("UDP", path, false);
+    std::vector<uint8_t> payload = {1, 2, 3, 4, 5};
+
+    EXPECT_EQ(server.getLatencies(), nullptr);
+    server.start();
+    server.setNonBlocking(true);
+    server.setLatencyTracking(true);
+    client.connect("127.0.0.1", 4262);
+    for (int i = 0; i < 3; ++i)
+        client.send(payload);
+
+    std::vector<net::Address> senders;
+    for (int tries = 0; tries < 50 && senders.size() < 3; ++tries) {
+        auto received = server.udpReceive(10, 10);
+        senders.insert(senders.end(), received.begin(), received.end());
+    }
+    ASSERT_EQ(senders.size(), 3u);
+    EXPECT_EQ(server.unpack(senders[0], -1).size(), 3u);
+    server.udpSend(senders[0], payload);
+
+    const net::Server::Latencies* latencies = server.getLatencies();
+    ASSERT_NE(latencies, nullptr);
+    EXPECT_EQ(latencies->receiveToUnpack.count(), 3u);
+    EXPECT_EQ(latencies->framedToUnpack.count(), 3u);
+    // a datagram is read whole
+    EXPECT_EQ(latencies->receiveToFramed.max(), 0u);
+    EXPECT_GT(latencies->receiveToUnpack.max(), 0u);
+    EXPECT_EQ(latencies->sendWrite.count(), 1u);
+    EXPECT_EQ(latencies->sendEnqueueToWrite.count(), 1u);
+
+    std::ostringstream dump;
+    server.dumpLatencies(dump);
+    EXPECT_NE(dump.str().find("receive_to_unpack"), std::string::npos);
+
+    server.resetLatencies();
+    EXPECT_EQ(latencies->receiveToUnpack.count(), 0u);
+    server.setLatencyTracking(false);
+    EXPECT_EQ(server.getLatencies(), nullptr);
+}
+
+TEST(METRICS, server_answers_scrapes) {
+    net::Server server(4263, "UDP", writeProtocol(), false);
+
+    ASSERT_TRUE(server.exposeMetrics(0));
+    ASSERT_NE(server.getMetricsPort(), 0);
+
+    SocketHandle scraper = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(server.getMetricsPort());
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(::connect(scraper, reinterpret_cast<sockaddr*>(&address),
+        sizeof(address)), 0);
+
+    std::string request = "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    ASSERT_EQ(::send(scraper, request.data(), request.size(), 0),
+        static_cast<int>(request.size()));
+
+    size_t answered = 0;
+    for (int tries = 0; tries < 100 && answered == 0; ++tries) {
+        answered += server.serveMetrics();
+        if (answered == 0)
+            ::poll(nullptr, 0, 5);
+    }
+    ASSERT_EQ(answered, 1u);
+
+    std::string response;
+    char buffer[4096];
+    int received;
+    while ((received = ::recv(scraper, buffer, sizeof(buffer), 0)) > 0)
+        response.append(buffer, received);
+    CLOSE_SOCKET(scraper);
+
+    EXPECT_TRUE(response.starts_with("HTTP/1.1 200 OK\r\n"));
+    EXPECT_NE(response.find("application/openmetrics-text"),
+        std::string::npos);
+    EXPECT_NE(response.find("\nnet_server_packets_in_total 0\n"),
+        std::string::npos);
+    EXPECT_TRUE(response.ends_with("# EOF\n"));
+}
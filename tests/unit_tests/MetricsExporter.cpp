@@ -0,0 +1,158 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** MetricsExporter.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Network/MetricsExporter.hpp"
+#include "Network/NetworkPlatform.hpp"
+
+TEST(METRICS_EXPORTER, renders_openmetrics_text) {
+    net::Counter counter;
+    net::Gauge gauge;
+    net::MetricsRegistry registry;
+    net::LatencyHistogram histogram;
+    std::string text;
+
+    registry.add("test_packets_total", "Packets", counter);
+    registry.add("test_clients", "Clients", gauge);
+    counter.add(12);
+    gauge.set(3);
+    histogram.record(2000);
+    histogram.record(4000);
+
+    net::MetricsExporter::renderRegistry(registry, text);
+    net::MetricsExporter::renderLabelledGauge("test_bytes", "Bytes",
+        "address", {{"127.0.0.1:\"x\"", 42}}, text);
+    net::MetricsExporter::renderSummary("test_latency_seconds", "Latency",
+        histogram, 1e-9, text);
+    net::MetricsExporter::renderEnd(text);
+
+    EXPECT_NE(text.find("# TYPE test_packets counter\n"), std::string::npos);
+    EXPECT_NE(text.find("\ntest_packets_total 12\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE test_clients gauge\n"), std::string::npos);
+    EXPECT_NE(text.find("\ntest_clients 3\n"), std::string::npos);
+    EXPECT_NE(text.find("test_bytes{address=\"127.0.0.1:\\\"x\\\"\"} 42\n"),
+        std::string::npos);
+    size_t median = text.find("test_latency_seconds{quantile=\"0.5\"} ");
+    ASSERT_NE(median, std::string::npos);
+    EXPECT_NEAR(std::stod(text.substr(median + 37)), 2e-6, 2e-8);
+    EXPECT_NE(text.find("test_latency_seconds_count 2\n"), std::string::npos);
+    EXPECT_TRUE(text.ends_with("# EOF\n"));
+}
+
+TEST(METRICS_EXPORTER, writes_file_atomically) {
+    std::filesystem::path path =
+        std::filesystem::temp_directory_path() / "net_metrics_test.prom";
+
+    ASSERT_TRUE(net::MetricsExporter::writeFile(path.string(), "first\n"));
+    ASSERT_TRUE(net::MetricsExporter::writeFile(path.string(), "second\n"));
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    EXPECT_EQ(content.str(), "second\n");
+    EXPECT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+    std::filesystem::remove(path);
+}
+
+static SocketHandle connectTo(uint16_t port) {
+    SocketHandle scraper = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(scraper, reinterpret_cast<sockaddr*>(&address),
+        sizeof(address)) != 0) {
+        CLOSE_SOCKET(scraper);
+        return INVALID_SOCKET_VALUE;
+    }
+    return scraper;
+}
+
+TEST(METRICS_EXPORTER, endpoint_expires_idle_scrapers) {
+    net::MetricsEndpoint endpoint(0);
+    auto render = [](std::string& out) { out += "# EOF\n"; };
+    std::vector<SocketHandle> idle;
+
+    for (int i = 0; i < METRICS_MAX_SCRAPERS; ++i) {
+        idle.push_back(connectTo(endpoint.getPort()));
+        ASSERT_NE(idle.back(), INVALID_SOCKET_VALUE);
+    }
+    for (int tries = 0; tries < 10; ++tries) {
+        endpoint.serve(render);
+        ::poll(nullptr, 0, 5);
+    }
+    // nothing readable on any socket, they expire all the same
+    std::this_thread::sleep_for(METRICS_SCRAPE_TIMEOUT +
+        std::chrono::milliseconds(100));
+    EXPECT_EQ(endpoint.serve(render), 0u);
+    char byte;
+    for (SocketHandle socket : idle) {
+        POLLFD closed = {static_cast<POLL_FD_TYPE>(socket), POLL_IN, 0};
+        ASSERT_EQ(PollSockets(&closed, 1, 100), 1);
+        EXPECT_EQ(::recv(socket, &byte, 1, 0), 0);
+        CLOSE_SOCKET(socket);
+    }
+
+    SocketHandle scraper = connectTo(endpoint.getPort());
+    ASSERT_NE(scraper, INVALID_SOCKET_VALUE);
+    std::string request = "GET /metrics HTTP/1.1\r\n\r\n";
+    ASSERT_EQ(::send(scraper, request.data(), request.size(), 0),
+        static_cast<int>(request.size()));
+    size_t answered = 0;
+    for (int tries = 0; tries < 100 && answered == 0; ++tries) {
+        answered += endpoint.serve(render);
+        if (answered == 0)
+            ::poll(nullptr, 0, 5);
+    }
+    EXPECT_EQ(answered, 1u);
+    CLOSE_SOCKET(scraper);
+}
+
+TEST(METRICS_EXPORTER, endpoint_finishes_slow_scrapes) {
+    net::MetricsEndpoint endpoint(0);
+    std::string body(8 << 20, 'x');
+    int renders = 0;
+    auto render = [&](std::string& out) { out += body; renders++; };
+
+    SocketHandle scraper = connectTo(endpoint.getPort());
+    ASSERT_NE(scraper, INVALID_SOCKET_VALUE);
+    std::string request = "GET /metrics HTTP/1.1\r\n\r\n";
+    ASSERT_EQ(::send(scraper, request.data(), request.size(), 0),
+        static_cast<int>(request.size()));
+
+    // nobody reads yet: serve sends what fits and returns
+    for (int tries = 0; tries < 100 && renders == 0; ++tries) {
+        EXPECT_EQ(endpoint.serve(render), 0u);
+        if (renders == 0)
+            ::poll(nullptr, 0, 5);
+    }
+    ASSERT_EQ(renders, 1);
+
+    std::string response;
+    char buffer[65536];
+    size_t answered = 0;
+    int received = 1;
+    while (received > 0) {
+        answered += endpoint.serve(render);
+        received = ::recv(scraper, buffer, sizeof(buffer), 0);
+        if (received > 0)
+            response.append(buffer, received);
+    }
+    CLOSE_SOCKET(scraper);
+
+    EXPECT_EQ(answered, 1u);
+    EXPECT_EQ(renders, 1);
+    EXPECT_TRUE(response.starts_with("HTTP/1.1 200 OK\r\n"));
+    EXPECT_TRUE(response.ends_with("\r\n\r\n" + body));
+}
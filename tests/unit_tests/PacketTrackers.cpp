@@ -0,0 +1,97 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** PacketTrackers.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ProtocolFile.hpp"
+#include "Network/Client.hpp"
+
+// Trackers run on the steady clock: expected times are kept short and the
+// waits well past the deadlines, so scheduling noise can't flip a result.
+
+static std::string writeProtocol() {
+    return test_support::writeProtocol("net_trackers_protocol.json");
+}
+
+static void waitMilliseconds(int milliseconds) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+TEST(PACKET_TRACKERS, armed_trackers_wait_twice_the_expected_time) {
+    net::Client client("UDP", writeProtocol(), false);
+    std::vector<uint8_t> missed;
+
+    ASSERT_TRUE(client.initPacketTrackers({{7, 200}},
+        [&](uint8_t code) { missed.push_back(code); }));
+    waitMilliseconds(20);
+    client.checkPacketTrackers();
+    EXPECT_TRUE(missed.empty());
+    EXPECT_EQ(client.getPacketTrackerStats(7).misses, 0u);
+}
+
+TEST(PACKET_TRACKERS, missed_code_fires_once_per_period) {
+    net::Client client("UDP", writeProtocol(), false);
+    std::vector<uint8_t> missed;
+
+    client.initPacketTrackers({{3, 10}, {4, 1000}},
+        [&](uint8_t code) { missed.push_back(code); });
+    waitMilliseconds(50);
+    client.checkPacketTrackers();
+    ASSERT_EQ(missed, std::vector<uint8_t>{3});
+    EXPECT_EQ(client.getPacketTrackerStats(3).misses, 1u);
+
+    // not again before another period went by
+    client.checkPacketTrackers();
+    EXPECT_EQ(missed.size(), 1u);
+    waitMilliseconds(50);
+    client.checkPacketTrackers();
+    EXPECT_EQ(missed, (std::vector<uint8_t>{3, 3}));
+    EXPECT_EQ(client.getPacketTrackerStats(3).misses, 2u);
+    EXPECT_EQ(client.getPacketTrackerStats(4).misses, 0u);
+}
+
+TEST(PACKET_TRACKERS, received_code_restarts_its_deadline) {
+    net::Client client("UDP", writeProtocol(), false);
+    int missed = 0;
+
+    client.initPacketTrackers({{9, 40}}, [&](uint8_t) { missed++; });
+    // received more often than every 80 ms, it is never missed
+    for (int i = 0; i < 6; ++i) {
+        waitMilliseconds(20);
+        EXPECT_TRUE(client.markPacketCode(9));
+        client.checkPacketTrackers();
+    }
+    EXPECT_EQ(missed, 0);
+    EXPECT_EQ(client.getPacketTrackerStats(9).received, 6u);
+    EXPECT_EQ(client.getPacketTrackerStats(9).misses, 0u);
+
+    // tracking it again keeps its deadline and its counts
+    client.initPacketTrackers({{9, 1}}, [&](uint8_t) { missed++; });
+    waitMilliseconds(20);
+    client.checkPacketTrackers();
+    EXPECT_EQ(missed, 0);
+    EXPECT_EQ(client.getPacketTrackerStats(9).received, 6u);
+}
+
+TEST(PACKET_TRACKERS, untracked_codes_are_only_counted) {
+    net::Client client("UDP", writeProtocol(), false);
+
+    EXPECT_EQ(client.getPacketTrackerStats(1).received, 0u);
+    EXPECT_EQ(client.getPacketTrackerStats(1).misses, 0u);
+    EXPECT_FALSE(client.markPacketCode(1));
+    EXPECT_FALSE(client.markPacketCode(1));
+    client.checkPacketTrackers();
+    EXPECT_EQ(client.getPacketTrackerStats(1).received, 2u);
+    EXPECT_EQ(client.getPacketTrackerStats(1).misses, 0u);
+    // a new client starts from zero
+    net::Client other("UDP", writeProtocol(), false);
+    EXPECT_EQ(other.getPacketTrackerStats(1).received, 0u);
+}
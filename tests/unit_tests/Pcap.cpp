@@ -0,0 +1,94 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Pcap.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Network/Pcap.hpp"
+
+static std::string tempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+TEST(PCAP, pcapng_round_trip) {
+    std::string path = tempPath("net_pcap_test.pcapng");
+    net::Address client("10.0.0.2", 51000);
+    net::Address server("127.0.0.1", 4242);
+    std::vector<uint8_t> hello = {1, 2, 3};
+    std::vector<uint8_t> big(70000, 7);
+
+    {
+        net::PcapWriter writer(path);
+        writer.write(net::SocketType::UDP, client, server, hello, 1000);
+        writer.write(net::SocketType::TCP, server, client, big, 2000);
+        EXPECT_EQ(writer.getPacketCount(), 3u);
+    }
+
+    net::PcapReader reader(path);
+    net::PcapReader::Packet packet;
+
+    ASSERT_TRUE(reader.next(packet));
+    EXPECT_EQ(packet.timestamp, 1000u);
+    EXPECT_EQ(packet.type, net::SocketType::UDP);
+    EXPECT_EQ(packet.source, client);
+    EXPECT_EQ(packet.destination, server);
+    EXPECT_EQ(packet.data, hello);
+
+    // split in two records, too big for one IPv4 packet
+    size_t total = 0;
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_TRUE(reader.next(packet));
+        EXPECT_EQ(packet.timestamp, 2000u);
+        EXPECT_EQ(packet.type, net::SocketType::TCP);
+        EXPECT_EQ(packet.source, server);
+        total += packet.data.size();
+    }
+    EXPECT_EQ(total, big.size());
+    EXPECT_FALSE(reader.next(packet));
+    std::filesystem::remove(path);
+}
+
+TEST(PCAP, reads_tcpdump_ethernet_pcap) {
+    std::string path = tempPath("net_pcap_test.pcap");
+    std::vector<uint8_t> file = {
+        // little endian, microseconds, Ethernet
+        0xD4, 0xC3, 0xB2, 0xA1, 2, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0xFF, 0xFF, 0, 0, 1, 0, 0, 0,
+        // record: 3s 5us, 14 + 20 + 8 + 2 bytes
+        3, 0, 0, 0, 5, 0, 0, 0, 44, 0, 0, 0, 44, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x08, 0x00,
+        0x45, 0, 0, 30, 0, 0, 0x40, 0, 64, 17, 0, 0,
+        192, 168, 1, 5, 192, 168, 1, 1,
+        0x13, 0x88, 0x10, 0x92, 0, 10, 0, 0,
+        0xAB, 0xCD,
+    };
+    std::ofstream(path, std::ios::binary).write(
+        reinterpret_cast<const char*>(file.data()), file.size());
+
+    net::PcapReader reader(path);
+    net::PcapReader::Packet packet;
+
+    ASSERT_TRUE(reader.next(packet));
+    EXPECT_EQ(packet.timestamp, 3000005000u);
+    EXPECT_EQ(packet.type, net::SocketType::UDP);
+    EXPECT_EQ(packet.source, net::Address("192.168.1.5", 5000));
+    EXPECT_EQ(packet.destination, net::Address("192.168.1.1", 4242));
+    EXPECT_EQ(packet.data, std::vector<uint8_t>({0xAB, 0xCD}));
+    EXPECT_FALSE(reader.next(packet));
+    std::filesystem::remove(path);
+}
+
+TEST(PCAP, rejects_other_files) {
+    std::string path = tempPath("net_pcap_test.txt");
+    std::ofstream(path) << "not a capture file at all";
+
+    EXPECT_THROW(net::PcapReader reader(path), net::PcapReader::BadCapture);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,60 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** TimerWheel.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "Network/TimerWheel.hpp"
+
+TEST(TIMER_WHEEL, fires_once_never_early_never_late) {
+    net::TimerWheel wheel(1, 1000);
+    std::mt19937_64 rng(3);
+    std::vector<uint64_t> deadlines;
+    std::vector<int> fired;
+
+    // every level, plus deadlines beyond the wheel range
+    for (uint64_t i = 0; i < 5000; ++i) {
+        uint64_t span = 1ULL << (6 * (i % 5) + 1);
+        deadlines.push_back(1000 + 1 + rng() % span);
+        wheel.schedule(i, deadlines.back());
+    }
+    fired.assign(deadlines.size(), 0);
+
+    uint64_t now = 1000;
+    while (wheel.size() > 0) {
+        now += 1 + rng() % 5000;
+        wheel.advance(now, [&](uint64_t id) {
+            EXPECT_LE(deadlines[id], now);
+            EXPECT_EQ(0, fired[id]);
+            fired[id]++;
+        });
+        for (size_t id = 0; id < deadlines.size(); ++id) {
+            if (deadlines[id] <= now) {
+                ASSERT_EQ(1, fired[id]) << "timer " << id << " is late";
+            }
+        }
+    }
+}
+
+TEST(TIMER_WHEEL, reschedule_from_callback) {
+    net::TimerWheel wheel(10, 0);
+    int fired = 0;
+
+    wheel.schedule(1, 25);
+    wheel.advance(20, [&](uint64_t) { fired++; });
+    EXPECT_EQ(0, fired);
+    wheel.advance(30, [&](uint64_t id) {
+        fired++;
+        wheel.schedule(id, 100);
+    });
+    EXPECT_EQ(1, fired);
+    EXPECT_EQ(1u, wheel.size());
+    wheel.advance(100, [&](uint64_t) { fired++; });
+    EXPECT_EQ(2, fired);
+    EXPECT_EQ(0u, wheel.size());
+}
@@ -0,0 +1,58 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** TopTalkers.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+
+#include "Network/TopTalkers.hpp"
+
+TEST(TOP_TALKERS, exact_below_capacity) {
+    net::TopTalkers talkers(4);
+
+    talkers.add(1, 10);
+    talkers.add(2, 30);
+    talkers.add(1, 5);
+    talkers.add(3, 20);
+
+    auto top = talkers.top(10);
+    ASSERT_EQ(top.size(), 3u);
+    EXPECT_EQ(top[0].key, 2u);
+    EXPECT_EQ(top[0].count, 30u);
+    EXPECT_EQ(top[1].key, 3u);
+    EXPECT_EQ(top[2].key, 1u);
+    EXPECT_EQ(top[2].count, 15u);
+    EXPECT_EQ(top[2].error, 0u);
+    EXPECT_EQ(talkers.total(), 65u);
+    EXPECT_EQ(talkers.top(1).size(), 1u);
+
+    talkers.clear();
+    EXPECT_TRUE(talkers.top(10).empty());
+}
+
+TEST(TOP_TALKERS, finds_heavy_hitters_among_noise) {
+    net::TopTalkers talkers(16);
+    std::map<uint64_t, uint64_t> real;
+    std::mt19937_64 rng(7);
+
+    // 3 heavy keys over thousands of light ones
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t key = (i % 4 == 0) ? 1 + (i / 4) % 3 : 100 + rng() % 5000;
+        uint64_t weight = 1 + rng() % 100;
+        talkers.add(key, weight);
+        real[key] += weight;
+    }
+
+    auto top = talkers.top(3);
+    ASSERT_EQ(top.size(), 3u);
+    for (auto& entry : top) {
+        EXPECT_GE(entry.key, 1u);
+        EXPECT_LE(entry.key, 3u);
+        EXPECT_GE(entry.count, real[entry.key]);
+        EXPECT_LE(entry.count - entry.error, real[entry.key]);
+    }
+}
@@ -0,0 +1,77 @@
+/*
+** EPITECH PROJECT, 2025
+** Network
+** File description:
+** Varint.cpp
+*/
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Network/Varint.hpp"
+
+TEST(VARINT, sizes) {
+    EXPECT_EQ(net::varint::size(0), 1u);
+    EXPECT_EQ(net::varint::size(127), 1u);
+    EXPECT_EQ(net::varint::size(128), 2u);
+    EXPECT_EQ(net::varint::size(16383), 2u);
+    EXPECT_EQ(net::varint::size(16384), 3u);
+    EXPECT_EQ(net::varint::size(UINT64_MAX), net::varint::MAX_SIZE);
+}
+
+TEST(VARINT, zigzag_keeps_small_values_short) {
+    EXPECT_EQ(net::varint::zigzag(0), 0u);
+    EXPECT_EQ(net::varint::zigzag(-1), 1u);
+    EXPECT_EQ(net::varint::zigzag(1), 2u);
+    EXPECT_EQ(net::varint::zigzag(-64), 127u);
+    for (int64_t value : {int64_t{0}, int64_t{-1}, int64_t{12345},
+        std::numeric_limits<int64_t>::min(),
+        std::numeric_limits<int64_t>::max()}) {
+        EXPECT_EQ(net::varint::unzigzag(net::varint::zigzag(value)), value);
+    }
+}
+
+TEST(VARINT, round_trip) {
+    std::vector<uint64_t> values = {0, 1, 127, 128, 300, 1u << 21,
+        uint64_t{1} << 35, UINT64_MAX - 1, UINT64_MAX};
+
+    for (uint64_t value : values) {
+        std::vector<uint8_t> bytes(net::varint::MAX_SIZE + 1, 0xEE);
+        size_t written = net::varint::write(bytes.data(), value);
+        ASSERT_EQ(written, net::varint::size(value));
+        EXPECT_EQ(bytes[written], 0xEE);
+
+        uint64_t read = 0;
+        EXPECT_EQ(net::varint::read(bytes, 0, read), written);
+        EXPECT_EQ(read, value);
+        read = 0;
+        EXPECT_EQ(net::varint::readUnchecked(bytes.data(), read), written);
+        EXPECT_EQ(read, value);
+    }
+}
+
+TEST(VARINT, rejects_truncated_and_overlong) {
+    std::vector<uint8_t> bytes(net::varint::MAX_SIZE);
+    uint64_t value = 42;
+
+    size_t written = net::varint::write(bytes.data(), 1u << 20);
+    for (size_t size = 0; size < written; ++size) {
+        EXPECT_EQ(net::varint::read(std::span(bytes).first(size), 0, value),
+            0u);
+    }
+    EXPECT_EQ(net::varint::read(bytes, bytes.size(), value), 0u);
+
+    // more than 64 bits
+    std::vector<uint8_t> overflow(9, 0xFF);
+    overflow.push_back(0x02);
+    EXPECT_EQ(net::varint::read(overflow, 0, value), 0u);
+    // 1 written on two bytes
+    std::vector<uint8_t> padded = {0x81, 0x00};
+    EXPECT_EQ(net::varint::read(padded, 0, value), 0u);
+    // more than ten bytes
+    std::vector<uint8_t> endless(12, 0x80);
+    EXPECT_EQ(net::varint::read(endless, 0, value), 0u);
+    EXPECT_EQ(value, 42u);
+}
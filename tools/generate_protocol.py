@@ -1,5 +1,6 @@
 #!/usr/bin/env python3
 import json
+import math
 import sys
 from pathlib import Path
 
@@ -28,11 +29,214 @@ def load_protocol(json_path: str) -> dict:
         sys.exit(1)
 
 
+INTEGER_TYPES = ["uint8", "uint16", "uint32", "uint64", "int8", "int16", "int32", "int64"]
+
+
+def field_encoding(field: dict) -> str:
+    """Wire encoding of a field: fixed (default), varlen or varint"""
+    return field.get("encoding", "fixed")
+
+
+def is_varlen(field: dict) -> bool:
+    return field["type"] == "string" and field_encoding(field) == "varlen"
+
+
+def is_varint(field: dict) -> bool:
+    return field["type"] in INTEGER_TYPES and field_encoding(field) == "varint"
+
+
+def is_valid_encoding(field: dict) -> bool:
+    """varlen for strings, varint for integers, fixed for anything"""
+    encoding = field_encoding(field)
+    if encoding == "fixed" or is_varlen(field) or is_varint(field):
+        return True
+    print(f"Error: Invalid encoding '{encoding}' for field '{field['name']}'")
+    return False
+
+
+BIT_TYPES = ["bits", "quantized_float"]
+
+
+def is_bit_field(field: dict) -> bool:
+    return field["type"] in BIT_TYPES
+
+
+def float_ulp(value: float) -> float:
+    """Distance between a float and the next one"""
+    return 2.0 ** (math.frexp(value)[1] - 24) if value else 2.0**-149
+
+
+def is_valid_bit_field(field: dict) -> bool:
+    """bits: 1 to 64, quantized_float: 1 to 32 bits over min < max, with
+    steps a float can hold"""
+    name = field["name"]
+    bits = field.get("bits")
+    max_bits = 64 if field["type"] == "bits" else 32
+    if not isinstance(bits, int) or isinstance(bits, bool) or not 1 <= bits <= max_bits:
+        print(f"Error: '{name}' needs 'bits' between 1 and {max_bits}")
+        return False
+    if field["type"] == "bits":
+        return True
+
+    low = field.get("min")
+    high = field.get("max")
+    if not all(isinstance(v, (int, float)) and not isinstance(v, bool) for v in [low, high]):
+        print(f"Error: quantized_float '{name}' needs numeric 'min' and 'max'")
+        return False
+    if low >= high:
+        print(f"Error: quantized_float '{name}' needs 'min' below 'max'")
+        return False
+    # a step finer than a float would not read back to the same integer
+    step = (high - low) / ((1 << bits) - 1)
+    if step < 2 * float_ulp(max(abs(low), abs(high))):
+        print(f"Error: quantized_float '{name}' has more bits than a float holds over its range")
+        return False
+    return True
+
+
+def field_cpp_type(field: dict) -> str:
+    """C++ type of a scalar field, bit fields included"""
+    if field["type"] == "quantized_float":
+        return "float"
+    if field["type"] == "bits":
+        for size in [8, 16, 32]:
+            if field["bits"] <= size:
+                return f"uint{size}_t"
+        return "uint64_t"
+    return TYPE_MAP[field["type"]]
+
+
+def group_bit_fields(fields: list) -> list:
+    """Fields of a message or struct with each run of bit fields merged in a
+    bit_group item, packed together on whole bytes"""
+    items = []
+    for field in fields:
+        if not is_bit_field(field):
+            items.append(field)
+            continue
+        if not items or items[-1]["type"] != "bit_group":
+            items.append({"type": "bit_group", "name": field["name"], "fields": [], "bits": 0})
+        items[-1]["fields"].append(field)
+        items[-1]["bits"] += field["bits"]
+    for item in items:
+        if item["type"] == "bit_group":
+            item["size"] = (item["bits"] + 7) // 8
+    return items
+
+
+# LZ4_MAX_INPUT_SIZE, lz4::MAX_BLOCK_SIZE
+LZ4_MAX_BLOCK_SIZE = 0x7E000000
+
+
+def varint_size(value: int) -> int:
+    """Bytes of value as a varint, 7 bits per byte"""
+    return max(1, (value.bit_length() + 6) // 7)
+
+
+def is_delta(msg: dict) -> bool:
+    return msg.get("delta", False)
+
+
+def has_view(msg: dict) -> bool:
+    """Compressed and delta messages are read with deserialize only"""
+    return not msg.get("compressed", False) and not is_delta(msg)
+
+
+def is_valid_compression(msg: dict) -> bool:
+    """Check the options of a compressed message"""
+    options = [
+        "compress_min_size", "compression_level", "dictionary",
+        "max_uncompressed_size",
+    ]
+    if not msg.get("compressed", False):
+        for option in options:
+            if option in msg:
+                print(f"Error: '{option}' needs \"compressed\": true")
+                return False
+        return True
+
+    min_size = msg.get("compress_min_size", 0)
+    if not isinstance(min_size, int) or isinstance(min_size, bool) or min_size < 0:
+        print("Error: 'compress_min_size' must be a positive integer")
+        return False
+    level = msg.get("compression_level", 0)
+    if not isinstance(level, int) or isinstance(level, bool) or not 0 <= level <= 12:
+        print("Error: 'compression_level' must be 1 to 12 (LZ4HC), or 0 for LZ4")
+        return False
+    if "dictionary" in msg and not isinstance(msg["dictionary"], str):
+        print("Error: 'dictionary' must be the path of a file")
+        return False
+    max_size = msg.get("max_uncompressed_size", 1)
+    if (
+        not isinstance(max_size, int) or isinstance(max_size, bool)
+        or not 1 <= max_size <= LZ4_MAX_BLOCK_SIZE
+    ):
+        print("Error: 'max_uncompressed_size' must be 1 to 2113929216 bytes")
+        return False
+    return True
+
+
+def max_fields_size(fields: list, structs: dict):
+    """Most bytes the fields of a message take on the wire, None if a
+    dynamic_array leaves it unbounded"""
+    size = 0
+    for field in group_bit_fields(fields):
+        field_type = field["type"]
+        if field_type == "dynamic_array":
+            return None
+        if is_varlen(field):
+            size += varint_size(field["max_length"]) + field["max_length"]
+        elif is_varint(field):
+            # 7 bits per byte
+            size += (SCALAR_SIZES[field_type] * 8 + 6) // 7
+        elif field_type == "fixed_array":
+            size += field["max_size"] * element_wire_size(
+                field["element_type"], structs, field)
+        else:
+            size += emit_size_field(field, fields, structs)[0]
+    return size
+
+
+def max_uncompressed_size(msg: dict, structs: dict) -> int:
+    """Largest fields a compressed message accepts: its
+    "max_uncompressed_size", else the most its fields can take"""
+    bound = max_fields_size(msg["fields"], structs)
+    if "max_uncompressed_size" in msg:
+        limit = msg["max_uncompressed_size"]
+        return limit if bound is None else min(limit, bound)
+    return bound
+
+
+def load_dictionaries(protocol: dict, json_path: str):
+    """Read the dictionary of every compressed message, a path relative to
+    protocol.json, into its "dictionary_bytes" """
+    base = Path(json_path).parent
+    for msg_name, msg_data in protocol["messages"].items():
+        if "dictionary" not in msg_data:
+            continue
+        path = base / msg_data["dictionary"]
+        try:
+            content = path.read_bytes()
+        except OSError as e:
+            print(f"Error: Dictionary of {msg_name}: {e}")
+            sys.exit(1)
+        # LZ4 only looks 64 KB back
+        if not 0 < len(content) <= 65536:
+            print(f"Error: Dictionary of {msg_name} must hold 1 byte to 64 KB")
+            sys.exit(1)
+        msg_data["dictionary_bytes"] = content
+
+
 def is_valid_msg(msg: dict, list_id: list, structs: dict) -> bool:
     """Check if a packet definition is valid"""
     if "id" not in msg or not isinstance(msg["id"], int):
         return False
 
+    # written as a single byte, first of the message
+    if not 0 <= msg["id"] <= 255:
+        print(f"Error: Message ID {msg['id']} does not fit in a byte")
+        return False
+
     if msg["id"] in list_id:
         return False
 
@@ -42,6 +246,21 @@ def is_valid_msg(msg: dict, list_id: list, structs: dict) -> bool:
     if "compressed" in msg and not isinstance(msg["compressed"], bool):
         return False
 
+    if not is_valid_compression(msg):
+        return False
+
+    if "delta" in msg and not isinstance(msg["delta"], bool):
+        return False
+
+    if is_delta(msg) and msg.get("compressed", False):
+        print("Error: A message can't be both delta and compressed")
+        return False
+
+    # one bit of the changed fields mask per field or bit group
+    if is_delta(msg) and len(group_bit_fields(msg["fields"])) > 64:
+        print("Error: A delta message has at most 64 fields")
+        return False
+
     for field in msg["fields"]:
         if "name" not in field or not isinstance(field["name"], str):
             return False
@@ -51,9 +270,17 @@ def is_valid_msg(msg: dict, list_id: list, structs: dict) -> bool:
 
         field_type = field["type"]
 
+        if not is_valid_encoding(field):
+            return False
+
         if field_type in TYPE_MAP:
             continue
 
+        if is_bit_field(field):
+            if not is_valid_bit_field(field):
+                return False
+            continue
+
         if field_type == "string":
             if (
                 "max_length" not in field
@@ -112,6 +339,12 @@ def is_valid_msg(msg: dict, list_id: list, structs: dict) -> bool:
         print(f"Error: Unknown type '{field_type}' for field '{field['name']}'")
         return False
 
+    # deserialize checks the size of the fields before decompressing them
+    if msg.get("compressed", False) and max_uncompressed_size(msg, structs) is None:
+        print("Error: A compressed message with a dynamic_array needs "
+              "'max_uncompressed_size'")
+        return False
+
     return True
 
 
@@ -154,6 +387,13 @@ def validate_structs(protocol: dict) -> bool:
 
             field_type = field["type"]
 
+            # struct elements have a fixed size
+            if field_encoding(field) != "fixed":
+                print(
+                    f"Error: Field '{field['name']}' of struct '{struct_name}' must have a fixed encoding"
+                )
+                return False
+
             if field_type == "fixed_array":
                 if "element_type" not in field:
                     print(
@@ -179,6 +419,9 @@ def validate_structs(protocol: dict) -> bool:
                         f"Error: Unknown element_type '{element_type}' for fixed_array in struct '{struct_name}'"
                     )
                     return False
+            elif is_bit_field(field):
+                if not is_valid_bit_field(field):
+                    return False
             elif field_type not in TYPE_MAP and field_type != "string":
                 print(f"Error: Unknown type '{field_type}' in struct '{struct_name}'")
                 return False
@@ -238,7 +481,7 @@ def generate_struct_definition(
 
             output += f"    {cpp_type} {field_name}[{max_size}];\n"
         else:
-            output += f"    {TYPE_MAP[field_type]} {field_name};\n"
+            output += f"    {field_cpp_type(field)} {field_name};\n"
 
     output += "};\n\n"
 
@@ -249,8 +492,17 @@ def generate_struct_declaration(msg_name: str, msg_data: dict, structs: dict) ->
     """Generate a struct from a packet definition"""
     output = ""
 
+    if has_view(msg_data):
+        output += f"class {msg_name}View;\n\n"
     output += f"struct {msg_name} {{\n"
-    output += f"    static constexpr uint32_t ID = {msg_data['id']};\n\n"
+    output += f"    static constexpr uint32_t ID = {msg_data['id']};\n"
+    if msg_data.get("compressed", False):
+        output += "    // most bytes the fields decompress to, a larger size is rejected\n"
+        output += "    static constexpr size_t MAX_UNCOMPRESSED_SIZE = "
+        output += f"{max_uncompressed_size(msg_data, structs)};\n"
+    if has_view(msg_data):
+        output += f"    using View = {msg_name}View;\n"
+    output += "\n"
 
     for field in msg_data["fields"]:
         field_name = field["name"]
@@ -294,35 +546,57 @@ def generate_struct_declaration(msg_name: str, msg_data: dict, structs: dict) ->
             output += f"    std::vector<{cpp_type}> {field_name};\n"
 
         else:
-            output += f"    {TYPE_MAP[field_type]} {field_name};\n"
+            output += f"    {field_cpp_type(field)} {field_name};\n"
 
     output += "\n"
+    output += "    // exact size of the wire form, an upper bound when compressed\n"
+    output += "    size_t serializedSize() const;\n"
+    output += "    // out holds at least serializedSize() bytes, returns the bytes written\n"
+    output += "    size_t serializeInto(std::span<uint8_t> out) const;\n"
     output += "    std::vector<uint8_t> serialize() const;\n"
     output += f"    static {msg_name} deserialize(const std::vector<uint8_t>& data);\n"
+    output += "    // scratch holds compressed fields while they are decoded, a per-thread\n"
+    output += "    // buffer when null\n"
+    output += f"    static {msg_name} deserialize(std::span<const uint8_t> data,\n"
+    output += "        std::pmr::memory_resource* scratch = nullptr);\n"
+    if is_delta(msg_data):
+        output += "\n"
+        output += "    // only the fields changed since a baseline both ends hold, see\n"
+        output += "    // Network/Delta.hpp; serialize is the delta against an empty message\n"
+        output += f"    size_t serializedDeltaSize(const {msg_name}& baseline) const;\n"
+        output += f"    size_t serializeDeltaInto(const {msg_name}& baseline, DeltaHeader header,\n"
+        output += "        std::span<uint8_t> out) const;\n"
+        output += "    static DeltaHeader readDeltaHeader(std::span<const uint8_t> data);\n"
+        output += f"    static {msg_name} deserializeDelta(std::span<const uint8_t> data,\n"
+        output += f"        const {msg_name}& baseline);\n"
     output += "};\n\n"
 
     return output
 
 
-def generate_header(protocol: dict) -> str:
+def generate_header(protocol: dict, endianness: str) -> str:
     """Generate a file with all structs definition"""
     output = ""
     output += "#pragma once\n"
+    output += "#include <bit>\n"
     output += "#include <cstdint>\n"
+    output += "#include <functional>\n"
+    output += "#include <tuple>\n"
+    output += "#include <utility>\n"
     output += "#include <vector>\n"
-    output += "#include <cstring>\n\n"
+    output += "#include <cstring>\n"
+    output += "#include <memory_resource>\n"
+    output += "#include <ranges>\n"
+    output += "#include <span>\n\n"
+    output += "#include <stdexcept>\n"
     output += "#include <string>\n"
-
-    needs_lz4 = False
-    for msg_name, msg_data in protocol["messages"].items():
-        if msg_data.get("compressed", False):
-            needs_lz4 = True
-            break
-
-    if needs_lz4:
-        output += "#include <lz4.h>\n"
+    output += "#include <string_view>\n"
+    output += "#include <type_traits>\n"
 
     output += "\n"
+    output += '#include "Network/BitStream.hpp"\n'
+    output += '#include "Network/Delta.hpp"\n'
+    output += '#include "Network/Varint.hpp"\n\n'
     output += "namespace net {\n\n"
 
     if "structs" in protocol:
@@ -337,27 +611,41 @@ def generate_header(protocol: dict) -> str:
     for msg_name, msg_data in protocol["messages"].items():
         output += generate_struct_declaration(msg_name, msg_data, structs)
 
-    output += "}  // namespace net\n"
+    output += "// ===== Views =====\n\n"
+    output += generate_view_helpers(endianness)
+    for msg_name, msg_data in protocol["messages"].items():
+        if has_view(msg_data):
+            output += generate_view_declaration(msg_name, msg_data, structs)
 
-    return output
+    output += "// ===== Dispatch =====\n\n"
+    output += generate_dispatcher(protocol)
 
+    output += "}  // namespace net\n\n"
 
-def write_uint_bytes(field_name: str, num_bytes: int, endianness: str) -> str:
-    """Generate code to write unsigned integer in specified endianness"""
-    output = ""
+    output += "// Every message of the protocol as X(name, id), to generate code\n"
+    output += "// over all of them (fuzz targets, dispatch)\n"
+    output += "#define NET_GENERATED_MESSAGES(X) \\\n"
+    for msg_name, msg_data in protocol["messages"].items():
+        output += f"    X({msg_name}, {msg_data['id']}) \\\n"
+    output += "\n"
 
-    if endianness == "big":
-        for i in range(num_bytes - 1, -1, -1):
-            output += f"    buffer.push_back(({field_name} >> {i * 8}) & 0xFF);\n"
-    else:
-        for i in range(num_bytes):
-            output += f"    buffer.push_back(({field_name} >> {i * 8}) & 0xFF);\n"
+    output += "// Every string field of a message as X(message, field), a char array\n"
+    output += "#define NET_GENERATED_STRINGS(X) \\\n"
+    for msg_name, msg_data in protocol["messages"].items():
+        for field in msg_data["fields"]:
+            if field["type"] == "string":
+                output += f"    X({msg_name}, {field['name']}) \\\n"
+    output += "\n"
 
     return output
 
 
 def read_uint_bytes(
-    field_name: str, num_bytes: int, type_name: str, endianness: str
+    field_name: str,
+    num_bytes: int,
+    type_name: str,
+    endianness: str,
+    data_var: str = "actual_data",
 ) -> str:
     """Generate code to read unsigned integer in specified endianness"""
     output = ""
@@ -367,7 +655,7 @@ def read_uint_bytes(
             if i > 0:
                 output += " |\n        "
             shift = (num_bytes - 1 - i) * 8
-            output += f"(static_cast<{type_name}>(data[offset + {i}]) << {shift})"
+            output += f"(static_cast<{type_name}>({data_var}[offset + {i}]) << {shift})"
         output += ";\n"
     else:
         output += f"    msg.{field_name} = "
@@ -375,791 +663,1781 @@ def read_uint_bytes(
             if i > 0:
                 output += " |\n        "
             shift = i * 8
-            output += f"(static_cast<{type_name}>(data[offset + {i}]) << {shift})"
+            output += f"(static_cast<{type_name}>({data_var}[offset + {i}]) << {shift})"
         output += ";\n"
 
     output += f"    offset += {num_bytes};\n"
     return output
 
 
-def generate_serialize_impl(
-    msg_name: str,
-    fields: list,
-    endianness: str,
-    structs: dict,
-    compressed: bool = False,
-) -> str:
-    """Generate the serialize method of a struct"""
-    output = ""
-    output += f"std::vector<uint8_t> {msg_name}::serialize() const {{\n"
+SCALAR_SIZES = {
+    "uint8": 1, "int8": 1, "uint16": 2, "int16": 2,
+    "uint32": 4, "int32": 4, "uint64": 8, "int64": 8,
+    "float": 4, "double": 8,
+}
 
-    if compressed:
-        output += "    std::vector<uint8_t> uncompressed_buffer;\n"
-        output += "    std::vector<uint8_t>& buffer = uncompressed_buffer;\n\n"
-    else:
-        output += "    std::vector<uint8_t> buffer;\n\n"
 
-    output += "    // Write message ID\n"
-    output += write_uint_bytes("ID", 1, endianness)
-    output += "\n"
+def is_numeric_array(field: dict) -> bool:
+    """Arrays copied in one go by writeWireArray and readWireArray"""
+    return (
+        field["type"] in ["fixed_array", "dynamic_array"]
+        and field.get("element_type") in SCALAR_SIZES
+    )
 
-    for field in fields:
-        field_name = field["name"]
-        field_type = field["type"]
 
-        output += f"    // Write {field_name}\n"
+def struct_member_size(item: dict) -> int:
+    """Wire size of a struct field or bit group, always fixed"""
+    if item["type"] == "bit_group":
+        return item["size"]
+    if item["type"] == "string":
+        return item["max_length"]
+    if is_numeric_array(item):
+        return item["max_size"] * SCALAR_SIZES[item["element_type"]]
+    return SCALAR_SIZES.get(item["type"], 0)
+
+
+def element_wire_size(element_type: str, structs: dict, field: dict = {}) -> int:
+    """Wire size of one array element, 0 if it is not fixed"""
+    if element_type in SCALAR_SIZES:
+        return SCALAR_SIZES[element_type]
+    if element_type in structs:
+        return sum(
+            struct_member_size(item)
+            for item in group_bit_fields(structs[element_type]["fields"])
+        )
+    if element_type == "string" and "element_max_length" in field:
+        return field["element_max_length"]
+    return 0
 
-        if field_type == "fixed_array":
-            element_type = field["element_type"]
-            max_size = field["max_size"]
 
-            count_field = None
+def find_count_field(field_name: str, fields: list) -> str:
+    """Find the field holding the number of used elements of a fixed_array"""
+    possible_names = [
+        field_name.rstrip("s") + "_count",
+        field_name[:-3] + "y_count" if field_name.endswith("ies") else None,
+        field_name + "_count",
+    ]
 
-            possible_names = [
-                field_name.rstrip("s") + "_count",
-                field_name[:-3] + "y_count" if field_name.endswith("ies") else None,
-                field_name + "_count",
-            ]
+    for possible_name in possible_names:
+        if possible_name is None:
+            continue
+        for f in fields:
+            if f["name"] == possible_name:
+                return possible_name
 
-            for possible_name in possible_names:
-                if possible_name is None:
-                    continue
-                for f in fields:
-                    if f["name"] == possible_name:
-                        count_field = possible_name
-                        break
-                if count_field:
-                    break
-
-            if count_field is None:
-                for f in fields:
-                    if f["name"].endswith("_count") or f["name"].endswith("count"):
-                        if (
-                            f["name"].replace("_count", "") in field_name
-                            or field_name in f["name"]
-                        ):
-                            count_field = f["name"]
-                            break
-
-            if count_field is None:
-                print(f"Error: Cannot find count field for fixed_array '{field_name}'")
-                print(
-                    f"Expected one of: {[n for n in possible_names if n is not None]}"
-                )
-                sys.exit(1)
-
-            output += f"    for (uint32_t i = 0; i < {count_field} && i < {max_size}; ++i) {{\n"
-
-            if element_type in structs:
-                struct_data = structs[element_type]
-                for struct_field in struct_data["fields"]:
-                    sf_name = struct_field["name"]
-                    sf_type = struct_field["type"]
-
-                    if sf_type in ["uint8", "int8"]:
-                        output += (
-                            f"        buffer.push_back({field_name}[i].{sf_name});\n"
-                        )
-
-                    elif sf_type in ["uint16", "int16"]:
-                        temp = write_uint_bytes(
-                            f"{field_name}[i].{sf_name}", 2, endianness
-                        )
-                        output += "    " + temp.replace("\n", "\n    ")
-
-                    elif sf_type in ["uint32", "int32"]:
-                        temp = write_uint_bytes(
-                            f"{field_name}[i].{sf_name}", 4, endianness
-                        )
-                        output += "    " + temp.replace("\n", "\n    ")
-
-                    elif sf_type in ["uint64", "int64"]:
-                        temp = write_uint_bytes(
-                            f"{field_name}[i].{sf_name}", 8, endianness
-                        )
-                        output += "    " + temp.replace("\n", "\n    ")
-
-                    elif sf_type == "float":
-                        output += "        {\n"
-                        output += "            uint32_t temp;\n"
-                        output += f"            std::memcpy(&temp, &{field_name}[i].{sf_name}, sizeof(float));\n"
-                        temp_write = write_uint_bytes("temp", 4, endianness)
-                        output += "        " + temp_write.replace("\n", "\n        ")
-                        output += "        }\n"
-
-                    elif sf_type == "double":
-                        output += "        {\n"
-                        output += "            uint64_t temp;\n"
-                        output += f"            std::memcpy(&temp, &{field_name}[i].{sf_name}, sizeof(double));\n"
-                        temp_write = write_uint_bytes("temp", 8, endianness)
-                        output += "        " + temp_write.replace("\n", "\n        ")
-                        output += "        }\n"
-
-                    elif sf_type == "string":
-                        max_len = struct_field["max_length"]
-                        output += (
-                            f"        for (uint32_t j = 0; j < {max_len}; ++j) {{\n"
-                        )
-                        output += f"            buffer.push_back({field_name}[i].{sf_name}[j]);\n"
-                        output += "        }\n"
-
-            elif element_type in TYPE_MAP:
-                if element_type in ["uint8", "int8"]:
-                    output += f"        buffer.push_back({field_name}[i]);\n"
-
-                elif element_type in ["uint16", "int16"]:
-                    temp = write_uint_bytes(f"{field_name}[i]", 2, endianness)
-                    output += "    " + temp.replace("\n", "\n    ")
+    for f in fields:
+        if f["name"].endswith("_count") or f["name"].endswith("count"):
+            if f["name"].replace("_count", "") in field_name or field_name in f["name"]:
+                return f["name"]
 
-                elif element_type in ["uint32", "int32"]:
-                    temp = write_uint_bytes(f"{field_name}[i]", 4, endianness)
-                    output += "    " + temp.replace("\n", "\n    ")
+    print(f"Error: Cannot find count field for fixed_array '{field_name}'")
+    print(f"Expected one of: {[n for n in possible_names if n is not None]}")
+    sys.exit(1)
 
-                elif element_type in ["uint64", "int64"]:
-                    temp = write_uint_bytes(f"{field_name}[i]", 8, endianness)
-                    output += "    " + temp.replace("\n", "\n    ")
 
-                elif element_type == "float":
-                    output += "        {\n"
-                    output += "            uint32_t temp;\n"
-                    output += f"            std::memcpy(&temp, &{field_name}[i], sizeof(float));\n"
-                    temp_write = write_uint_bytes("temp", 4, endianness)
-                    output += "        " + temp_write.replace("\n", "\n        ")
-                    output += "        }\n"
+# ===== Bit fields =====
+#
+# A run of consecutive bits and quantized_float fields is one bit_group: the
+# values packed lowest bits first by BitWriter, the last byte padded with
+# zero bits. The group has a fixed size, so structs keep one too.
 
-                elif element_type == "double":
-                    output += "        {\n"
-                    output += "            uint64_t temp;\n"
-                    output += f"            std::memcpy(&temp, &{field_name}[i], sizeof(double));\n"
-                    temp_write = write_uint_bytes("temp", 8, endianness)
-                    output += "        " + temp_write.replace("\n", "\n        ")
-                    output += "        }\n"
 
-            output += "    }\n"
+def bit_literal(value) -> str:
+    """min or max of a quantized_float as a C++ double"""
+    return repr(float(value))
 
-        elif field_type == "dynamic_array":
-            element_type = field["element_type"]
 
-            output += "    {\n"
-            output += (
-                f"        uint32_t size = static_cast<uint32_t>({field_name}.size());\n"
-            )
-            temp_size = write_uint_bytes("size", 4, endianness)
-            output += "    " + temp_size.replace("\n", "\n    ")
-            output += "    }\n"
+def encode_bit_value(field: dict, expr: str) -> str:
+    if field["type"] == "quantized_float":
+        return (
+            f"quantize({expr}, {bit_literal(field['min'])}, "
+            f"{bit_literal(field['max'])}, {field['bits']})"
+        )
+    return expr
 
-            output += f"    for (const auto& elem : {field_name}) {{\n"
-
-            if element_type in structs:
-                struct_data = structs[element_type]
-                for struct_field in struct_data["fields"]:
-                    sf_name = struct_field["name"]
-                    sf_type = struct_field["type"]
-
-                    if sf_type in ["uint8", "int8"]:
-                        output += f"        buffer.push_back(elem.{sf_name});\n"
-
-                    elif sf_type in ["uint16", "int16"]:
-                        temp = write_uint_bytes(f"elem.{sf_name}", 2, endianness)
-                        output += "    " + temp.replace("\n", "\n    ")
-
-                    elif sf_type in ["uint32", "int32"]:
-                        temp = write_uint_bytes(f"elem.{sf_name}", 4, endianness)
-                        output += "    " + temp.replace("\n", "\n    ")
-
-                    elif sf_type in ["uint64", "int64"]:
-                        temp = write_uint_bytes(f"elem.{sf_name}", 8, endianness)
-                        output += "    " + temp.replace("\n", "\n    ")
-
-                    elif sf_type == "float":
-                        output += "        {\n"
-                        output += "            uint32_t temp;\n"
-                        output += f"            std::memcpy(&temp, &elem.{sf_name}, sizeof(float));\n"
-                        temp_write = write_uint_bytes("temp", 4, endianness)
-                        output += "        " + temp_write.replace("\n", "\n        ")
-                        output += "        }\n"
-
-                    elif sf_type == "double":
-                        output += "        {\n"
-                        output += "            uint64_t temp;\n"
-                        output += f"            std::memcpy(&temp, &elem.{sf_name}, sizeof(double));\n"
-                        temp_write = write_uint_bytes("temp", 8, endianness)
-                        output += "        " + temp_write.replace("\n", "\n        ")
-                        output += "        }\n"
-
-                    elif sf_type == "string":
-                        max_len = struct_field["max_length"]
-                        output += (
-                            f"        for (uint32_t j = 0; j < {max_len}; ++j) {{\n"
-                        )
-                        output += f"            buffer.push_back(elem.{sf_name}[j]);\n"
-                        output += "        }\n"
-
-            elif element_type in TYPE_MAP:
-                if element_type in ["uint8", "int8"]:
-                    output += "        buffer.push_back(elem);\n"
-
-                elif element_type in ["uint16", "int16"]:
-                    temp = write_uint_bytes("elem", 2, endianness)
-                    output += "    " + temp.replace("\n", "\n    ")
 
-                elif element_type in ["uint32", "int32"]:
-                    temp = write_uint_bytes("elem", 4, endianness)
-                    output += "    " + temp.replace("\n", "\n    ")
+def decode_bit_value(field: dict, raw: str) -> str:
+    if field["type"] == "quantized_float":
+        return (
+            f"dequantize({raw}, {bit_literal(field['min'])}, "
+            f"{bit_literal(field['max'])}, {field['bits']})"
+        )
+    return f"static_cast<{field_cpp_type(field)}>({raw})"
 
-                elif element_type in ["uint64", "int64"]:
-                    temp = write_uint_bytes("elem", 8, endianness)
-                    output += "    " + temp.replace("\n", "\n    ")
 
-                elif element_type == "float":
-                    output += "        {\n"
-                    output += "            uint32_t temp;\n"
-                    output += "            std::memcpy(&temp, &elem, sizeof(float));\n"
-                    temp_write = write_uint_bytes("temp", 4, endianness)
-                    output += "        " + temp_write.replace("\n", "\n        ")
-                    output += "        }\n"
+def plus(expr: str, value: int) -> str:
+    return f"{expr} + {value}" if value else expr
 
-                elif element_type == "double":
-                    output += "        {\n"
-                    output += "            uint64_t temp;\n"
-                    output += "            std::memcpy(&temp, &elem, sizeof(double));\n"
-                    temp_write = write_uint_bytes("temp", 8, endianness)
-                    output += "        " + temp_write.replace("\n", "\n        ")
-                    output += "        }\n"
 
-            elif element_type == "string":
-                output += "        {\n"
-                output += "            uint32_t str_len = static_cast<uint32_t>(elem.size());\n"
-                temp_len = write_uint_bytes("str_len", 4, endianness)
-                output += "        " + temp_len.replace("\n", "\n        ")
-                output += "            for (char c : elem) {\n"
-                output += "                buffer.push_back(c);\n"
-                output += "            }\n"
-                output += "        }\n"
+def group_padding(group: dict) -> int:
+    """Bits used in the last byte of a group, 0 when it is full"""
+    return group["bits"] % 8
 
-            output += "    }\n"
 
-        elif field_type == "string":
-            max_len = field["max_length"]
-            output += f"    for (uint32_t i = 0; i < {max_len}; ++i) {{\n"
-            output += f"        buffer.push_back({field_name}[i]);\n"
-            output += "    }\n"
+def emit_write_bits(group: dict, prefix: str, indent: str) -> str:
+    """Write a bit group at out + offset, prefix reaches its fields"""
+    output = f"{indent}{{\n"
+    output += f"{indent}    BitWriter bits(out + offset);\n\n"
+    for field in group["fields"]:
+        value = encode_bit_value(field, prefix + field["name"])
+        output += f"{indent}    bits.write({value}, {field['bits']});\n"
+    output += f"{indent}    offset += bits.flush();\n"
+    output += f"{indent}}}\n"
+    return output
+
 
-        elif field_type in ["uint8", "int8"]:
-            output += f"    buffer.push_back({field_name});\n"
+def emit_read_bits(group: dict, prefix: str, indent: str, label: str) -> str:
+    """Read a bit group at actual_data + offset, already checked"""
+    size = group["size"]
+    output = f"{indent}{{\n"
+    output += f"{indent}    BitReader bits(actual_data.data() + offset, {size});\n\n"
+    for field in group["fields"]:
+        value = decode_bit_value(field, f"bits.read({field['bits']})")
+        output += f"{indent}    {prefix}{field['name']} = {value};\n"
+    output += f"{indent}}}\n"
+    if group_padding(group):
+        output += (
+            f"{indent}checkPadding(actual_data, {plus('offset', size - 1)}, "
+            f'{group_padding(group)}, "{label}");\n'
+        )
+    output += f"{indent}offset += {size};\n"
+    return output
 
-        elif field_type in ["uint16", "int16"]:
-            output += write_uint_bytes(field_name, 2, endianness)
 
-        elif field_type in ["uint32", "int32"]:
-            output += write_uint_bytes(field_name, 4, endianness)
+def struct_paddings(struct_name: str, structs: dict) -> list:
+    """(position of the last byte, bits used in it) of the bit groups of a
+    struct that end with padding"""
+    paddings = []
+    position = 0
+    for item in group_bit_fields(structs[struct_name]["fields"]):
+        if item["type"] == "bit_group":
+            position += item["size"]
+            if group_padding(item):
+                paddings.append((position - 1, group_padding(item)))
+        else:
+            position += struct_member_size(item)
+    return paddings
 
-        elif field_type in ["uint64", "int64"]:
-            output += write_uint_bytes(field_name, 8, endianness)
 
-        elif field_type == "float":
-            output += "    {\n"
-            output += "        uint32_t temp;\n"
-            output += f"        std::memcpy(&temp, &{field_name}, sizeof(float));\n"
-            output += write_uint_bytes("temp", 4, endianness).replace(
-                "    ", "        "
-            )
-            output += "    }\n"
+# ===== Serialization =====
+#
+# Every message gets two file-local overloads, bodySize(msg) and
+# writeBody(msg, out), built from the per-field emitters below. The member
+# functions serializedSize, serializeInto and serialize sit on top of them.
 
-        elif field_type == "double":
-            output += "    {\n"
-            output += "        uint64_t temp;\n"
-            output += f"        std::memcpy(&temp, &{field_name}, sizeof(double));\n"
-            output += write_uint_bytes("temp", 8, endianness).replace(
-                "    ", "        "
-            )
-            output += "    }\n"
 
-        output += "\n"
+def emit_write_value(value_type: str, expr: str, indent: str, field: dict) -> str:
+    """Write a scalar or a fixed size string at out + offset"""
+    if value_type == "string":
+        max_len = field["max_length"]
+        return (
+            f"{indent}std::memcpy(out + offset, {expr}, {max_len});\n"
+            f"{indent}offset += {max_len};\n"
+        )
+    if value_type in SCALAR_SIZES:
+        return (
+            f"{indent}writeWire(out + offset, {expr});\n"
+            f"{indent}offset += {SCALAR_SIZES[value_type]};\n"
+        )
+    if value_type == "fixed_array" and is_numeric_array(field):
+        # array member of a struct, always full
+        size = field["max_size"] * SCALAR_SIZES[field["element_type"]]
+        return (
+            f"{indent}writeWireArray(out + offset, {expr}, {field['max_size']});\n"
+            f"{indent}offset += {size};\n"
+        )
+    return ""
 
-    if compressed:
-        output += "    // Compress the buffer using LZ4\n"
-        output += "    std::vector<uint8_t> compressed_buffer;\n"
-        output += "    int max_compressed_size = LZ4_compressBound(static_cast<int>(uncompressed_buffer.size()));\n"
-        output += "    compressed_buffer.resize(max_compressed_size + 4); // +4 for uncompressed size\n\n"
-
-        output += "    // Write uncompressed size at the beginning\n"
-        output += "    uint32_t uncompressed_size = static_cast<uint32_t>(uncompressed_buffer.size());\n"
-        temp_size = write_uint_bytes("uncompressed_size", 4, endianness)
-        output += "    std::vector<uint8_t> size_bytes;\n"
-        output += temp_size.replace("buffer.push_back", "size_bytes.push_back")
-        output += "    std::memcpy(compressed_buffer.data(), size_bytes.data(), 4);\n\n"
-
-        output += "    // Compress the data\n"
-        output += "    int compressed_size = LZ4_compress_default(\n"
-        output += "        reinterpret_cast<const char*>(uncompressed_buffer.data()),\n"
-        output += "        reinterpret_cast<char*>(compressed_buffer.data() + 4),\n"
-        output += "        static_cast<int>(uncompressed_buffer.size()),\n"
-        output += "        max_compressed_size\n"
-        output += "    );\n\n"
-
-        output += "    if (compressed_size <= 0) {\n"
+
+def emit_write_element(
+    element_type: str, expr: str, indent: str, structs: dict, field: dict
+) -> str:
+    """Write one element of an array"""
+    if element_type in structs:
+        output = ""
+        for struct_field in group_bit_fields(structs[element_type]["fields"]):
+            if struct_field["type"] == "bit_group":
+                output += emit_write_bits(struct_field, f"{expr}.", indent)
+                continue
+            output += emit_write_value(
+                struct_field["type"],
+                f"{expr}.{struct_field['name']}",
+                indent,
+                struct_field,
+            )
+        return output
+    if element_type == "string" and field["type"] == "dynamic_array":
+        return (
+            f"{indent}writeWire(out + offset, static_cast<uint32_t>({expr}.size()));\n"
+            f"{indent}std::memcpy(out + offset + 4, {expr}.data(), {expr}.size());\n"
+            f"{indent}offset += 4 + {expr}.size();\n"
+        )
+    if element_type == "string":
+        eml = field.get("element_max_length", 0)
+        return (
+            f"{indent}std::memcpy(out + offset, {expr}, {eml});\n"
+            f"{indent}offset += {eml};\n"
+        )
+    return emit_write_value(element_type, expr, indent, field)
+
+
+def emit_write_field(field: dict, fields: list, structs: dict) -> str:
+    """Write a message field"""
+    name = field["name"]
+    field_type = field["type"]
+    output = f"    // Write {name}\n"
+
+    if field_type == "bit_group":
+        names = ", ".join(f["name"] for f in field["fields"])
+        return f"    // Write {names}\n" + emit_write_bits(field, "msg.", "    ") + "\n"
+    if field_type == "fixed_array" and is_numeric_array(field):
+        count_field = find_count_field(name, fields)
+        elem_size = SCALAR_SIZES[field["element_type"]]
+        output += "    {\n"
         output += (
-            "        // Compression failed, return uncompressed data with size prefix\n"
+            f"        size_t count = std::min<size_t>(msg.{count_field}, "
+            f"{field['max_size']});\n"
         )
-        output += "        compressed_buffer.resize(4 + uncompressed_buffer.size());\n"
-        output += "        std::memcpy(compressed_buffer.data() + 4, uncompressed_buffer.data(), uncompressed_buffer.size());\n"
-        output += "    } else {\n"
-        output += "        compressed_buffer.resize(4 + compressed_size);\n"
-        output += "    }\n\n"
+        output += f"        writeWireArray(out + offset, msg.{name}, count);\n"
+        output += f"        offset += count * {elem_size};\n"
+        output += "    }\n"
+    elif field_type == "dynamic_array" and is_numeric_array(field):
+        elem_size = SCALAR_SIZES[field["element_type"]]
+        output += f"    writeWire(out + offset, static_cast<uint32_t>(msg.{name}.size()));\n"
+        output += "    offset += 4;\n"
+        output += (
+            f"    writeWireArray(out + offset, msg.{name}.data(), "
+            f"msg.{name}.size());\n"
+        )
+        output += f"    offset += msg.{name}.size() * {elem_size};\n"
+    elif field_type == "fixed_array":
+        count_field = find_count_field(name, fields)
+        output += (
+            f"    for (uint32_t i = 0; i < msg.{count_field} && "
+            f"i < {field['max_size']}; ++i) {{\n"
+        )
+        output += emit_write_element(
+            field["element_type"], f"msg.{name}[i]", "        ", structs, field
+        )
+        output += "    }\n"
+    elif field_type == "dynamic_array":
+        output += f"    writeWire(out + offset, static_cast<uint32_t>(msg.{name}.size()));\n"
+        output += "    offset += 4;\n"
+        output += f"    for (const auto& elem : msg.{name}) {{\n"
+        output += emit_write_element(
+            field["element_type"], "elem", "        ", structs, field
+        )
+        output += "    }\n"
+    elif is_varlen(field):
+        output += (
+            f"    offset += writeVarlen(out + offset, msg.{name}, "
+            f"{field['max_length']});\n"
+        )
+    elif is_varint(field):
+        output += f"    offset += writeVarintField(out + offset, msg.{name});\n"
+    else:
+        output += emit_write_value(field_type, f"msg.{name}", "    ", field)
+    return output + "\n"
+
+
+def emit_size_field(field: dict, fields: list, structs: dict) -> tuple:
+    """Wire size of a message field: (constant part, C++ code adding the
+    part only known at run time to size)"""
+    name = field["name"]
+    field_type = field["type"]
+
+    if field_type == "bit_group":
+        return field["size"], ""
+    if is_varlen(field):
+        return 0, f"    size += varlenSize(msg.{name}, {field['max_length']});\n"
+    if is_varint(field):
+        return 0, f"    size += varintSize(msg.{name});\n"
+    if field_type == "string":
+        return field["max_length"], ""
+    if field_type in SCALAR_SIZES:
+        return SCALAR_SIZES[field_type], ""
+    if field_type == "fixed_array":
+        count_field = find_count_field(name, fields)
+        elem_size = element_wire_size(field["element_type"], structs, field)
+        return 0, (
+            f"    size += std::min<size_t>(msg.{count_field}, "
+            f"{field['max_size']}) * {elem_size};\n"
+        )
+    if field_type == "dynamic_array":
+        if field["element_type"] == "string":
+            return 4, (
+                f"    for (const auto& elem : msg.{name})\n"
+                "        size += 4 + elem.size();\n"
+            )
+        elem_size = element_wire_size(field["element_type"], structs, field)
+        return 4, f"    size += msg.{name}.size() * {elem_size};\n"
+    return 0, ""
+
 
-        output += "    return compressed_buffer;\n"
+def generate_body_impl(msg_name: str, fields: list, structs: dict) -> str:
+    """Generate bodySize and writeBody of a message, the uncompressed wire
+    form without any check"""
+    constant = 1  # message ID
+    dynamic = ""
+    for field in group_bit_fields(fields):
+        field_constant, field_dynamic = emit_size_field(field, fields, structs)
+        constant += field_constant
+        dynamic += field_dynamic
+
+    output = ""
+    output += f"size_t bodySize(const {msg_name}& msg) {{\n"
+    if dynamic:
+        output += f"    size_t size = {constant};\n\n"
+        output += dynamic
+        output += "    return size;\n"
     else:
-        output += "    return buffer;\n"
+        output += "    (void)msg;\n"
+        output += f"    return {constant};\n"
+    output += "}\n\n"
 
+    output += f"size_t writeBody(const {msg_name}& msg, uint8_t* out) {{\n"
+    output += "    size_t offset = 0;\n\n"
+    output += "    // Write message ID\n"
+    output += f"    writeWire(out + offset, static_cast<uint8_t>({msg_name}::ID));\n"
+    output += "    offset += 1;\n\n"
+    for field in group_bit_fields(fields):
+        output += emit_write_field(field, fields, structs)
+    output += "    return offset;\n"
     output += "}\n\n"
     return output
 
 
-def generate_deserialize_impl(
+def dictionary_arg(msg_name: str, compression: dict) -> str:
+    """Dictionary argument of lz4::compress and lz4::decompress"""
+    if "dictionary" in compression:
+        return f", {msg_name}_DICTIONARY"
+    return ""
+
+
+def compression_args(msg_name: str, compression: dict) -> str:
+    """Dictionary and level arguments of lz4::compress"""
+    level = compression.get("compression_level", 0)
+    if level:
+        dictionary = dictionary_arg(msg_name, compression) or ", {}"
+        return f"{dictionary}, {level}"
+    return dictionary_arg(msg_name, compression)
+
+
+def generate_dictionaries(protocol: dict) -> str:
+    """Dictionaries of the compressed messages, embedded in the code"""
+    output = ""
+    for msg_name, msg_data in protocol["messages"].items():
+        if "dictionary_bytes" not in msg_data:
+            continue
+        content = msg_data["dictionary_bytes"]
+        output += f"// LZ4 dictionary of {msg_name}, from {msg_data['dictionary']}\n"
+        output += f"const uint8_t {msg_name}_DICTIONARY[] = {{\n"
+        for line in range(0, len(content), 12):
+            chunk = content[line:line + 12]
+            output += "    " + " ".join(f"0x{byte:02x}," for byte in chunk) + "\n"
+        output += "};\n\n"
+    return output
+
+
+def generate_decompression_buffer(protocol: dict) -> str:
+    """Where the compressed messages are decompressed, if there are any"""
+    if not any(m.get("compressed", False) for m in protocol["messages"].values()):
+        return ""
+    output = ""
+    output += "// Without a scratch resource, fields are decompressed in a per-thread\n"
+    output += "// buffer that keeps its capacity: up to the largest MAX_UNCOMPRESSED_SIZE,\n"
+    output += "// allocated once whatever the number of messages decoded.\n"
+    output += "std::span<uint8_t> decompressionBuffer(size_t size,\n"
+    output += "    std::pmr::memory_resource* scratch, std::pmr::vector<uint8_t>& owned) {\n"
+    output += "    thread_local std::vector<uint8_t> buffer;\n\n"
+    output += "    if (scratch) {\n"
+    output += "        owned.resize(size);\n"
+    output += "        return owned;\n"
+    output += "    }\n"
+    output += "    if (buffer.size() < size)\n"
+    output += "        buffer.resize(size);\n"
+    output += "    return std::span(buffer).first(size);\n"
+    output += "}\n\n"
+    return output
+
+
+def generate_serialize_impl(
     msg_name: str,
     fields: list,
     endianness: str,
     structs: dict,
-    compressed: bool = False,
+    compression: dict = None,
 ) -> str:
-    """Generate the deserialize method of a struct"""
+    """Generate serializedSize, serializeInto and serialize of a message"""
     output = ""
 
-    output += (
-        f"{msg_name} {msg_name}::deserialize(const std::vector<uint8_t>& data) {{\n"
-    )
-    output += f"    {msg_name} msg;\n"
+    output += f"size_t {msg_name}::serializedSize() const {{\n"
+    if compression:
+        output += "    // stored as is when compressing doesn't shrink the fields\n"
+        output += "    size_t fields_size = bodySize(*this) - 1;\n\n"
+        output += "    return 1 + varint::size(fields_size << 1) + fields_size;\n"
+    else:
+        output += "    return bodySize(*this);\n"
+    output += "}\n\n"
 
-    if compressed:
-        output += "    std::vector<uint8_t> decompressed_data;\n\n"
-        output += "    // Read uncompressed size\n"
-        output += "    uint32_t uncompressed_size = 0;\n"
-        output += "    size_t temp_offset = 0;\n"
-        temp_read = (
-            read_uint_bytes("uncompressed_size", 4, "uint32_t", endianness)
-            .replace("msg.", "")
-            .replace("offset", "temp_offset")
-        )
-        output += "    " + temp_read.replace("\n", "\n    ")
+    output += f"size_t {msg_name}::serializeInto(std::span<uint8_t> out) const {{\n"
+    output += "    size_t size = serializedSize();\n\n"
+    output += "    if (out.size() < size)\n"
+    output += f'        throw std::runtime_error("Buffer too small for {msg_name}");\n'
+    if compression:
+        # a block of 1 byte can't shrink
+        min_size = max(compression.get("compress_min_size", 0), 2)
+        args = compression_args(msg_name, compression)
         output += "\n"
-
-        output += "    // Decompress the data\n"
-        output += "    decompressed_data.resize(uncompressed_size);\n"
-        output += "    int decompressed_size = LZ4_decompress_safe(\n"
-        output += "        reinterpret_cast<const char*>(data.data() + 4),\n"
-        output += "        reinterpret_cast<char*>(decompressed_data.data()),\n"
-        output += "        static_cast<int>(data.size() - 4),\n"
-        output += "        static_cast<int>(uncompressed_size)\n"
-        output += "    );\n\n"
-
-        output += "    if (decompressed_size < 0) {\n"
-        output += "        // Decompression failed, assume data is uncompressed\n"
-        output += "        decompressed_data.assign(data.begin() + 4, data.end());\n"
-        output += "    }\n\n"
-
-        output += "    const std::vector<uint8_t>& actual_data = decompressed_data;\n"
-        output += "    size_t offset = 0;\n\n"
-
-        output += "    // Skip message ID\n"
-        output += "    offset += 1;\n\n"
+        output += "    // the ID stays readable, for dispatch, then the size of the fields\n"
+        output += "    // with its low bit set when they are compressed\n"
+        output += "    size_t fields_size = bodySize(*this) - 1;\n"
+        output += "    size_t header = 1 + varint::size(fields_size << 1);\n\n"
+        bound = max_fields_size(fields, structs)
+        if bound is None or max_uncompressed_size(compression, structs) < bound:
+            output += "    // the peer would reject it\n"
+            output += "    if (fields_size > MAX_UNCOMPRESSED_SIZE)\n"
+            output += f'        throw std::runtime_error("Message too large for {msg_name}");\n'
+        output += f"    if (fields_size >= {min_size}) {{\n"
+        output += "        // fields written to a per-thread buffer, compressed if it saves a byte\n"
+        output += "        thread_local std::vector<uint8_t> uncompressed_buffer;\n"
+        output += "        uncompressed_buffer.resize(fields_size + 1);\n"
+        output += "        writeBody(*this, uncompressed_buffer.data());\n"
+        output += "        size_t compressed_size = lz4::compress(\n"
+        output += "            std::span(uncompressed_buffer).subspan(1),\n"
+        output += f"            out.subspan(header, fields_size - 1){args});\n\n"
+        output += "        if (compressed_size > 0) {\n"
+        output += f"            writeWire(out.data(), static_cast<uint8_t>({msg_name}::ID));\n"
+        output += "            varint::write(out.data() + 1, fields_size << 1 | 1);\n"
+        output += "            return header + compressed_size;\n"
+        output += "        }\n"
+        output += "        std::memcpy(out.data() + header, uncompressed_buffer.data() + 1,\n"
+        output += "            fields_size);\n"
+        output += "    } else {\n"
+        output += "        // the ID written first is overwritten by the size\n"
+        output += "        writeBody(*this, out.data() + header - 1);\n"
+        output += "    }\n"
+        output += f"    writeWire(out.data(), static_cast<uint8_t>({msg_name}::ID));\n"
+        output += "    varint::write(out.data() + 1, fields_size << 1);\n"
+        output += "    return size;\n"
     else:
-        output += "    const std::vector<uint8_t>& actual_data = data;\n"
-        output += "    size_t offset = 0;\n\n"
+        output += "    return writeBody(*this, out.data());\n"
+    output += "}\n\n"
 
-        output += "    // Skip message ID\n"
-        output += "    offset += 1;\n\n"
+    output += f"std::vector<uint8_t> {msg_name}::serialize() const {{\n"
+    output += "    std::vector<uint8_t> buffer(serializedSize());\n\n"
+    output += "    buffer.resize(serializeInto(buffer));\n"
+    output += "    return buffer;\n"
+    output += "}\n\n"
+    return output
 
-    for field in fields:
-        field_name = field["name"]
-        field_type = field["type"]
 
-        output += f"    // Read {field_name}\n"
+def check_size(size_expr: str, label: str, indent: str = "    ") -> str:
+    """Generate the check that size_expr bytes are left to read"""
+    return f'{indent}checkSize(actual_data, offset, {size_expr}, "{label}");\n'
 
-        data_var = "actual_data" if compressed else "data"
 
-        if field_type == "fixed_array":
-            element_type = field["element_type"]
-            max_size = field["max_size"]
+def read_array(target: str, count: str, element_type: str, indent: str) -> str:
+    """Generate the read of count numeric elements, already checked"""
+    return (
+        f"{indent}readWireArray({target}, actual_data.data() + offset, {count});\n"
+        f"{indent}offset += {count} * {SCALAR_SIZES[element_type]};\n"
+    )
 
-            count_field = None
 
-            possible_names = [
-                field_name.rstrip("s") + "_count",
-                field_name[:-3] + "y_count" if field_name.endswith("ies") else None,
-                field_name + "_count",
-            ]
+def emit_read_field(
+    field: dict, fields: list, msg_name: str, endianness: str, structs: dict
+) -> str:
+    """Read a message field or bit group at actual_data + offset into msg,
+    checking the size first"""
+    output = ""
+    field_name = field["name"]
+    field_type = field["type"]
+
+    if field_type == "bit_group":
+        names = ", ".join(f["name"] for f in field["fields"])
+        label = f"{msg_name}.{field_name}"
+        output += f"    // Read {names}\n"
+        output += check_size(str(field["size"]), label)
+        output += emit_read_bits(field, "msg.", "    ", label)
+        output += "\n"
+        return output
 
-            for possible_name in possible_names:
-                if possible_name is None:
-                    continue
-                for f in fields:
-                    if f["name"] == possible_name:
-                        count_field = possible_name
-                        break
-                if count_field:
-                    break
-
-            if count_field is None:
-                for f in fields:
-                    if f["name"].endswith("_count") or f["name"].endswith("count"):
-                        if (
-                            f["name"].replace("_count", "") in field_name
-                            or field_name in f["name"]
-                        ):
-                            count_field = f["name"]
-                            break
-
-            if count_field is None:
-                print(f"Error: Cannot find count field for fixed_array '{field_name}'")
-                sys.exit(1)
-
-            output += f"    for (uint32_t i = 0; i < msg.{count_field} && i < {max_size}; ++i) {{\n"
-
-            if element_type in structs:
-                struct_data = structs[element_type]
-                for struct_field in struct_data["fields"]:
-                    sf_name = struct_field["name"]
-                    sf_type = struct_field["type"]
-
-                    if sf_type in ["uint8", "int8"]:
-                        output += f"        msg.{field_name}[i].{sf_name} = {data_var}[offset];\n"
-                        output += "        offset += 1;\n"
-
-                    elif sf_type == "uint16":
-                        temp = read_uint_bytes(
-                            f"{field_name}[i].{sf_name}", 2, "uint16_t", endianness
-                        )
-                        output += "    " + temp.replace("\n", "\n    ")
-
-                    elif sf_type == "int16":
-                        temp = read_uint_bytes(
-                            f"{field_name}[i].{sf_name}", 2, "int16_t", endianness
-                        )
-                        output += "    " + temp.replace("\n", "\n    ")
-
-                    elif sf_type == "uint32":
-                        temp = read_uint_bytes(
-                            f"{field_name}[i].{sf_name}", 4, "uint32_t", endianness
-                        )
-                        output += "    " + temp.replace("\n", "\n    ")
-
-                    elif sf_type == "int32":
-                        temp = read_uint_bytes(
-                            f"{field_name}[i].{sf_name}", 4, "int32_t", endianness
-                        )
-                        output += "    " + temp.replace("\n", "\n    ")
-
-                    elif sf_type == "uint64":
-                        temp = read_uint_bytes(
-                            f"{field_name}[i].{sf_name}", 8, "uint64_t", endianness
-                        )
-                        output += "    " + temp.replace("\n", "\n    ")
-
-                    elif sf_type == "int64":
-                        temp = read_uint_bytes(
-                            f"{field_name}[i].{sf_name}", 8, "int64_t", endianness
-                        )
-                        output += "    " + temp.replace("\n", "\n    ")
-
-                    elif sf_type == "float":
-                        output += "        {\n"
-                        output += "            uint32_t temp;\n"
-                        temp_read = read_uint_bytes(
-                            "temp", 4, "uint32_t", endianness
-                        ).replace("msg.", "")
-                        output += "        " + temp_read.replace("\n", "\n        ")
-                        output += f"            std::memcpy(&msg.{field_name}[i].{sf_name}, &temp, sizeof(float));\n"
-                        output += "        }\n"
-
-                    elif sf_type == "double":
-                        output += "        {\n"
-                        output += "            uint64_t temp;\n"
-                        temp_read = read_uint_bytes(
-                            "temp", 8, "uint64_t", endianness
-                        ).replace("msg.", "")
-                        output += "        " + temp_read.replace("\n", "\n        ")
-                        output += f"            std::memcpy(&msg.{field_name}[i].{sf_name}, &temp, sizeof(double));\n"
-                        output += "        }\n"
-
-                    elif sf_type == "string":
-                        max_len = struct_field["max_length"]
-                        output += f"        std::memcpy(msg.{field_name}[i].{sf_name}, {data_var}.data() + offset, {max_len});\n"
-                        output += f"        offset += {max_len};\n"
-
-            elif element_type in TYPE_MAP:
-                if element_type in ["uint8", "int8"]:
-                    output += f"        msg.{field_name}[i] = {data_var}[offset];\n"
-                    output += "        offset += 1;\n"
+    output += f"    // Read {field_name}\n"
 
-                elif element_type == "uint16":
-                    temp = read_uint_bytes(
-                        f"{field_name}[i]", 2, "uint16_t", endianness
-                    )
-                    output += "    " + temp.replace("\n", "\n    ")
+    data_var = "actual_data"
+    label = f"{msg_name}.{field_name}"
 
-                elif element_type == "int16":
-                    temp = read_uint_bytes(f"{field_name}[i]", 2, "int16_t", endianness)
-                    output += "    " + temp.replace("\n", "\n    ")
+    if is_varlen(field):
+        output += (
+            f"    readVarlen(actual_data, offset, msg.{field_name}, "
+            f'{field["max_length"]}, "{label}");\n'
+        )
 
-                elif element_type == "uint32":
-                    temp = read_uint_bytes(
-                        f"{field_name}[i]", 4, "uint32_t", endianness
-                    )
-                    output += "    " + temp.replace("\n", "\n    ")
+    elif is_varint(field):
+        output += (
+            f"    msg.{field_name} = readVarintField<{TYPE_MAP[field_type]}>("
+            f'actual_data, offset, "{label}");\n'
+        )
+
+    elif field_type == "fixed_array" and is_numeric_array(field):
+        count_field = find_count_field(field_name, fields)
+        output += "    {\n"
+        output += (
+            f"        size_t count = std::min<size_t>(msg.{count_field}, "
+            f"{field['max_size']});\n"
+        )
+        output += check_size(
+            f"count * {SCALAR_SIZES[field['element_type']]}", label, "        "
+        )
+        output += read_array(
+            f"msg.{field_name}", "count", field["element_type"], "        "
+        )
+        output += "    }\n"
+
+    elif field_type == "fixed_array":
+        element_type = field["element_type"]
+        max_size = field["max_size"]
+
+        count_field = find_count_field(field_name, fields)
+
+        elem_size = element_wire_size(element_type, structs, field)
+        output += check_size(
+            f"std::min<size_t>(msg.{count_field}, {max_size}) * {elem_size}",
+            label,
+        )
+        output += f"    for (uint32_t i = 0; i < msg.{count_field} && i < {max_size}; ++i) {{\n"
+
+        if element_type in structs:
+            struct_data = structs[element_type]
+            for struct_field in group_bit_fields(struct_data["fields"]):
+                sf_name = struct_field["name"]
+                sf_type = struct_field["type"]
+
+                if sf_type == "bit_group":
+                    output += emit_read_bits(
+                        struct_field, f"msg.{field_name}[i].", "        ", label
+                    )
+
+                elif sf_type in ["uint8", "int8"]:
+                    output += f"        msg.{field_name}[i].{sf_name} = {data_var}[offset];\n"
+                    output += "        offset += 1;\n"
+
+                elif sf_type == "uint16":
+                    temp = read_uint_bytes(
+                        f"{field_name}[i].{sf_name}", 2, "uint16_t", endianness
+                    )
+                    output += "    " + temp.replace("\n", "\n    ")
+
+                elif sf_type == "int16":
+                    temp = read_uint_bytes(
+                        f"{field_name}[i].{sf_name}", 2, "int16_t", endianness
+                    )
+                    output += "    " + temp.replace("\n", "\n    ")
+
+                elif sf_type == "uint32":
+                    temp = read_uint_bytes(
+                        f"{field_name}[i].{sf_name}", 4, "uint32_t", endianness
+                    )
+                    output += "    " + temp.replace("\n", "\n    ")
 
-                elif element_type == "int32":
-                    temp = read_uint_bytes(f"{field_name}[i]", 4, "int32_t", endianness)
+                elif sf_type == "int32":
+                    temp = read_uint_bytes(
+                        f"{field_name}[i].{sf_name}", 4, "int32_t", endianness
+                    )
                     output += "    " + temp.replace("\n", "\n    ")
 
-                elif element_type == "uint64":
+                elif sf_type == "uint64":
                     temp = read_uint_bytes(
-                        f"{field_name}[i]", 8, "uint64_t", endianness
+                        f"{field_name}[i].{sf_name}", 8, "uint64_t", endianness
                     )
                     output += "    " + temp.replace("\n", "\n    ")
 
-                elif element_type == "int64":
-                    temp = read_uint_bytes(f"{field_name}[i]", 8, "int64_t", endianness)
+                elif sf_type == "int64":
+                    temp = read_uint_bytes(
+                        f"{field_name}[i].{sf_name}", 8, "int64_t", endianness
+                    )
                     output += "    " + temp.replace("\n", "\n    ")
 
-                elif element_type == "float":
+                elif sf_type == "float":
                     output += "        {\n"
                     output += "            uint32_t temp;\n"
                     temp_read = read_uint_bytes(
                         "temp", 4, "uint32_t", endianness
                     ).replace("msg.", "")
                     output += "        " + temp_read.replace("\n", "\n        ")
-                    output += f"            std::memcpy(&msg.{field_name}[i], &temp, sizeof(float));\n"
+                    output += f"            std::memcpy(&msg.{field_name}[i].{sf_name}, &temp, sizeof(float));\n"
                     output += "        }\n"
 
-                elif element_type == "double":
+                elif sf_type == "double":
                     output += "        {\n"
                     output += "            uint64_t temp;\n"
                     temp_read = read_uint_bytes(
                         "temp", 8, "uint64_t", endianness
                     ).replace("msg.", "")
                     output += "        " + temp_read.replace("\n", "\n        ")
-                    output += f"            std::memcpy(&msg.{field_name}[i], &temp, sizeof(double));\n"
+                    output += f"            std::memcpy(&msg.{field_name}[i].{sf_name}, &temp, sizeof(double));\n"
                     output += "        }\n"
 
-            output += "    }\n"
+                elif sf_type == "string":
+                    max_len = struct_field["max_length"]
+                    output += f"        std::memcpy(msg.{field_name}[i].{sf_name}, {data_var}.data() + offset, {max_len});\n"
+                    output += f"        offset += {max_len};\n"
+
+                elif is_numeric_array(struct_field):
+                    output += read_array(
+                        f"msg.{field_name}[i].{sf_name}",
+                        str(struct_field["max_size"]),
+                        struct_field["element_type"],
+                        "        ",
+                    )
 
-        elif field_type == "dynamic_array":
-            element_type = field["element_type"]
+        elif element_type == "string":
+            eml = field.get("element_max_length", 0)
+            output += f"        std::memcpy(msg.{field_name}[i], {data_var}.data() + offset, {eml});\n"
+            output += f"        offset += {eml};\n"
 
-            output += "    {\n"
-            output += "        uint32_t size;\n"
-            temp_read = read_uint_bytes("size", 4, "uint32_t", endianness).replace(
-                "msg.", ""
+        output += "    }\n"
+
+    elif field_type == "dynamic_array":
+        element_type = field["element_type"]
+
+        # a string element is at least its length prefix
+        elem_size = element_wire_size(element_type, structs) or 4
+        output += "    {\n"
+        output += "        uint32_t size;\n"
+        output += check_size("4", label, "        ")
+        temp_read = read_uint_bytes("size", 4, "uint32_t", endianness).replace(
+            "msg.", ""
+        )
+        output += "    " + temp_read.replace("\n", "\n    ")
+        output += check_size(
+            f"static_cast<size_t>(size) * {elem_size}", label, "        "
+        )
+        output += f"        msg.{field_name}.resize(size);\n"
+        if is_numeric_array(field):
+            output += read_array(
+                f"msg.{field_name}.data()", "size", element_type, "        "
             )
-            output += "    " + temp_read.replace("\n", "\n    ")
-            output += f"        msg.{field_name}.resize(size);\n"
-            output += "    }\n"
+            output += "    }\n\n"
+            return output
+        output += "    }\n"
+
+        output += f"    for (auto& elem : msg.{field_name}) {{\n"
+
+        if element_type in structs:
+            struct_data = structs[element_type]
+            for struct_field in group_bit_fields(struct_data["fields"]):
+                sf_name = struct_field["name"]
+                sf_type = struct_field["type"]
 
-            output += f"    for (auto& elem : msg.{field_name}) {{\n"
-
-            if element_type in structs:
-                struct_data = structs[element_type]
-                for struct_field in struct_data["fields"]:
-                    sf_name = struct_field["name"]
-                    sf_type = struct_field["type"]
-
-                    if sf_type in ["uint8", "int8"]:
-                        output += f"        elem.{sf_name} = {data_var}[offset];\n"
-                        output += "        offset += 1;\n"
-
-                    elif sf_type == "uint16":
-                        temp = read_uint_bytes(
-                            f"elem.{sf_name}", 2, "uint16_t", endianness
-                        )
-                        output += "    " + temp.replace("\n", "\n    ").replace(
-                            "msg.", ""
-                        )
-
-                    elif sf_type == "int16":
-                        temp = read_uint_bytes(
-                            f"elem.{sf_name}", 2, "int16_t", endianness
-                        )
-                        output += "    " + temp.replace("\n", "\n    ").replace(
-                            "msg.", ""
-                        )
-
-                    elif sf_type == "uint32":
-                        temp = read_uint_bytes(
-                            f"elem.{sf_name}", 4, "uint32_t", endianness
-                        )
-                        output += "    " + temp.replace("\n", "\n    ").replace(
-                            "msg.", ""
-                        )
-
-                    elif sf_type == "int32":
-                        temp = read_uint_bytes(
-                            f"elem.{sf_name}", 4, "int32_t", endianness
-                        )
-                        output += "    " + temp.replace("\n", "\n    ").replace(
-                            "msg.", ""
-                        )
-
-                    elif sf_type == "uint64":
-                        temp = read_uint_bytes(
-                            f"elem.{sf_name}", 8, "uint64_t", endianness
-                        )
-                        output += "    " + temp.replace("\n", "\n    ").replace(
-                            "msg.", ""
-                        )
-
-                    elif sf_type == "int64":
-                        temp = read_uint_bytes(
-                            f"elem.{sf_name}", 8, "int64_t", endianness
-                        )
-                        output += "    " + temp.replace("\n", "\n    ").replace(
-                            "msg.", ""
-                        )
-
-                    elif sf_type == "float":
-                        output += "        {\n"
-                        output += "            uint32_t temp;\n"
-                        temp_read = read_uint_bytes(
-                            "temp", 4, "uint32_t", endianness
-                        ).replace("msg.", "")
-                        output += "        " + temp_read.replace("\n", "\n        ")
-                        output += f"            std::memcpy(&elem.{sf_name}, &temp, sizeof(float));\n"
-                        output += "        }\n"
-
-                    elif sf_type == "double":
-                        output += "        {\n"
-                        output += "            uint64_t temp;\n"
-                        temp_read = read_uint_bytes(
-                            "temp", 8, "uint64_t", endianness
-                        ).replace("msg.", "")
-                        output += "        " + temp_read.replace("\n", "\n        ")
-                        output += f"            std::memcpy(&elem.{sf_name}, &temp, sizeof(double));\n"
-                        output += "        }\n"
-
-                    elif sf_type == "string":
-                        max_len = struct_field["max_length"]
-                        output += f"        std::memcpy(elem.{sf_name}, {data_var}.data() + offset, {max_len});\n"
-                        output += f"        offset += {max_len};\n"
-
-            elif element_type in TYPE_MAP:
-                if element_type in ["uint8", "int8"]:
-                    output += f"        elem = {data_var}[offset];\n"
+                if sf_type == "bit_group":
+                    output += emit_read_bits(
+                        struct_field, "elem.", "        ", label
+                    )
+
+                elif sf_type in ["uint8", "int8"]:
+                    output += f"        elem.{sf_name} = {data_var}[offset];\n"
                     output += "        offset += 1;\n"
 
-                elif element_type == "uint16":
-                    temp = read_uint_bytes("elem", 2, "uint16_t", endianness)
-                    output += "    " + temp.replace("\n", "\n    ").replace("msg.", "")
+                elif sf_type == "uint16":
+                    temp = read_uint_bytes(
+                        f"elem.{sf_name}", 2, "uint16_t", endianness
+                    )
+                    output += "    " + temp.replace("\n", "\n    ").replace(
+                        "msg.", ""
+                    )
 
-                elif element_type == "int16":
-                    temp = read_uint_bytes("elem", 2, "int16_t", endianness)
-                    output += "    " + temp.replace("\n", "\n    ").replace("msg.", "")
+                elif sf_type == "int16":
+                    temp = read_uint_bytes(
+                        f"elem.{sf_name}", 2, "int16_t", endianness
+                    )
+                    output += "    " + temp.replace("\n", "\n    ").replace(
+                        "msg.", ""
+                    )
 
-                elif element_type == "uint32":
-                    temp = read_uint_bytes("elem", 4, "uint32_t", endianness)
-                    output += "    " + temp.replace("\n", "\n    ").replace("msg.", "")
+                elif sf_type == "uint32":
+                    temp = read_uint_bytes(
+                        f"elem.{sf_name}", 4, "uint32_t", endianness
+                    )
+                    output += "    " + temp.replace("\n", "\n    ").replace(
+                        "msg.", ""
+                    )
 
-                elif element_type == "int32":
-                    temp = read_uint_bytes("elem", 4, "int32_t", endianness)
-                    output += "    " + temp.replace("\n", "\n    ").replace("msg.", "")
+                elif sf_type == "int32":
+                    temp = read_uint_bytes(
+                        f"elem.{sf_name}", 4, "int32_t", endianness
+                    )
+                    output += "    " + temp.replace("\n", "\n    ").replace(
+                        "msg.", ""
+                    )
 
-                elif element_type == "uint64":
-                    temp = read_uint_bytes("elem", 8, "uint64_t", endianness)
-                    output += "    " + temp.replace("\n", "\n    ").replace("msg.", "")
+                elif sf_type == "uint64":
+                    temp = read_uint_bytes(
+                        f"elem.{sf_name}", 8, "uint64_t", endianness
+                    )
+                    output += "    " + temp.replace("\n", "\n    ").replace(
+                        "msg.", ""
+                    )
 
-                elif element_type == "int64":
-                    temp = read_uint_bytes("elem", 8, "int64_t", endianness)
-                    output += "    " + temp.replace("\n", "\n    ").replace("msg.", "")
+                elif sf_type == "int64":
+                    temp = read_uint_bytes(
+                        f"elem.{sf_name}", 8, "int64_t", endianness
+                    )
+                    output += "    " + temp.replace("\n", "\n    ").replace(
+                        "msg.", ""
+                    )
 
-                elif element_type == "float":
+                elif sf_type == "float":
                     output += "        {\n"
                     output += "            uint32_t temp;\n"
                     temp_read = read_uint_bytes(
                         "temp", 4, "uint32_t", endianness
                     ).replace("msg.", "")
                     output += "        " + temp_read.replace("\n", "\n        ")
-                    output += "            std::memcpy(&elem, &temp, sizeof(float));\n"
+                    output += f"            std::memcpy(&elem.{sf_name}, &temp, sizeof(float));\n"
                     output += "        }\n"
 
-                elif element_type == "double":
+                elif sf_type == "double":
                     output += "        {\n"
                     output += "            uint64_t temp;\n"
                     temp_read = read_uint_bytes(
                         "temp", 8, "uint64_t", endianness
                     ).replace("msg.", "")
                     output += "        " + temp_read.replace("\n", "\n        ")
-                    output += "            std::memcpy(&elem, &temp, sizeof(double));\n"
+                    output += f"            std::memcpy(&elem.{sf_name}, &temp, sizeof(double));\n"
                     output += "        }\n"
 
-            elif element_type == "string":
-                output += "        {\n"
-                output += "            uint32_t str_len;\n"
-                temp_read = read_uint_bytes(
-                    "str_len", 4, "uint32_t", endianness
-                ).replace("msg.", "")
-                output += "        " + temp_read.replace("\n", "\n        ")
-                output += "            elem.resize(str_len);\n"
-                output += "            for (uint32_t j = 0; j < str_len; ++j) {\n"
-                output += f"                elem[j] = {data_var}[offset];\n"
-                output += "                offset += 1;\n"
-                output += "            }\n"
-                output += "        }\n"
+                elif sf_type == "string":
+                    max_len = struct_field["max_length"]
+                    output += f"        std::memcpy(elem.{sf_name}, {data_var}.data() + offset, {max_len});\n"
+                    output += f"        offset += {max_len};\n"
+
+                elif is_numeric_array(struct_field):
+                    output += read_array(
+                        f"elem.{sf_name}",
+                        str(struct_field["max_size"]),
+                        struct_field["element_type"],
+                        "        ",
+                    )
 
-            output += "    }\n"
+        elif element_type == "string":
+            output += "        {\n"
+            output += "            uint32_t str_len;\n"
+            output += check_size("4", label, "            ")
+            temp_read = read_uint_bytes(
+                "str_len", 4, "uint32_t", endianness
+            ).replace("msg.", "")
+            output += "        " + temp_read.replace("\n", "\n        ")
+            output += check_size("str_len", label, "            ")
+            output += "            elem.resize(str_len);\n"
+            output += "            for (uint32_t j = 0; j < str_len; ++j) {\n"
+            output += f"                elem[j] = {data_var}[offset];\n"
+            output += "                offset += 1;\n"
+            output += "            }\n"
+            output += "        }\n"
+
+        output += "    }\n"
+
+    elif field_type == "string":
+        max_len = field["max_length"]
+        output += check_size(str(max_len), label)
+        output += f"    std::memcpy(msg.{field_name}, {data_var}.data() + offset, {max_len});\n"
+        output += f"    offset += {max_len};\n"
+
+    elif field_type in ["uint8", "int8"]:
+        output += check_size("1", label)
+        output += f"    msg.{field_name} = {data_var}[offset];\n"
+        output += "    offset += 1;\n"
+
+    elif field_type == "uint16":
+        output += check_size("2", label)
+        output += read_uint_bytes(field_name, 2, "uint16_t", endianness)
+
+    elif field_type == "int16":
+        output += check_size("2", label)
+        output += read_uint_bytes(field_name, 2, "int16_t", endianness)
+
+    elif field_type == "uint32":
+        output += check_size("4", label)
+        output += read_uint_bytes(field_name, 4, "uint32_t", endianness)
+
+    elif field_type == "int32":
+        output += check_size("4", label)
+        output += read_uint_bytes(field_name, 4, "int32_t", endianness)
+
+    elif field_type == "uint64":
+        output += check_size("8", label)
+        output += read_uint_bytes(field_name, 8, "uint64_t", endianness)
+
+    elif field_type == "int64":
+        output += check_size("8", label)
+        output += read_uint_bytes(field_name, 8, "int64_t", endianness)
+
+    elif field_type == "float":
+        output += check_size("4", label)
+        output += "    {\n"
+        output += "        uint32_t temp;\n"
+        temp_read = read_uint_bytes("temp", 4, "uint32_t", endianness).replace(
+            "msg.", ""
+        )
+        output += "    " + temp_read.replace("\n", "\n    ")
+        output += f"        std::memcpy(&msg.{field_name}, &temp, sizeof(float));\n"
+        output += "    }\n"
+
+    elif field_type == "double":
+        output += check_size("8", label)
+        output += "    {\n"
+        output += "        uint64_t temp;\n"
+        temp_read = read_uint_bytes("temp", 8, "uint64_t", endianness).replace(
+            "msg.", ""
+        )
+        output += "    " + temp_read.replace("\n", "\n    ")
+        output += (
+            f"        std::memcpy(&msg.{field_name}, &temp, sizeof(double));\n"
+        )
+        output += "    }\n"
 
-        elif field_type == "string":
-            max_len = field["max_length"]
-            output += f"    std::memcpy(msg.{field_name}, {data_var}.data() + offset, {max_len});\n"
-            output += f"    offset += {max_len};\n"
+    output += "\n"
+    return output
 
-        elif field_type in ["uint8", "int8"]:
-            output += f"    msg.{field_name} = {data_var}[offset];\n"
-            output += "    offset += 1;\n"
 
-        elif field_type == "uint16":
-            output += read_uint_bytes(field_name, 2, "uint16_t", endianness)
+def generate_deserialize_impl(
+    msg_name: str,
+    fields: list,
+    endianness: str,
+    structs: dict,
+    compression: dict = None,
+) -> str:
+    """Generate the deserialize method of a struct"""
+    output = ""
 
-        elif field_type == "int16":
-            output += read_uint_bytes(field_name, 2, "int16_t", endianness)
+    output += (
+        f"{msg_name} {msg_name}::deserialize(const std::vector<uint8_t>& data) {{\n"
+    )
+    output += "    return deserialize(std::span<const uint8_t>(data));\n"
+    output += "}\n\n"
 
-        elif field_type == "uint32":
-            output += read_uint_bytes(field_name, 4, "uint32_t", endianness)
+    output += f"{msg_name} {msg_name}::deserialize(std::span<const uint8_t> data,\n"
+    output += "    std::pmr::memory_resource* scratch) {\n"
+    output += f"    {msg_name} msg;\n"
 
-        elif field_type == "int32":
-            output += read_uint_bytes(field_name, 4, "int32_t", endianness)
+    if compression:
+        args = dictionary_arg(msg_name, compression)
+        output += "    std::pmr::vector<uint8_t> decompressed_data(\n"
+        output += "        scratch ? scratch : std::pmr::get_default_resource());\n"
+        output += "    std::span<const uint8_t> actual_data;\n"
+        output += "    size_t offset = 1;\n"
+        output += "    uint64_t header = 0;\n\n"
+        output += "    // Skip message ID, read the size of the fields and whether they are\n"
+        output += "    // compressed\n"
+        output += f'    checkSize(data, 0, 1, "{msg_name}");\n'
+        output += "    size_t header_size = varint::read(data, offset, header);\n"
+        output += "    size_t fields_size = header >> 1;\n\n"
+        output += "    // checked before anything is allocated for the fields\n"
+        output += "    if (header_size == 0 || fields_size > MAX_UNCOMPRESSED_SIZE)\n"
+        output += f'        throw std::runtime_error("Invalid size in {msg_name}");\n'
+        output += "    offset += header_size;\n"
+        output += "    if (header & 1) {\n"
+        output += "        // LZ4 can't expand a block more than 255 times\n"
+        output += "        if (fields_size / 255 > data.size() - offset)\n"
+        output += f'            throw std::runtime_error("Invalid size in {msg_name}");\n'
+        output += "        std::span<uint8_t> decompressed =\n"
+        output += "            decompressionBuffer(fields_size, scratch, decompressed_data);\n"
+        output += "        if (!lz4::decompress(data.subspan(offset), decompressed" + args + "))\n"
+        output += f'            throw std::runtime_error("Invalid compressed data in {msg_name}");\n'
+        output += "        actual_data = decompressed;\n"
+        output += "    } else {\n"
+        output += f'        checkSize(data, offset, fields_size, "{msg_name}");\n'
+        output += "        actual_data = data.subspan(offset, fields_size);\n"
+        output += "    }\n"
+        output += "    offset = 0;\n\n"
+    else:
+        output += "    (void)scratch;\n"
+        output += "    std::span<const uint8_t> actual_data = data;\n"
+        output += "    size_t offset = 0;\n\n"
 
-        elif field_type == "uint64":
-            output += read_uint_bytes(field_name, 8, "uint64_t", endianness)
+        output += "    // Skip message ID\n"
+        output += check_size("1", msg_name)
+        output += "    offset += 1;\n\n"
 
-        elif field_type == "int64":
-            output += read_uint_bytes(field_name, 8, "int64_t", endianness)
+    for field in group_bit_fields(fields):
+        output += emit_read_field(field, fields, msg_name, endianness, structs)
 
-        elif field_type == "float":
-            output += "    {\n"
-            output += "        uint32_t temp;\n"
-            temp_read = read_uint_bytes("temp", 4, "uint32_t", endianness).replace(
-                "msg.", ""
+    if compression:
+        # the size is sent, a message has a single encoding
+        output += "    if (offset != actual_data.size())\n"
+        output += f'        throw std::runtime_error("Invalid size in {msg_name}");\n'
+    output += "    return msg;\n"
+    output += "}\n\n"
+
+    return output
+
+# ===== Delta =====
+#
+# A "delta" message is written as [ID][sequence][baseline][changed mask] then
+# the changed fields in their usual encoding, one bit of the mask per field
+# or bit group, lowest bit first. Both ends hold the baseline, see
+# Network/Delta.hpp; serialize and deserialize use an empty message.
+
+
+def delta_mask_size(fields: list) -> int:
+    return (len(group_bit_fields(fields)) + 7) // 8
+
+
+def changed_bit(index: int) -> str:
+    return f"changed & (uint64_t{{1}} << {index})"
+
+
+def indent_block(code: str) -> str:
+    """Code moved one level deeper, inside an if"""
+    lines = code.rstrip("\n").split("\n")
+    return "".join(f"    {line}\n" if line else "\n" for line in lines)
+
+
+def emit_changed_item(item: dict, fields: list, structs: dict) -> str:
+    """C++ condition true when a field or bit group of msg differs from the
+    baseline, comparing the bytes of the values as they are sent"""
+    def changed_bytes(name: str) -> str:
+        return f"changedBytes(&msg.{name}, &baseline.{name}, sizeof(msg.{name}))"
+
+    if item["type"] == "bit_group":
+        return " ||\n        ".join(changed_bytes(f["name"]) for f in item["fields"])
+
+    name = item["name"]
+    element_type = item.get("element_type")
+    if item["type"] == "fixed_array":
+        count_field = find_count_field(name, fields)
+        count = f"std::min<size_t>(msg.{count_field}, {item['max_size']})"
+        output = f"msg.{count_field} != baseline.{count_field} ||\n        "
+        if element_type in structs:
+            return output + f"!sameElements(msg.{name}, baseline.{name}, {count})"
+        return output + (
+            f"changedBytes(msg.{name}, baseline.{name},\n"
+            f"            {count} * sizeof(msg.{name}[0]))"
+        )
+    if item["type"] == "dynamic_array":
+        if element_type == "string":
+            return f"msg.{name} != baseline.{name}"
+        output = f"msg.{name}.size() != baseline.{name}.size() ||\n        "
+        if element_type in structs:
+            return output + (
+                f"!sameElements(msg.{name}.data(), baseline.{name}.data(), "
+                f"msg.{name}.size())"
             )
-            output += "    " + temp_read.replace("\n", "\n    ")
-            output += f"        std::memcpy(&msg.{field_name}, &temp, sizeof(float));\n"
+        return output + (
+            f"changedBytes(msg.{name}.data(), baseline.{name}.data(),\n"
+            f"            msg.{name}.size() * sizeof(msg.{name}[0]))"
+        )
+    return changed_bytes(name)
+
+
+def delta_structs(protocol: dict) -> list:
+    """Structs in the arrays of delta messages, compared element by element"""
+    structs = protocol.get("structs", {})
+    used = []
+    for msg_data in protocol["messages"].values():
+        if not is_delta(msg_data):
+            continue
+        for field in msg_data["fields"]:
+            if is_array(field) and field["element_type"] in structs:
+                if field["element_type"] not in used:
+                    used.append(field["element_type"])
+    return used
+
+
+def generate_delta_helpers(protocol: dict) -> str:
+    """File-local helpers shared by the delta messages"""
+    if not any(is_delta(m) for m in protocol["messages"].values()):
+        return ""
+    structs = protocol.get("structs", {})
+    output = ""
+
+    output += "// the fields of delta messages are compared by their bytes, as they are\n"
+    output += "// sent: -0.0 differs from 0.0, and a NaN from itself only if its bits do\n"
+    output += "bool changedBytes(const void* a, const void* b, size_t size) {\n"
+    output += "    return size > 0 && std::memcmp(a, b, size) != 0;\n"
+    output += "}\n\n"
+
+    used = delta_structs(protocol)
+    for struct_name in used:
+        members = [
+            f"!changedBytes(&a.{f['name']}, &b.{f['name']}, sizeof(a.{f['name']}))"
+            for f in structs[struct_name]["fields"]
+        ]
+        output += f"bool sameBits(const {struct_name}& a, const {struct_name}& b) {{\n"
+        output += "    return " + " &&\n        ".join(members) + ";\n"
+        output += "}\n\n"
+    if used:
+        output += "template<typename T>\n"
+        output += "bool sameElements(const T* a, const T* b, size_t count) {\n"
+        output += "    for (size_t i = 0; i < count; ++i) {\n"
+        output += "        if (!sameBits(a[i], b[i]))\n"
+        output += "            return false;\n"
+        output += "    }\n"
+        output += "    return true;\n"
+        output += "}\n\n"
+
+    output += "// baseline of the whole form, deserialize starts from it\n"
+    output += "template<typename T>\n"
+    output += "const T& emptyMessage() {\n"
+    output += "    static const T message{};\n\n"
+    output += "    return message;\n"
+    output += "}\n\n"
+    return output
+
+
+def generate_delta_body_impl(msg_name: str, fields: list, structs: dict) -> str:
+    """Generate changedFields, deltaSize and writeDelta of a delta message,
+    the counterparts of bodySize and writeBody"""
+    items = group_bit_fields(fields)
+    mask_size = delta_mask_size(fields)
+    output = ""
+
+    output += f"uint64_t changedFields(const {msg_name}& msg, const {msg_name}& baseline) {{\n"
+    output += "    uint64_t changed = 0;\n\n"
+    for index, item in enumerate(items):
+        output += f"    if ({emit_changed_item(item, fields, structs)})\n"
+        output += f"        changed |= uint64_t{{1}} << {index};\n"
+    output += "    return changed;\n"
+    output += "}\n\n"
+
+    output += f"size_t deltaSize(const {msg_name}& msg, uint64_t changed) {{\n"
+    output += f"    size_t size = {5 + mask_size};\n\n"
+    for index, item in enumerate(items):
+        constant, dynamic = emit_size_field(item, fields, structs)
+        if not dynamic:
+            output += f"    if ({changed_bit(index)})\n"
+            output += f"        size += {constant};\n"
+            continue
+        output += f"    if ({changed_bit(index)}) {{\n"
+        if constant:
+            output += f"        size += {constant};\n"
+        output += indent_block(dynamic)
+        output += "    }\n"
+    output += "    return size;\n"
+    output += "}\n\n"
+
+    output += (
+        f"size_t writeDelta(const {msg_name}& msg, uint64_t changed, "
+        "DeltaHeader header,\n    uint8_t* out) {\n"
+    )
+    output += "    size_t offset = 0;\n\n"
+    output += "    // Write message ID, sequence, baseline and changed fields\n"
+    output += f"    writeWire(out + offset, static_cast<uint8_t>({msg_name}::ID));\n"
+    output += "    writeWire(out + offset + 1, header.sequence);\n"
+    output += "    writeWire(out + offset + 3, header.baseline);\n"
+    output += "    offset += 5;\n"
+    for byte in range(mask_size):
+        shift = f" >> {8 * byte}" if byte else ""
+        output += (
+            f"    out[{plus('offset', byte)}] = "
+            f"static_cast<uint8_t>(changed{shift});\n"
+        )
+    output += f"    offset += {mask_size};\n\n"
+    for index, item in enumerate(items):
+        output += f"    if ({changed_bit(index)}) {{\n"
+        output += indent_block(emit_write_field(item, fields, structs))
+        output += "    }\n"
+    output += "    return offset;\n"
+    output += "}\n\n"
+    return output
+
+
+def generate_delta_serialize_impl(msg_name: str) -> str:
+    """Generate the serialize methods of a delta message, the whole form
+    being the delta against an empty message"""
+    output = ""
+
+    output += f"size_t {msg_name}::serializedSize() const {{\n"
+    output += f"    return serializedDeltaSize(emptyMessage<{msg_name}>());\n"
+    output += "}\n\n"
+
+    output += f"size_t {msg_name}::serializeInto(std::span<uint8_t> out) const {{\n"
+    output += f"    return serializeDeltaInto(emptyMessage<{msg_name}>(), DeltaHeader{{}}, out);\n"
+    output += "}\n\n"
+
+    output += f"std::vector<uint8_t> {msg_name}::serialize() const {{\n"
+    output += "    std::vector<uint8_t> buffer(serializedSize());\n\n"
+    output += "    buffer.resize(serializeInto(buffer));\n"
+    output += "    return buffer;\n"
+    output += "}\n\n"
+
+    output += f"size_t {msg_name}::serializedDeltaSize(const {msg_name}& baseline) const {{\n"
+    output += "    return deltaSize(*this, changedFields(*this, baseline));\n"
+    output += "}\n\n"
+
+    output += (
+        f"size_t {msg_name}::serializeDeltaInto(const {msg_name}& baseline, "
+        "DeltaHeader header,\n    std::span<uint8_t> out) const {\n"
+    )
+    output += "    uint64_t changed = changedFields(*this, baseline);\n\n"
+    output += "    if (out.size() < deltaSize(*this, changed))\n"
+    output += f'        throw std::runtime_error("Buffer too small for {msg_name}");\n'
+    output += "    return writeDelta(*this, changed, header, out.data());\n"
+    output += "}\n\n"
+    return output
+
+
+def generate_delta_deserialize_impl(
+    msg_name: str, fields: list, endianness: str, structs: dict
+) -> str:
+    """Generate the deserialize methods of a delta message: the fields not
+    sent keep the value of the baseline"""
+    items = group_bit_fields(fields)
+    mask_size = delta_mask_size(fields)
+    output = ""
+
+    output += (
+        f"{msg_name} {msg_name}::deserialize(const std::vector<uint8_t>& data) {{\n"
+    )
+    output += "    return deserialize(std::span<const uint8_t>(data));\n"
+    output += "}\n\n"
+
+    output += f"{msg_name} {msg_name}::deserialize(std::span<const uint8_t> data,\n"
+    output += "    std::pmr::memory_resource* scratch) {\n"
+    output += "    (void)scratch;\n"
+    output += "    if (readDeltaHeader(data).hasBaseline())\n"
+    output += f'        throw std::runtime_error("Baseline needed for {msg_name}");\n'
+    output += f"    return deserializeDelta(data, emptyMessage<{msg_name}>());\n"
+    output += "}\n\n"
+
+    output += f"DeltaHeader {msg_name}::readDeltaHeader(std::span<const uint8_t> data) {{\n"
+    output += f'    checkSize(data, 0, 5, "{msg_name}");\n'
+    output += "    return DeltaHeader{detail::readWire<uint16_t>(data.data() + 1),\n"
+    output += "        detail::readWire<uint16_t>(data.data() + 3)};\n"
+    output += "}\n\n"
+
+    output += f"{msg_name} {msg_name}::deserializeDelta(std::span<const uint8_t> data,\n"
+    output += f"    const {msg_name}& baseline) {{\n"
+    output += f"    {msg_name} msg = baseline;\n"
+    output += "    std::span<const uint8_t> actual_data = data;\n"
+    output += "    size_t offset = 0;\n"
+    output += "    uint64_t changed = 0;\n\n"
+    output += "    // Skip message ID, sequence and baseline, read changed fields\n"
+    output += check_size(str(5 + mask_size), msg_name)
+    output += "    offset += 5;\n"
+    for byte in range(mask_size):
+        shift = f" << {8 * byte}" if byte else ""
+        output += (
+            f"    changed |= uint64_t{{actual_data[{plus('offset', byte)}]}}{shift};\n"
+        )
+    output += f"    offset += {mask_size};\n"
+    if len(items) < 8 * mask_size:
+        output += f"    if (changed >> {len(items)})\n"
+        output += f'        throw std::runtime_error("Invalid changed fields in {msg_name}");\n'
+    output += "\n"
+
+    for index, item in enumerate(items):
+        output += f"    if ({changed_bit(index)}) {{\n"
+        output += indent_block(
+            emit_read_field(item, fields, msg_name, endianness, structs)
+        )
+        output += "    }\n"
+    output += "    return msg;\n"
+    output += "}\n\n"
+    return output
+
+
+# ===== Encodings =====
+
+
+def generate_encoding_helpers(protocol: dict) -> str:
+    """File-local helpers of the varint, varlen and bit fields, only the ones
+    the protocol uses"""
+    structs = protocol.get("structs", {})
+    uses_varint = False
+    uses_varlen = False
+    views_varlen = False
+    uses_padding = False
+    for msg_data in protocol["messages"].values():
+        for field in msg_data["fields"]:
+            uses_varint = uses_varint or is_varint(field)
+            if is_varlen(field):
+                uses_varlen = True
+                views_varlen = views_varlen or has_view(msg_data)
+            if is_array(field) and field["element_type"] in structs:
+                uses_padding = uses_padding or bool(
+                    struct_paddings(field["element_type"], structs)
+                )
+        for item in group_bit_fields(msg_data["fields"]):
+            if item["type"] == "bit_group":
+                uses_padding = uses_padding or bool(group_padding(item))
+    output = ""
+
+    if uses_padding:
+        output += "// the unused bits of the last byte of a bit group are zero\n"
+        output += "void checkPadding(std::span<const uint8_t> data, size_t last, unsigned used,\n"
+        output += "    const char* field) {\n"
+        output += "    if (data[last] >> used)\n"
+        output += '        throw std::runtime_error(std::string("Invalid padding at ") + field);\n'
+        output += "}\n\n"
+
+    if uses_varint:
+        output += "// varint fields are zigzag mapped when signed\n"
+        output += "template<typename T>\n"
+        output += "size_t varintSize(T value) {\n"
+        output += "    if constexpr (std::is_signed_v<T>)\n"
+        output += "        return varint::size(varint::zigzag(value));\n"
+        output += "    else\n"
+        output += "        return varint::size(value);\n"
+        output += "}\n\n"
+        output += "template<typename T>\n"
+        output += "size_t writeVarintField(uint8_t* out, T value) {\n"
+        output += "    if constexpr (std::is_signed_v<T>)\n"
+        output += "        return varint::write(out, varint::zigzag(value));\n"
+        output += "    else\n"
+        output += "        return varint::write(out, value);\n"
+        output += "}\n\n"
+        output += "template<typename T>\n"
+        output += "T readVarintField(std::span<const uint8_t> data, size_t& offset,\n"
+        output += "    const char* field) {\n"
+        output += "    uint64_t raw = 0;\n"
+        output += "    size_t length = varint::read(data, offset, raw);\n\n"
+        output += "    if (length == 0)\n"
+        output += '        throw std::runtime_error(std::string("Invalid varint at ") + field);\n'
+        output += "    offset += length;\n"
+        output += "    if constexpr (std::is_signed_v<T>) {\n"
+        output += "        int64_t value = varint::unzigzag(raw);\n"
+        output += "        if (value < std::numeric_limits<T>::min() ||\n"
+        output += "            value > std::numeric_limits<T>::max())\n"
+        output += '            throw std::runtime_error(std::string("Varint out of range at ") + field);\n'
+        output += "        return static_cast<T>(value);\n"
+        output += "    } else {\n"
+        output += "        if (raw > std::numeric_limits<T>::max())\n"
+        output += '            throw std::runtime_error(std::string("Varint out of range at ") + field);\n'
+        output += "        return static_cast<T>(raw);\n"
+        output += "    }\n"
+        output += "}\n\n"
+
+    if uses_varlen:
+        output += "// varlen strings: the length as a varint, then the characters up to the\n"
+        output += "// first zero\n"
+        output += "size_t varlenLength(const char* value, size_t max_length) {\n"
+        output += "    const void* end = std::memchr(value, 0, max_length);\n\n"
+        output += "    return end ? static_cast<const char*>(end) - value : max_length;\n"
+        output += "}\n\n"
+        output += "size_t varlenSize(const char* value, size_t max_length) {\n"
+        output += "    size_t length = varlenLength(value, max_length);\n\n"
+        output += "    return varint::size(length) + length;\n"
+        output += "}\n\n"
+        output += "size_t writeVarlen(uint8_t* out, const char* value, size_t max_length) {\n"
+        output += "    size_t length = varlenLength(value, max_length);\n"
+        output += "    size_t prefix = varint::write(out, length);\n\n"
+        output += "    std::memcpy(out + prefix, value, length);\n"
+        output += "    return prefix + length;\n"
+        output += "}\n\n"
+        output += "// moves offset past the length prefix, the characters are checked and\n"
+        output += "// hold no zero, which would cut the string once written back\n"
+        output += "size_t readVarlenLength(std::span<const uint8_t> data, size_t& offset,\n"
+        output += "    size_t max_length, const char* field) {\n"
+        output += "    uint64_t length = 0;\n"
+        output += "    size_t prefix = varint::read(data, offset, length);\n\n"
+        output += "    if (prefix == 0 || length > max_length)\n"
+        output += '        throw std::runtime_error(std::string("Invalid string length at ") + field);\n'
+        output += "    offset += prefix;\n"
+        output += "    checkSize(data, offset, length, field);\n"
+        output += "    if (std::memchr(data.data() + offset, 0, length))\n"
+        output += '        throw std::runtime_error(std::string("Zero in string at ") + field);\n'
+        output += "    return length;\n"
+        output += "}\n\n"
+        output += "void readVarlen(std::span<const uint8_t> data, size_t& offset, char* value,\n"
+        output += "    size_t max_length, const char* field) {\n"
+        output += "    size_t length = readVarlenLength(data, offset, max_length, field);\n\n"
+        output += "    std::memcpy(value, data.data() + offset, length);\n"
+        output += "    std::memset(value + length, 0, max_length - length);\n"
+        output += "    offset += length;\n"
+        output += "}\n\n"
+    if views_varlen:
+        output += "void skipVarlen(std::span<const uint8_t> data, size_t& offset,\n"
+        output += "    size_t max_length, const char* field) {\n"
+        output += "    offset += readVarlenLength(data, offset, max_length, field);\n"
+        output += "}\n\n"
+    return output
+
+
+# ===== Views =====
+#
+# <Msg>View reads the fields of a serialized message in place. Fields before
+# the first array sit at a constant offset, the offset of the others and the
+# element count of the arrays are found by the constructor, which checks the
+# whole message once. Compressed messages have no view, their bytes have to
+# be decompressed first, nor delta messages, whose unchanged fields are only
+# in the baseline.
+
+
+def generate_view_helpers(endianness: str) -> str:
+    """Inline decoding helpers shared by the views"""
+    output = ""
+    output += "namespace detail {\n\n"
+    output += "// the wire is " + endianness + " endian, whatever the host\n"
+    output += "template<typename T>\n"
+    output += "T readWire(const uint8_t* in) {\n"
+    output += "    if constexpr (std::is_floating_point_v<T>) {\n"
+    output += "        using Bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;\n"
+    output += "        return std::bit_cast<T>(readWire<Bits>(in));\n"
+    output += "    } else {\n"
+    output += "        T value;\n"
+    output += "        std::memcpy(&value, in, sizeof(T));\n"
+    output += f"        if constexpr (sizeof(T) > 1 && std::endian::native != std::endian::{endianness})\n"
+    output += "            value = std::byteswap(value);\n"
+    output += "        return value;\n"
+    output += "    }\n"
+    output += "}\n\n"
+    output += "// fixed size strings are padded with zeros, not always terminated\n"
+    output += "inline std::string_view readString(const uint8_t* in, size_t max_length) {\n"
+    output += "    const void* end = std::memchr(in, 0, max_length);\n"
+    output += "    size_t length = end ? static_cast<const uint8_t*>(end) - in : max_length;\n\n"
+    output += "    return std::string_view(reinterpret_cast<const char*>(in), length);\n"
+    output += "}\n\n"
+    output += "template<typename T>\n"
+    output += "T readVarint(const uint8_t* in) {\n"
+    output += "    uint64_t raw = 0;\n\n"
+    output += "    varint::readUnchecked(in, raw);\n"
+    output += "    if constexpr (std::is_signed_v<T>)\n"
+    output += "        return static_cast<T>(varint::unzigzag(raw));\n"
+    output += "    else\n"
+    output += "        return static_cast<T>(raw);\n"
+    output += "}\n\n"
+    output += "inline std::string_view readVarlen(const uint8_t* in) {\n"
+    output += "    uint64_t length = 0;\n"
+    output += "    size_t prefix = varint::readUnchecked(in, length);\n\n"
+    output += "    return readString(in + prefix, length);\n"
+    output += "}\n\n"
+    output += "inline void checkIndex(size_t index, size_t size, const char* field) {\n"
+    output += "    if (index >= size)\n"
+    output += '        throw std::out_of_range(std::string("Index out of range in ") + field);\n'
+    output += "}\n\n"
+    output += "}  // namespace detail\n\n"
+    return output
+
+
+def is_array(field: dict) -> bool:
+    return field["type"] in ["fixed_array", "dynamic_array"]
+
+
+def has_fixed_size(field: dict) -> bool:
+    """Wire size known from protocol.json alone"""
+    return not is_array(field) and field_encoding(field) == "fixed"
+
+
+def view_layout(fields: list, structs: dict) -> tuple:
+    """Offset expression of every field (bit group) of a view, plus the count
+    expression of the arrays: (layout, number of offsets, number of counts)"""
+    layout = []
+    constant = 1  # message ID
+    offsets = 0
+    counts = 0
+
+    for field in group_bit_fields(fields):
+        entry = {}
+        if constant is not None and has_fixed_size(field):
+            entry["offset"] = str(constant)
+            constant += emit_size_field(field, fields, structs)[0]
+        else:
+            constant = None
+            entry["offset"] = f"_offsets[{offsets}]"
+            offsets += 1
+        if is_array(field):
+            entry["count"] = f"_counts[{counts}]"
+            counts += 1
+        layout.append(entry)
+    return layout, offsets, counts
+
+
+def view_prefix_size(fields: list, structs: dict) -> int:
+    """Bytes before the first field of variable size, checked at once by the
+    constructor"""
+    size = 1
+    for field in group_bit_fields(fields):
+        if not has_fixed_size(field):
+            break
+        size += emit_size_field(field, fields, structs)[0]
+    return size
+
+
+def generate_view_declaration(msg_name: str, msg_data: dict, structs: dict) -> str:
+    """Generate the <Msg>View class, accessors inline when they are short"""
+    fields = msg_data["fields"]
+    layout, offsets, counts = view_layout(fields, structs)
+    output = ""
+
+    output += f"// {msg_name} read in place, each field decoded when asked for. The\n"
+    output += "// constructor checks the bytes, which must outlive the view.\n"
+    output += f"class {msg_name}View {{\n"
+    output += " public:\n"
+    output += f"    static constexpr uint32_t ID = {msg_name}::ID;\n\n"
+    output += "    // throws std::runtime_error if data is too short for the message\n"
+    output += f"    explicit {msg_name}View(std::span<const uint8_t> data);\n\n"
+
+    for field, entry in zip(group_bit_fields(fields), layout):
+        name = field["name"]
+        field_type = field["type"]
+        offset = entry["offset"]
+        label = f"{msg_name}.{name}"
+
+        if field_type == "bit_group":
+            position = 0
+            for bit_field in field["fields"]:
+                read = (
+                    f"BitReader(_data.data() + {offset}, {field['size']}, "
+                    f"{position}).read({bit_field['bits']})"
+                )
+                output += f"    {field_cpp_type(bit_field)} {bit_field['name']}() const {{\n"
+                output += f"        return {decode_bit_value(bit_field, read)};\n"
+                output += "    }\n"
+                position += bit_field["bits"]
+        elif is_varlen(field):
+            output += f"    std::string_view {name}() const {{\n"
+            output += f"        return detail::readVarlen(_data.data() + {offset});\n"
+            output += "    }\n"
+        elif is_varint(field):
+            cpp_type = TYPE_MAP[field_type]
+            output += f"    {cpp_type} {name}() const {{\n"
+            output += f"        return detail::readVarint<{cpp_type}>(_data.data() + {offset});\n"
+            output += "    }\n"
+        elif field_type == "string":
+            output += f"    std::string_view {name}() const {{\n"
+            output += f"        return detail::readString(_data.data() + {offset}, {field['max_length']});\n"
+            output += "    }\n"
+        elif field_type in TYPE_MAP:
+            cpp_type = TYPE_MAP[field_type]
+            output += f"    {cpp_type} {name}() const {{\n"
+            output += f"        return detail::readWire<{cpp_type}>(_data.data() + {offset});\n"
             output += "    }\n"
+        elif is_array(field):
+            element_type = field["element_type"]
+            count = entry["count"]
+            output += f"    size_t {name}_size() const {{ return {count}; }}\n"
+            if element_type in TYPE_MAP:
+                cpp_type = TYPE_MAP[element_type]
+                output += f"    {cpp_type} {name}(size_t i) const {{\n"
+                output += f'        detail::checkIndex(i, {count}, "{label}");\n'
+                output += f"        return detail::readWire<{cpp_type}>(\n"
+                output += f"            _data.data() + {offset} + i * {SCALAR_SIZES[element_type]});\n"
+                output += "    }\n"
+            elif element_type == "string" and field_type == "fixed_array":
+                eml = field["element_max_length"]
+                output += f"    std::string_view {name}(size_t i) const {{\n"
+                output += f'        detail::checkIndex(i, {count}, "{label}");\n'
+                output += f"        return detail::readString(_data.data() + {offset} + i * {eml}, {eml});\n"
+                output += "    }\n"
+            elif element_type == "string":
+                output += "    // walks the strings before i\n"
+                output += f"    std::string_view {name}(size_t i) const;\n"
+            else:
+                output += f"    {element_type} {name}(size_t i) const;\n"
+
+    output += "\n"
+    output += "    // the bytes of the message, without what followed it in data\n"
+    output += "    std::span<const uint8_t> bytes() const { return _data; }\n"
+    output += f"    {msg_name} toMessage() const {{ return {msg_name}::deserialize(_data); }}\n\n"
+    output += " private:\n"
+    output += "    std::span<const uint8_t> _data;\n"
+    if offsets:
+        output += f"    size_t _offsets[{offsets}] = {{}};\n"
+    if counts:
+        output += f"    size_t _counts[{counts}] = {{}};\n"
+    output += "};\n\n"
+    return output
 
-        elif field_type == "double":
+
+def emit_view_struct_read(struct_name: str, structs: dict) -> str:
+    """Decode one struct element at in"""
+    output = f"    {struct_name} elem;\n\n"
+    position = 0
+
+    for struct_field in group_bit_fields(structs[struct_name]["fields"]):
+        name = struct_field["name"]
+        field_type = struct_field["type"]
+        if field_type == "bit_group":
             output += "    {\n"
-            output += "        uint64_t temp;\n"
-            temp_read = read_uint_bytes("temp", 8, "uint64_t", endianness).replace(
-                "msg.", ""
-            )
-            output += "    " + temp_read.replace("\n", "\n    ")
-            output += (
-                f"        std::memcpy(&msg.{field_name}, &temp, sizeof(double));\n"
-            )
+            output += f"        BitReader bits(in + {position}, {struct_field['size']});\n\n"
+            for bit_field in struct_field["fields"]:
+                value = decode_bit_value(bit_field, f"bits.read({bit_field['bits']})")
+                output += f"        elem.{bit_field['name']} = {value};\n"
             output += "    }\n"
+            position += struct_field["size"]
+        elif field_type == "string":
+            output += f"    std::memcpy(elem.{name}, in + {position}, {struct_field['max_length']});\n"
+            position += struct_field["max_length"]
+        elif field_type in TYPE_MAP:
+            output += f"    elem.{name} = detail::readWire<{TYPE_MAP[field_type]}>(in + {position});\n"
+            position += SCALAR_SIZES[field_type]
+        elif is_numeric_array(struct_field):
+            element_type = struct_field["element_type"]
+            elem_size = SCALAR_SIZES[element_type]
+            output += f"    for (size_t j = 0; j < {struct_field['max_size']}; ++j)\n"
+            output += f"        elem.{name}[j] = detail::readWire<{TYPE_MAP[element_type]}>(\n"
+            output += f"            in + {position} + j * {elem_size});\n"
+            position += struct_field["max_size"] * elem_size
+    output += "    return elem;\n"
+    return output
 
-        output += "\n"
 
-    output += "    return msg;\n"
+def emit_view_padding_checks(field: dict, entry: dict, structs: dict, label: str) -> str:
+    """Check the padding of the bit groups of every element of an array of
+    structs, deserialize rejects what it does not write back"""
+    element_type = field["element_type"]
+    if element_type not in structs:
+        return ""
+    paddings = struct_paddings(element_type, structs)
+    if not paddings:
+        return ""
+    elem_size = element_wire_size(element_type, structs, field)
+    output = f"    for (size_t i = 0; i < {entry['count']}; ++i) {{\n"
+    for position, used in paddings:
+        output += (
+            f"        checkPadding(data, {plus(f'offset + i * {elem_size}', position)}, "
+            f'{used}, "{label}");\n'
+        )
+    output += "    }\n"
+    return output
+
+
+def generate_view_impl(msg_name: str, msg_data: dict, structs: dict) -> str:
+    """Generate the constructor and the out of line accessors of a view"""
+    fields = msg_data["fields"]
+    layout, _, _ = view_layout(fields, structs)
+    prefix = view_prefix_size(fields, structs)
+    output = ""
+
+    output += f"{msg_name}View::{msg_name}View(std::span<const uint8_t> data)\n"
+    output += "    : _data(data) {\n"
+    output += f"    size_t offset = {prefix};\n\n"
+    output += f'    checkSize(data, 0, {prefix}, "{msg_name}");\n'
+
+    for field, entry in zip(group_bit_fields(fields), layout):
+        name = field["name"]
+        field_type = field["type"]
+        label = f"{msg_name}.{name}"
+        offset = entry["offset"]
+        padding = field_type == "bit_group" and group_padding(field)
+
+        if not offset.startswith("_offsets"):
+            if padding:
+                output += f"\n    // {name}\n"
+                output += (
+                    f"    checkPadding(data, {plus(offset, field['size'] - 1)}, "
+                    f'{padding}, "{label}");\n'
+                )
+            continue
+
+        output += f"\n    // {name}\n"
+        if is_varlen(field):
+            output += f"    {offset} = offset;\n"
+            output += f'    skipVarlen(data, offset, {field["max_length"]}, "{label}");\n'
+        elif is_varint(field):
+            output += f"    {offset} = offset;\n"
+            output += f'    readVarintField<{TYPE_MAP[field_type]}>(data, offset, "{label}");\n'
+        elif field_type == "fixed_array":
+            count = entry["count"]
+            count_field = find_count_field(name, fields)
+            elem_size = element_wire_size(field["element_type"], structs, field)
+            output += f"    {offset} = offset;\n"
+            output += f"    {count} = std::min<size_t>({count_field}(), {field['max_size']});\n"
+            output += f'    checkSize(data, offset, {count} * {elem_size}, "{label}");\n'
+            output += emit_view_padding_checks(field, entry, structs, label)
+            output += f"    offset += {count} * {elem_size};\n"
+        elif field_type == "dynamic_array":
+            count = entry["count"]
+            output += f'    checkSize(data, offset, 4, "{label}");\n'
+            output += f"    {count} = detail::readWire<uint32_t>(data.data() + offset);\n"
+            output += "    offset += 4;\n"
+            output += f"    {offset} = offset;\n"
+            if field["element_type"] == "string":
+                output += f"    for (size_t i = 0; i < {count}; ++i) {{\n"
+                output += f'        checkSize(data, offset, 4, "{label}");\n'
+                output += "        size_t length = detail::readWire<uint32_t>(data.data() + offset);\n"
+                output += f'        checkSize(data, offset + 4, length, "{label}");\n'
+                output += "        offset += 4 + length;\n"
+                output += "    }\n"
+            else:
+                elem_size = element_wire_size(field["element_type"], structs, field)
+                output += f'    checkSize(data, offset, {count} * {elem_size}, "{label}");\n'
+                output += emit_view_padding_checks(field, entry, structs, label)
+                output += f"    offset += {count} * {elem_size};\n"
+        else:
+            size = emit_size_field(field, fields, structs)[0]
+            output += f"    {offset} = offset;\n"
+            output += f'    checkSize(data, offset, {size}, "{label}");\n'
+            if padding:
+                output += (
+                    f"    checkPadding(data, {plus('offset', size - 1)}, {padding}, "
+                    f'"{label}");\n'
+                )
+            output += f"    offset += {size};\n"
+
+    output += "\n"
+    output += "    _data = data.first(offset);\n"
     output += "}\n\n"
 
+    for field, entry in zip(group_bit_fields(fields), layout):
+        if not is_array(field):
+            continue
+        name = field["name"]
+        element_type = field["element_type"]
+        label = f"{msg_name}.{name}"
+        offset = entry["offset"]
+        count = entry["count"]
+
+        if element_type == "string" and field["type"] == "dynamic_array":
+            output += f"std::string_view {msg_name}View::{name}(size_t i) const {{\n"
+            output += f'    detail::checkIndex(i, {count}, "{label}");\n'
+            output += f"    const uint8_t* in = _data.data() + {offset};\n\n"
+            output += "    for (size_t j = 0; j < i; ++j)\n"
+            output += "        in += 4 + detail::readWire<uint32_t>(in);\n"
+            output += "    return std::string_view(reinterpret_cast<const char*>(in + 4),\n"
+            output += "        detail::readWire<uint32_t>(in));\n"
+            output += "}\n\n"
+        elif element_type in structs:
+            elem_size = element_wire_size(element_type, structs, field)
+            output += f"{element_type} {msg_name}View::{name}(size_t i) const {{\n"
+            output += f'    detail::checkIndex(i, {count}, "{label}");\n'
+            output += f"    const uint8_t* in = _data.data() + {offset} + i * {elem_size};\n"
+            output += emit_view_struct_read(element_type, structs)
+            output += "}\n\n"
+    return output
+
+
+# ===== Dispatch =====
+
+
+def generate_dispatcher(protocol: dict) -> str:
+    """Generate MessageDispatcher, a table of handlers indexed by message ID"""
+    messages = protocol["messages"]
+    table_size = max((m["id"] for m in messages.values()), default=0) + 1
+    by_id = {m["id"]: name for name, m in messages.items()}
+    handlers = []
+    receivers = []
+    for msg_name, msg_data in messages.items():
+        handlers.append(f"Handler<{msg_name}>")
+        if has_view(msg_data):
+            handlers.append(f"Handler<{msg_name}View>")
+        if is_delta(msg_data):
+            handlers.append(f"Handler<DeltaPayload<{msg_name}>>")
+            receivers.append(f"DeltaReceiver<{msg_name}>")
+    output = ""
+
+    output += "// Calls the handler registered for the ID of a message (its first byte),\n"
+    output += "// the message decoded once on the way. A handler takes the message, or\n"
+    output += "// its view to read it in place:\n"
+    output += "//     dispatcher.on<LOGIN_REQUEST>([](const LOGIN_REQUEST& msg) {...});\n"
+    output += "//     dispatcher.on<LOGIN_REQUESTView>([](const LOGIN_REQUESTView& view) {...});\n"
+    output += "// The view handler wins when both are set.\n"
+    output += "// \"delta\" messages are decoded against the ones received before, by the\n"
+    output += "// receiver<T>() of the dispatcher, one peer per dispatcher. To decode them\n"
+    output += "// per peer instead, take them undecoded with on<DeltaPayload<T>>, which\n"
+    output += "// wins too.\n"
+    output += "class MessageDispatcher {\n"
+    output += " public:\n"
+    output += "    // what dispatch throws for a message it can't decode, the errors of\n"
+    output += "    // the handlers go through as they are\n"
+    output += "    class MalformedMessage : public std::runtime_error {\n"
+    output += "     public:\n"
+    output += "        using std::runtime_error::runtime_error;\n"
+    output += "    };\n\n"
+    output += "    template<typename T, typename F>\n"
+    output += "    void on(F&& handler) {\n"
+    output += "        std::get<Handler<T>>(_handlers) = std::forward<F>(handler);\n"
+    output += "    }\n\n"
+    output += "    // decodes the delta message T for on<T>, latest() is the sequence to\n"
+    output += "    // acknowledge, reset() forgets the baselines of a previous connection\n"
+    output += "    template<typename T>\n"
+    output += "    DeltaReceiver<T>& receiver() {\n"
+    output += "        return std::get<DeltaReceiver<T>>(_receivers);\n"
+    output += "    }\n\n"
+    output += "    // false if no handler takes the ID, throws std::runtime_error if the\n"
+    output += "    // message is truncated\n"
+    output += "    bool dispatch(std::span<const uint8_t> message,\n"
+    output += "        std::pmr::memory_resource* scratch = nullptr) {\n"
+    output += f"        static constexpr Entry TABLE[{table_size}] = {{\n"
+    for message_id in range(table_size):
+        entry = f"decode<{by_id[message_id]}>" if message_id in by_id else "nullptr"
+        output += f"            {entry},\n"
+    output += "        };\n\n"
+    output += f"        if (message.empty() || message[0] >= {table_size} || !TABLE[message[0]])\n"
+    output += "            return false;\n"
+    output += "        return TABLE[message[0]](*this, message, scratch);\n"
+    output += "    }\n\n"
+    output += "    // every message of a batch, e.g. the packets of one unpack call, in\n"
+    output += "    // order: compressed ones are decompressed one after the other in the\n"
+    output += "    // same buffer. A malformed message is counted in errors() and skipped,\n"
+    output += "    // the next ones are still dispatched, while an error thrown by a handler\n"
+    output += "    // stops the batch. Returns the number handled\n"
+    output += "    template<typename Messages>\n"
+    output += "    size_t dispatchAll(Messages&& messages,\n"
+    output += "        std::pmr::memory_resource* scratch = nullptr) {\n"
+    output += "        size_t handled = 0;\n\n"
+    output += "        // read in the try too, a lazy range may throw there\n"
+    output += "        for (auto it = std::ranges::begin(messages);\n"
+    output += "            it != std::ranges::end(messages); ++it) {\n"
+    output += "            try {\n"
+    output += "                handled += dispatch(std::span<const uint8_t>(*it), scratch);\n"
+    output += "            } catch (const MalformedMessage&) {\n"
+    output += "                _errors++;\n"
+    output += "            }\n"
+    output += "        }\n"
+    output += "        return handled;\n"
+    output += "    }\n\n"
+    output += "    // malformed messages skipped by dispatchAll so far\n"
+    output += "    uint64_t errors() const { return _errors; }\n\n"
+    output += " private:\n"
+    output += "    template<typename T>\n"
+    output += "    using Handler = std::function<void(const T&)>;\n"
+    output += "    using Entry = bool (*)(MessageDispatcher&, std::span<const uint8_t>,\n"
+    output += "        std::pmr::memory_resource*);\n\n"
+    output += "    // decoding errors become MalformedMessage, the handler is called after\n"
+    output += "    template<typename F>\n"
+    output += "    static decltype(auto) decoding(F&& decode) {\n"
+    output += "        try {\n"
+    output += "            return decode();\n"
+    output += "        } catch (const std::runtime_error& e) {\n"
+    output += "            throw MalformedMessage(e.what());\n"
+    output += "        }\n"
+    output += "    }\n\n"
+    output += "    template<typename T>\n"
+    output += "    static bool decode(MessageDispatcher& self, std::span<const uint8_t> message,\n"
+    output += "        std::pmr::memory_resource* scratch) {\n"
+    output += "        if constexpr (requires { typename T::View; }) {\n"
+    output += "            auto& onView = std::get<Handler<typename T::View>>(self._handlers);\n"
+    output += "            if (onView) {\n"
+    output += "                onView(decoding([&] { return typename T::View(message); }));\n"
+    output += "                return true;\n"
+    output += "            }\n"
+    output += "        }\n"
+    output += "        auto& onMessage = std::get<Handler<T>>(self._handlers);\n"
+    output += "        if constexpr (requires { T::readDeltaHeader(message); }) {\n"
+    output += "            auto& onPayload = std::get<Handler<DeltaPayload<T>>>(self._handlers);\n"
+    output += "            if (onPayload) {\n"
+    output += "                onPayload(DeltaPayload<T>{\n"
+    output += "                    decoding([&] { return T::readDeltaHeader(message); }), message});\n"
+    output += "                return true;\n"
+    output += "            }\n"
+    output += "            if (!onMessage)\n"
+    output += "                return false;\n"
+    output += "            onMessage(decoding([&]() -> const T& {\n"
+    output += "                return self.receiver<T>().decode(message);\n"
+    output += "            }));\n"
+    output += "            return true;\n"
+    output += "        } else {\n"
+    output += "            if (!onMessage)\n"
+    output += "                return false;\n"
+    output += "            onMessage(decoding([&] { return T::deserialize(message, scratch); }));\n"
+    output += "            return true;\n"
+    output += "        }\n"
+    output += "    }\n\n"
+    output += "    std::tuple<\n"
+    output += ",\n".join(f"        {handler}" for handler in handlers) + "\n"
+    output += "    > _handlers;\n"
+    if receivers:
+        output += "    std::tuple<\n"
+        output += ",\n".join(f"        {receiver}" for receiver in receivers) + "\n"
+        output += "    > _receivers;\n"
+    else:
+        output += "    std::tuple<> _receivers;\n"
+    output += "    uint64_t _errors = 0;\n"
+    output += "};\n\n"
     return output
 
 
@@ -1167,19 +2445,79 @@ def generate_source(protocol: dict, endianness: str) -> str:
     """Generate the complete .cpp file containing all definitions of"""
     """ serialize and deserialize methods of protocol struct"""
     output = ""
+    structs = protocol.get("structs", {})
+
+    output += "#include <algorithm>\n"
+    output += "#include <bit>\n"
+    output += "#include <limits>\n"
+    output += "#include <stdexcept>\n"
+    output += "#include <string>\n"
+    output += "#include <type_traits>\n\n"
+    output += '#include "Network/ByteSwap.hpp"\n'
+    output += '#include "Network/Lz4.hpp"\n'
     output += '#include "Network/generated_messages.hpp"\n\n'
     output += "namespace net {\n\n"
-
-    structs = protocol.get("structs", {})
+    output += "namespace {\n\n"
+    output += "// every read of deserialize is checked, the bytes come from the wire\n"
+    output += "void checkSize(std::span<const uint8_t> data, size_t offset, size_t size,\n"
+    output += "    const char* field) {\n"
+    output += "    if (offset > data.size() || data.size() - offset < size)\n"
+    output += '        throw std::runtime_error(std::string("Truncated message at ") + field);\n'
+    output += "}\n\n"
+    output += "// the wire is " + endianness + " endian, whatever the host\n"
+    output += "template<typename T>\n"
+    output += "void writeWire(uint8_t* out, T value) {\n"
+    output += "    if constexpr (std::is_floating_point_v<T>) {\n"
+    output += "        using Bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;\n"
+    output += "        writeWire(out, std::bit_cast<Bits>(value));\n"
+    output += "    } else {\n"
+    output += f"        if constexpr (sizeof(T) > 1 && std::endian::native != std::endian::{endianness})\n"
+    output += "            value = std::byteswap(value);\n"
+    output += "        std::memcpy(out, &value, sizeof(T));\n"
+    output += "    }\n"
+    output += "}\n\n"
+    output += "// numeric arrays in one go, a plain copy when the host matches the wire\n"
+    output += "template<typename T>\n"
+    output += "void writeWireArray(uint8_t* out, const T* values, size_t count) {\n"
+    output += f"    if constexpr (sizeof(T) > 1 && std::endian::native != std::endian::{endianness})\n"
+    output += "        byteswapCopy(out, values, count, sizeof(T));\n"
+    output += "    else if (count > 0)\n"
+    output += "        std::memcpy(out, values, count * sizeof(T));\n"
+    output += "}\n\n"
+    output += "template<typename T>\n"
+    output += "void readWireArray(T* values, const uint8_t* in, size_t count) {\n"
+    output += f"    if constexpr (sizeof(T) > 1 && std::endian::native != std::endian::{endianness})\n"
+    output += "        byteswapCopy(values, in, count, sizeof(T));\n"
+    output += "    else if (count > 0)\n"
+    output += "        std::memcpy(values, in, count * sizeof(T));\n"
+    output += "}\n\n"
+    output += generate_encoding_helpers(protocol)
+    output += generate_delta_helpers(protocol)
+    output += generate_dictionaries(protocol)
+    output += generate_decompression_buffer(protocol)
+    for msg_name, msg_data in protocol["messages"].items():
+        if is_delta(msg_data):
+            output += generate_delta_body_impl(msg_name, msg_data["fields"], structs)
+        else:
+            output += generate_body_impl(msg_name, msg_data["fields"], structs)
+    output += "}  // namespace\n\n"
 
     for msg_name, msg_data in protocol["messages"].items():
-        compressed = msg_data.get("compressed", False)
+        compression = msg_data if msg_data.get("compressed", False) else None
+        if is_delta(msg_data):
+            output += generate_delta_serialize_impl(msg_name)
+            output += generate_delta_deserialize_impl(
+                msg_name, msg_data["fields"], endianness, structs
+            )
+            continue
         output += generate_serialize_impl(
-            msg_name, msg_data["fields"], endianness, structs, compressed
+            msg_name, msg_data["fields"], endianness, structs, compression
         )
         output += generate_deserialize_impl(
-            msg_name, msg_data["fields"], endianness, structs, compressed
+            msg_name, msg_data["fields"], endianness, structs, compression
         )
+        if has_view(msg_data):
+            output += generate_view_impl(msg_name, msg_data, structs)
 
     output += "}  // namespace net\n"
     return output
@@ -1198,9 +2536,10 @@ def main():
 
     protocol = load_protocol(sys.argv[1])
     validate_protocol(protocol)
+    load_dictionaries(protocol, sys.argv[1])
     endianness = get_endianness(protocol)
 
-    header = generate_header(protocol)
+    header = generate_header(protocol, endianness)
     write_file("include/Network/generated_messages.hpp", header)
     source = generate_source(protocol, endianness)
     write_file("src/generated_messages.cpp", source)
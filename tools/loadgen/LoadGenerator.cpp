@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "LoadGenerator.hpp"
+
+namespace loadgen {
+
+// clients connected per loop, keeps sending going while ramping up
+#define MAX_CONNECTS_PER_LOOP 256
+// a client that fell behind by more than this skips the missed messages
+#define MAX_SEND_LAG std::chrono::seconds(1)
+
+namespace {
+
+// Client prints every connection, silence it with thousands of them
+class NullBuffer : public std::streambuf {
+ protected:
+    int overflow(int c) override { return c; }
+};
+
+class QuietStdout {
+ public:
+    QuietStdout() : _old(std::cout.rdbuf(&_null)) {}
+    ~QuietStdout() { std::cout.rdbuf(_old); }
+
+ private:
+    NullBuffer _null;
+    std::streambuf* _old;
+};
+
+Json::Value toJson(uint64_t value) {
+    return Json::Value(static_cast<Json::UInt64>(value));
+}
+
+}  // namespace
+
+LoadGenerator::LoadGenerator(const Options& options)
+    : _options(options),
+    _mix(options.config, options.mix, options.rawSize),
+    _protocol(options.config),
+    _sentPerMessage(_mix.messages().size(), 0),
+    _rng(std::random_device{}()) {
+    if (_options.stages.empty())
+        throw std::runtime_error("No stage given");
+}
+
+Json::Value LoadGenerator::run() {
+    double total = 0;
+    for (const Stage& stage : _options.stages)
+        total += stage.duration;
+
+    Json::Value timeline(Json::arrayValue);
+    auto start = Clock::now();
+    auto last = start;
+    double nextReport = 1;
+    double elapsed = 0;
+
+    while (elapsed < total) {
+        auto now = Clock::now();
+        elapsed = std::chrono::duration<double>(now - start).count();
+        size_t target = targetClients(elapsed);
+
+        for (int i = 0; i < MAX_CONNECTS_PER_LOOP && _clients.size() < target;
+            ++i) {
+            if (!connectOne(now))
+                break;
+        }
+        while (_clients.size() > target)
+            disconnectOne();
+        churn(std::chrono::duration<double>(now - last).count(), now);
+        _peakClients = std::max(_peakClients, _clients.size());
+        last = now;
+
+        for (size_t i = 0; i < _clients.size(); ++i) {
+            sendDue(_clients[i], now);
+            receive(_clients[i]);
+        }
+
+        if (elapsed >= nextReport) {
+            timeline.append(snapshot(elapsed));
+            nextReport += 1;
+        }
+        if (_clients.empty())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    while (!_clients.empty())
+        disconnectOne();
+    timeline.append(snapshot(elapsed));
+    return results(elapsed, timeline);
+}
+
+size_t LoadGenerator::targetClients(double elapsed) const {
+    double begin = 0;
+    size_t from = 0;
+
+    for (const Stage& stage : _options.stages) {
+        if (elapsed < begin + stage.duration) {
+            double progress = stage.duration > 0
+                ? (elapsed - begin) / stage.duration : 1;
+            double count = from + (static_cast<double>(stage.clients) -
+                static_cast<double>(from)) * progress;
+            return static_cast<size_t>(count + 0.5);
+        }
+        begin += stage.duration;
+        from = stage.clients;
+    }
+    return from;
+}
+
+bool LoadGenerator::connectOne(Clock::time_point now) {
+    QuietStdout quiet;
+    auto client = std::make_unique<net::Client>(_options.protocol,
+        _options.config, false);
+
+    if (!client->connect(_options.host, _options.port) ||
+        !client->setNonBlocking(true)) {
+        _total.connectFailures++;
+        return false;
+    }
+    _total.connects++;
+
+    // spread the first sends over one interval so clients don't send in sync
+    Clock::time_point first = now;
+    if (_options.rate > 0) {
+        std::uniform_real_distribution<double> jitter(0, 1 / _options.rate);
+        first += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(jitter(_rng)));
+    }
+    _clients.push_back({std::move(client), first});
+    return true;
+}
+
+void LoadGenerator::disconnectOne() {
+    QuietStdout quiet;
+
+    _clients.pop_back();
+    _total.disconnects++;
+}
+
+void LoadGenerator::churn(double seconds, Clock::time_point now) {
+    _churnDebt += static_cast<double>(_clients.size()) * _options.churn *
+        seconds;
+
+    while (_churnDebt >= 1 && !_clients.empty()) {
+        std::uniform_int_distribution<size_t> index(0, _clients.size() - 1);
+        std::swap(_clients[index(_rng)], _clients.back());
+        disconnectOne();
+        connectOne(now);
+        _churnDebt -= 1;
+    }
+    if (_clients.empty())
+        _churnDebt = 0;
+}
+
+void LoadGenerator::sendDue(SimulatedClient& simulated,
+    Clock::time_point now) {
+    if (_options.rate <= 0)
+        return;
+
+    auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1 / _options.rate));
+    if (now - simulated.nextSend > MAX_SEND_LAG)
+        simulated.nextSend = now;
+
+    while (simulated.nextSend <= now) {
+        size_t index = _mix.pick(_rng);
+        const std::vector<uint8_t>& payload = _mix.messages()[index].payload;
+
+        if (simulated.client->send(payload)) {
+            _total.sent++;
+            _total.bytesOut +=
+                payload.size() + _protocol.getProtocolOverhead();
+            _sentPerMessage[index]++;
+        } else {
+            _total.sendFailures++;
+        }
+        simulated.nextSend += interval;
+    }
+}
+
+void LoadGenerator::receive(SimulatedClient& simulated) {
+    net::Client& client = *simulated.client;
+
+    if (!client.isConnected())
+        return;
+    if (client.getProtocol() == net::SocketType::TCP)
+        client.tcpReceive(0);
+    else
+        client.udpReceive(0, 64);
+
+    for (auto& packet : client.extractPacketsFromBuffer()) {
+        _total.received++;
+        _total.bytesIn += packet.size() + _protocol.getProtocolOverhead();
+    }
+}
+
+Json::Value LoadGenerator::snapshot(double elapsed) const {
+    Json::Value line;
+
+    line["time"] = elapsed;
+    line["clients"] = toJson(_clients.size());
+    line["connects"] = toJson(_total.connects);
+    line["connect_failures"] = toJson(_total.connectFailures);
+    line["disconnects"] = toJson(_total.disconnects);
+    line["sent"] = toJson(_total.sent);
+    line["send_failures"] = toJson(_total.sendFailures);
+    line["bytes_out"] = toJson(_total.bytesOut);
+    line["received"] = toJson(_total.received);
+    line["bytes_in"] = toJson(_total.bytesIn);
+    return line;
+}
+
+Json::Value LoadGenerator::results(double elapsed,
+    const Json::Value& timeline) const {
+    Json::Value root;
+    Json::Value& options = root["options"];
+
+    options["host"] = _options.host;
+    options["port"] = _options.port;
+    options["protocol"] = _options.protocol;
+    options["config"] = _options.config;
+    options["rate"] = _options.rate;
+    options["churn"] = _options.churn;
+    for (const Stage& stage : _options.stages) {
+        Json::Value value;
+        value["duration"] = stage.duration;
+        value["clients"] = toJson(stage.clients);
+        options["stages"].append(value);
+    }
+
+    Json::Value& messages = root["messages"];
+    for (size_t i = 0; i < _mix.messages().size(); ++i) {
+        const MessageMix::Message& message = _mix.messages()[i];
+        messages[message.name]["weight"] = message.weight;
+        messages[message.name]["payload_size"] =
+            toJson(message.payload.size());
+        messages[message.name]["sent"] = toJson(_sentPerMessage[i]);
+    }
+
+    Json::Value& totals = root["totals"];
+    totals = snapshot(elapsed);
+    totals.removeMember("clients");
+    totals["duration"] = elapsed;
+    totals["peak_clients"] = toJson(_peakClients);
+    totals["sent_per_second"] = elapsed > 0 ? _total.sent / elapsed : 0;
+    totals["received_per_second"] =
+        elapsed > 0 ? _total.received / elapsed : 0;
+
+    root["timeline"] = timeline;
+    return root;
+}
+
+}  // namespace loadgen
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <json/json.h>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "MessageMix.hpp"
+#include "Network/Client.hpp"
+#include "Network/ProtocolManager.hpp"
+
+namespace loadgen {
+
+/**
+ * @brief Step of the load profile
+ *
+ * The number of clients moves linearly from the previous stage target to
+ * this one over the stage duration.
+ */
+struct Stage {
+    double duration;
+    size_t clients;
+};
+
+struct Options {
+    std::string host = "127.0.0.1";
+    uint16_t port = 4242;
+    std::string protocol = "UDP";
+    std::string config = "config/protocol.json";
+    std::vector<Stage> stages;
+    std::map<std::string, uint32_t> mix;
+    // messages per second sent by each client
+    double rate = 10;
+    // fraction of the connected clients replaced every second
+    double churn = 0;
+    size_t rawSize = 64;
+    std::string results = "loadgen_results.json";
+};
+
+/**
+ * @brief Simulate many Clients from a single thread
+ *
+ * Every Client is non-blocking and polled in turn: they connect following
+ * the stages, send the message mix at a fixed rate each and drain what the
+ * Server sends back. A line of statistics is kept for every second.
+ */
+class LoadGenerator {
+ public:
+    explicit LoadGenerator(const Options& options);
+
+    /**
+     * @brief Run every stage
+     *
+     * @return Json::Value The results, options and per second timeline
+     */
+    Json::Value run();
+
+ private:
+    using Clock = std::chrono::steady_clock;
+
+    struct SimulatedClient {
+        std::unique_ptr<net::Client> client;
+        Clock::time_point nextSend;
+    };
+
+    struct Counters {
+        uint64_t connects = 0;
+        uint64_t connectFailures = 0;
+        uint64_t disconnects = 0;
+        uint64_t sent = 0;
+        uint64_t sendFailures = 0;
+        uint64_t bytesOut = 0;
+        uint64_t received = 0;
+        uint64_t bytesIn = 0;
+    };
+
+    size_t targetClients(double elapsed) const;
+    bool connectOne(Clock::time_point now);
+    void disconnectOne();
+    void churn(double seconds, Clock::time_point now);
+    void sendDue(SimulatedClient& simulated, Clock::time_point now);
+    void receive(SimulatedClient& simulated);
+    Json::Value snapshot(double elapsed) const;
+    Json::Value results(double elapsed, const Json::Value& timeline) const;
+
+    Options _options;
+    MessageMix _mix;
+    net::ProtocolManager _protocol;
+    std::vector<SimulatedClient> _clients;
+    std::vector<uint64_t> _sentPerMessage;
+    Counters _total;
+    double _churnDebt = 0;
+    size_t _peakClients = 0;
+    std::mt19937 _rng;
+};
+
+}  // namespace loadgen
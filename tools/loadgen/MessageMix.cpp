@@ -0,0 +1,87 @@
+#include <json/json.h>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "MessageMix.hpp"
+#include "Network/generated_messages.hpp"
+
+namespace loadgen {
+
+static void fill(char* text, size_t size) {
+    static const std::string pattern = "net_loadgen ";
+
+    for (size_t i = 0; i < size; ++i)
+        text[i] = pattern[i % pattern.size()];
+}
+
+// strings filled up to their size, numbers at 0 and arrays empty, then the
+// generated serialize(): compressed, delta or plain like any other sender
+template<typename T>
+static std::vector<uint8_t> sample() {
+    T message{};
+
+#define NET_LOADGEN_FILL(type, field) \
+    if constexpr (std::is_same_v<T, net::type>) \
+        fill(message.field, sizeof(message.field));
+    NET_GENERATED_STRINGS(NET_LOADGEN_FILL)
+#undef NET_LOADGEN_FILL
+    return message.serialize();
+}
+
+#define NET_LOADGEN_SAMPLE(name, id) {#name, sample<net::name>},
+static const std::map<std::string, std::vector<uint8_t> (*)()> SAMPLES = {
+    NET_GENERATED_MESSAGES(NET_LOADGEN_SAMPLE)
+};
+#undef NET_LOADGEN_SAMPLE
+
+MessageMix::MessageMix(const std::string& path,
+    const std::map<std::string, uint32_t>& weights, size_t rawSize) {
+    std::ifstream file(path, std::ifstream::binary);
+    Json::CharReaderBuilder builder;
+    Json::Value protocol;
+    std::string errs;
+
+    if (!file)
+        throw std::runtime_error("Invalid protocol config path: " + path);
+    if (!Json::parseFromStream(builder, file, &protocol, &errs))
+        throw std::runtime_error("Invalid JSON format: " + errs);
+
+    const Json::Value& messages = protocol["messages"];
+
+    for (const std::string& name : messages.getMemberNames()) {
+        uint32_t weight = weights.empty() ? 1 : 0;
+        if (weights.contains(name))
+            weight = weights.at(name);
+        if (weight == 0)
+            continue;
+        if (!SAMPLES.contains(name)) {
+            throw std::runtime_error("Message not in the generated code: " +
+                name + ", regenerate it from " + path);
+        }
+        _messages.push_back({name, SAMPLES.at(name)(), weight});
+    }
+    for (auto& [name, weight] : weights) {
+        if (!messages.isMember(name))
+            throw std::runtime_error("Unknown message in mix: " + name);
+    }
+    if (messages.empty())
+        _messages.push_back({"RAW", std::vector<uint8_t>(rawSize, 'x'), 1});
+    if (_messages.empty())
+        throw std::runtime_error("Every message of the mix has a weight of 0");
+
+    std::vector<double> probabilities;
+    for (const Message& message : _messages)
+        probabilities.push_back(message.weight);
+    _distribution = std::discrete_distribution<size_t>(
+        probabilities.begin(), probabilities.end());
+}
+
+size_t MessageMix::pick(std::mt19937& rng) {
+    return _distribution(rng);
+}
+
+}  // namespace loadgen
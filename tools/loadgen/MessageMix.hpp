@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace loadgen {
+
+/**
+ * @brief Weighted set of messages to send, read from protocol.json
+ *
+ * Each message of the "messages" section is serialized once by the
+ * generated code (include/Network/generated_messages.hpp), strings filled up
+ * to their max_length, numbers at 0 and arrays empty. The protocol.json must
+ * be the one the code was generated from.
+ *
+ * Without a "messages" section, a single RAW message of rawSize bytes is used.
+ */
+class MessageMix {
+ public:
+    struct Message {
+        std::string name;
+        std::vector<uint8_t> payload;
+        uint32_t weight;
+    };
+
+    /**
+     * @brief Construct a new MessageMix object
+     *
+     * @param path Path to the protocol.json
+     * @param weights Weight of each message by name, every message has a
+     *  weight of 1 if empty
+     * @param rawSize Payload size used when there is no "messages" section
+     */
+    MessageMix(const std::string& path,
+        const std::map<std::string, uint32_t>& weights, size_t rawSize);
+
+    /**
+     * @brief Pick a message, proportionally to the weights
+     *
+     * @param rng Random generator
+     * @return size_t Index of the message in messages()
+     */
+    size_t pick(std::mt19937& rng);
+
+    const std::vector<Message>& messages() const { return _messages; }
+
+ private:
+    std::vector<Message> _messages;
+    std::discrete_distribution<size_t> _distribution;
+};
+
+}  // namespace loadgen
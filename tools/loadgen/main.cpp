@@ -0,0 +1,131 @@
+#include <json/json.h>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+    #include <sys/resource.h>
+#endif
+
+#include "LoadGenerator.hpp"
+
+static void usage() {
+    std::cout
+        << "USAGE: net_loadgen [options]\n"
+        << "    --host IP              Server IP (127.0.0.1)\n"
+        << "    --port PORT            Server port (4242)\n"
+        << "    --protocol udp|tcp     Clients protocol (udp)\n"
+        << "    --config PATH          protocol.json (config/protocol.json)\n"
+        << "    --stage SECONDS:N      Go to N clients over SECONDS,"
+        << " repeat for a profile (10:100)\n"
+        << "    --mix NAME:WEIGHT      Message weight, repeat for each"
+        << " message (all messages, weight 1)\n"
+        << "    --rate N               Messages per second per client (10)\n"
+        << "    --churn FRACTION       Clients replaced per second, 0.05 is"
+        << " 5% (0)\n"
+        << "    --size BYTES           Payload size when protocol.json has"
+        << " no messages (64)\n"
+        << "    --results PATH         JSON results (loadgen_results.json)\n"
+        << "\nExample, ramp to 2000 clients in 30s, hold 60s, ramp down:\n"
+        << "    net_loadgen --stage 30:2000 --stage 60:2000 --stage 10:0\n";
+}
+
+static std::pair<std::string, std::string> splitPair(const std::string& arg) {
+    size_t colon = arg.rfind(':');
+    if (colon == std::string::npos)
+        throw std::invalid_argument("Expected KEY:VALUE, got " + arg);
+    return {arg.substr(0, colon), arg.substr(colon + 1)};
+}
+
+static loadgen::Options parseOptions(int argc, char** argv) {
+    loadgen::Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+            throw std::invalid_argument("Missing value for " + arg);
+        std::string value = argv[++i];
+
+        if (arg == "--host") {
+            options.host = value;
+        } else if (arg == "--port") {
+            options.port = static_cast<uint16_t>(std::stoul(value));
+        } else if (arg == "--protocol") {
+            options.protocol = value;
+        } else if (arg == "--config") {
+            options.config = value;
+        } else if (arg == "--stage") {
+            auto [duration, clients] = splitPair(value);
+            options.stages.push_back({std::stod(duration),
+                std::stoul(clients)});
+        } else if (arg == "--mix") {
+            auto [name, weight] = splitPair(value);
+            options.mix[name] = static_cast<uint32_t>(std::stoul(weight));
+        } else if (arg == "--rate") {
+            options.rate = std::stod(value);
+        } else if (arg == "--churn") {
+            options.churn = std::stod(value);
+        } else if (arg == "--size") {
+            options.rawSize = std::stoul(value);
+        } else if (arg == "--results") {
+            options.results = value;
+        } else {
+            throw std::invalid_argument("Unknown option " + arg);
+        }
+    }
+    if (options.stages.empty())
+        options.stages.push_back({10, 100});
+    return options;
+}
+
+// a socket per client, thousands of them need more than the usual 1024 fds
+static void raiseFileLimit() {
+#ifndef _WIN32
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 &&
+        limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+#endif
+}
+
+int main(int argc, char** argv) {
+    loadgen::Options options;
+
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "net_loadgen: " << e.what() << std::endl;
+        usage();
+        return 84;
+    }
+
+    try {
+        raiseFileLimit();
+        loadgen::LoadGenerator generator(options);
+        Json::Value results = generator.run();
+
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "  ";
+        std::ofstream file(options.results);
+        if (!file)
+            throw std::runtime_error("Cannot write " + options.results);
+        file << Json::writeString(builder, results) << std::endl;
+
+        const Json::Value& totals = results["totals"];
+        std::cout << "peak clients " << totals["peak_clients"].asUInt64()
+                  << "\tsent " << totals["sent"].asUInt64()
+                  << "\treceived " << totals["received"].asUInt64()
+                  << "\tsend failures " << totals["send_failures"].asUInt64()
+                  << "\tconnect failures "
+                  << totals["connect_failures"].asUInt64() << "\n"
+                  << "results written to " << options.results << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "net_loadgen: " << e.what() << std::endl;
+        return 84;
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "Replayer.hpp"
+
+namespace replay {
+
+// drain the embedded Server for that long once everything was sent
+#define DRAIN_TIME std::chrono::milliseconds(200)
+
+Replayer::Replayer(const Options& options)
+    : _options(options),
+    _reader(options.capture),
+    _target(options.embedded ? "127.0.0.1" : options.host, options.port) {
+    if (_options.speed < 0)
+        throw std::invalid_argument("Speed can't be negative");
+}
+
+void Replayer::run() {
+    net::PcapReader::Packet packet;
+    uint64_t firstTimestamp = 0;
+    Clock::time_point start;
+
+    while (_reader.next(packet)) {
+        if (_options.capturePort == 0)
+            _options.capturePort = packet.destination.getPort();
+        if (packet.destination.getPort() != _options.capturePort) {
+            _skipped++;
+            continue;
+        }
+
+        if (_packets == 0) {
+            // the first packet gives the protocol of the Server
+            if (_options.embedded) {
+                _server = std::make_unique<net::Server>(_options.port,
+                    packet.type == net::SocketType::TCP ? "TCP" : "UDP",
+                    _options.config, false);
+                _server->start();
+                _server->setNonBlocking(true);
+                _server->setLatencyTracking(true);
+            }
+            firstTimestamp = packet.timestamp;
+            start = Clock::now();
+        }
+
+        // captures aren't always in order, an older packet is sent now
+        uint64_t offset = packet.timestamp > firstTimestamp
+            ? packet.timestamp - firstTimestamp : 0;
+        if (_options.speed > 0) {
+            auto due = start + std::chrono::nanoseconds(
+                static_cast<uint64_t>(offset / _options.speed));
+            waitUntil(due);
+            auto late = Clock::now() - due;
+            _lateness.record(late.count() > 0
+                ? static_cast<uint64_t>(late.count()) : 0);
+        }
+        send(packet);
+        _capturedDuration = std::max(_capturedDuration, offset / 1e9);
+        if (_server)
+            pumpServer(0);
+    }
+
+    if (_packets > 0)
+        _duration = std::chrono::duration<double>(Clock::now() - start)
+            .count();
+    if (_server) {
+        auto end = Clock::now() + DRAIN_TIME;
+        while (Clock::now() < end)
+            pumpServer(5);
+    }
+}
+
+net::NetworkSocket& Replayer::flow(const net::PcapReader::Packet& packet) {
+    auto& socket = _flows[packet.source.toKey()];
+
+    if (socket)
+        return *socket;
+    socket = std::make_unique<net::NetworkSocket>();
+    if (!socket->create(packet.type))
+        throw net::NetworkSocket::SocketCreationError();
+    if (packet.type == net::SocketType::TCP && !socket->connect(_target))
+        throw std::runtime_error("Cannot connect to " + _target.getIP() +
+            ":" + std::to_string(_target.getPort()));
+    if (_server && packet.type == net::SocketType::TCP)
+        pumpServer(0);  // accept it before it sends
+    return *socket;
+}
+
+void Replayer::send(const net::PcapReader::Packet& packet) {
+    net::NetworkSocket& socket = flow(packet);
+    size_t sent = 0;
+
+    if (packet.type == net::SocketType::UDP) {
+        int result = socket.sendTo(packet.data.data(), packet.data.size(),
+            _target);
+        sent = result > 0 ? result : 0;
+    } else {
+        while (sent < packet.data.size()) {
+            int result = socket.send(packet.data.data() + sent,
+                packet.data.size() - sent);
+            if (result <= 0)
+                break;
+            sent += result;
+        }
+    }
+    if (sent == packet.data.size()) {
+        _packets++;
+        _bytes += sent;
+    } else {
+        _sendFailures++;
+    }
+}
+
+void Replayer::waitUntil(Clock::time_point due) {
+    while (true) {
+        auto left = due - Clock::now();
+        if (left <= Clock::duration::zero())
+            return;
+        if (_server) {
+            pumpServer(static_cast<int>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(left)
+                    .count()));
+        } else if (left > std::chrono::milliseconds(1)) {
+            // wake up early, the end is spun for precision
+            std::this_thread::sleep_for(left - std::chrono::milliseconds(1));
+        }
+    }
+}
+
+void Replayer::pumpServer(int timeout) {
+    if (_server->getProtocol() == net::SocketType::UDP) {
+        for (const net::Address& client : _server->udpReceive(timeout, 256))
+            _unpacked += _server->unpack(client, -1).size();
+    } else {
+        for (int client : _server->tcpReceive(timeout))
+            _unpacked += _server->unpack(client, -1).size();
+    }
+}
+
+void Replayer::report(std::ostream& out) const {
+    auto us = [](uint64_t ns) { return ns / 1000.0; };
+
+    out << std::fixed << std::setprecision(3)
+        << "replayed " << _packets << " packets, " << _bytes << " bytes from "
+        << _flows.size() << " clients in " << _duration << "s (captured "
+        << _capturedDuration << "s)\n"
+        << "skipped " << _skipped << " packets not sent to port "
+        << _options.capturePort << ", " << _sendFailures
+        << " send failures\n";
+    if (_lateness.count() > 0) {
+        out << std::setprecision(1) << "send lateness (us)\tp50 "
+            << us(_lateness.percentile(50)) << "\tp99 "
+            << us(_lateness.percentile(99)) << "\tmax "
+            << us(_lateness.max()) << "\n";
+    }
+    if (!_server)
+        return;
+
+    const net::Server::Metrics& metrics = _server->getMetrics();
+    out << "server unpacked " << _unpacked << " packets, "
+        << metrics.framingErrors.value() << " framing errors, "
+        << metrics.bytesIn.value() << " bytes in\n";
+    _server->dumpLatencies(out);
+}
+
+}  // namespace replay
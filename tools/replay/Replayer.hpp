@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include "Network/LatencyHistogram.hpp"
+#include "Network/NetworkSocket.hpp"
+#include "Network/Pcap.hpp"
+#include "Network/Server.hpp"
+
+namespace replay {
+
+struct Options {
+    std::string capture;
+    // port the captured Server listened on, 0 for the destination of the
+    // first packet
+    uint16_t capturePort = 0;
+    std::string host = "127.0.0.1";
+    uint16_t port = 4242;
+    // run a Server in process instead of sending to host:port
+    bool embedded = false;
+    std::string config = "config/protocol.json";
+    // 1 replays at the captured pace, 2 twice as fast, 0 without waiting
+    double speed = 1;
+};
+
+/**
+ * @brief Send the packets of a capture to a Server again
+ *
+ * Only packets sent to the captured Server port are replayed, each source
+ * address gets its own socket so the Server sees as many clients as in the
+ * capture. Packets keep their original spacing, divided by the speed.
+ *
+ * In embedded mode the Server is created in process and polled between
+ * sends from the same thread: everything is unpacked, and its metrics and
+ * latencies are reported at the end.
+ */
+class Replayer {
+ public:
+    explicit Replayer(const Options& options);
+
+    /**
+     * @brief Replay the whole capture
+     */
+    void run();
+
+    /**
+     * @brief Write the replay statistics
+     *
+     * @param out Stream to write to
+     */
+    void report(std::ostream& out) const;
+
+ private:
+    using Clock = std::chrono::steady_clock;
+
+    net::NetworkSocket& flow(const net::PcapReader::Packet& packet);
+    void send(const net::PcapReader::Packet& packet);
+    void waitUntil(Clock::time_point due);
+    void pumpServer(int timeout);
+
+    Options _options;
+    net::PcapReader _reader;
+    net::Address _target;
+    std::unique_ptr<net::Server> _server;
+    std::unordered_map<uint64_t, std::unique_ptr<net::NetworkSocket>> _flows;
+
+    uint64_t _packets = 0;
+    uint64_t _bytes = 0;
+    uint64_t _skipped = 0;
+    uint64_t _sendFailures = 0;
+    uint64_t _unpacked = 0;
+    double _duration = 0;
+    double _capturedDuration = 0;
+    // how late each packet was sent compared to the captured pace, in ns
+    net::LatencyHistogram _lateness;
+};
+
+}  // namespace replay
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "Replayer.hpp"
+
+static void usage() {
+    std::cout
+        << "USAGE: net_replay CAPTURE [options]\n"
+        << "    --capture-port PORT    Port of the captured Server"
+        << " (destination of the first packet)\n"
+        << "    --host IP              Server IP (127.0.0.1)\n"
+        << "    --port PORT            Server port (4242)\n"
+        << "    --embedded             Replay into a Server run in process,"
+        << " report its metrics\n"
+        << "    --config PATH          protocol.json of the embedded Server"
+        << " (config/protocol.json)\n"
+        << "    --speed FACTOR         1 original pace, 10 ten times faster,"
+        << " 0 without waiting (1)\n"
+        << "\nCaptures come from Server::startCapture, Client::startCapture"
+        << " or tcpdump (pcap or pcapng).\n";
+}
+
+static replay::Options parseOptions(int argc, char** argv) {
+    replay::Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--embedded") {
+            options.embedded = true;
+            continue;
+        }
+        if (arg.rfind("--", 0) != 0) {
+            options.capture = arg;
+            continue;
+        }
+        if (i + 1 >= argc)
+            throw std::invalid_argument("Missing value for " + arg);
+        std::string value = argv[++i];
+
+        if (arg == "--capture-port") {
+            options.capturePort = static_cast<uint16_t>(std::stoul(value));
+        } else if (arg == "--host") {
+            options.host = value;
+        } else if (arg == "--port") {
+            options.port = static_cast<uint16_t>(std::stoul(value));
+        } else if (arg == "--config") {
+            options.config = value;
+        } else if (arg == "--speed") {
+            options.speed = std::stod(value);
+        } else {
+            throw std::invalid_argument("Unknown option " + arg);
+        }
+    }
+    if (options.capture.empty())
+        throw std::invalid_argument("No capture given");
+    return options;
+}
+
+int main(int argc, char** argv) {
+    replay::Options options;
+
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "net_replay: " << e.what() << std::endl;
+        usage();
+        return 84;
+    }
+
+    try {
+        replay::Replayer replayer(options);
+        replayer.run();
+        replayer.report(std::cout);
+    } catch (const std::exception& e) {
+        std::cerr << "net_replay: " << e.what() << std::endl;
+        return 84;
+    }
+    return 0;
+}